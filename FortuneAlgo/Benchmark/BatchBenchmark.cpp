@@ -0,0 +1,129 @@
+//
+//  BatchBenchmark.cpp
+//  FortuneAlgo
+//
+//  Many small independent diagrams, as a tile service builds them: --sets sets
+//  of uniform sites with sizes spread log-uniformly between --min and --max.
+//  A loop calling build_voronoi for every set on one thread is compared with
+//  build_voronoi_batch on one and on all threads of a pool. The diagrams of the
+//  batch are checked against the ones of the loop.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target batch_bench
+//
+//  Usage:
+//    batch_bench [--sets 5000] [--min 50] [--max 5000] [--rounds 3]
+//
+//  Reported columns:
+//    time, ms      best wall time of building all the sets over --rounds rounds
+//    sets/s        sets built per second
+//    Msites/s      millions of sites per second
+//    speedup       time of the loop over the time of the row
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "ParallelVoronoi.hpp"
+#include "ThreadPool.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool sameDiagram(const bl::FlatDiagram &a, const bl::FlatDiagram &b) {
+    return a.vx == b.vx && a.vy == b.vy && a.twin == b.twin && a.next == b.next &&
+           a.prev == b.prev && a.origin == b.origin && a.l_site == b.l_site &&
+           a.r_site == b.r_site && a.faces == b.faces;
+}
+
+
+void report(const char *name, double time, size_t sets_n, size_t sites_n, double baseline, bool same) {
+    printf("%-24s %10.1f %10.0f %10.2f %9.2f%s\n", name, 1.0e3 * time, sets_n / time,
+           1.0e-6 * sites_n / time, baseline / time, same ? "" : "  MISMATCH");
+    fflush(stdout);
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    size_t sets_n = 5000, min_size = 50, max_size = 5000, rounds = 3;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sets") == 0) {
+            sets_n = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else if (strcmp(argv[i], "--min") == 0) {
+            min_size = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else if (strcmp(argv[i], "--max") == 0) {
+            max_size = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else if (strcmp(argv[i], "--rounds") == 0) {
+            rounds = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (min_size == 0 || max_size < min_size || rounds == 0) {
+        fprintf(stderr, "expected 0 < --min <= --max and --rounds > 0\n");
+        return 1;
+    }
+
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    std::vector<std::vector<Point2D>> sets(sets_n);
+    size_t sites_n = 0;
+    for (std::vector<Point2D> &set : sets) {
+        double size = min_size * std::pow(double(max_size) / min_size, uniform(gen));
+        set.resize(static_cast<size_t>(size));
+        for (Point2D &p : set) {
+            p = Point2D(uniform(gen), uniform(gen));
+        }
+        sites_n += set.size();
+    }
+
+    ThreadPool single(1), pool;
+    printf("seed: %u, sets: %zu, sites: %zu, threads: %zu\n", SEED, sets_n, sites_n, pool.size());
+    printf("%-24s %10s %10s %10s %9s\n", "benchmark", "time, ms", "sets/s", "Msites/s", "speedup");
+
+    std::vector<bl::FlatDiagram> expected(sets_n);
+    double baseline = 1.0e30;
+    for (size_t r = 0; r < rounds; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sets_n; ++i) {
+            build_voronoi(sets[i], expected[i]);
+        }
+        baseline = std::min(baseline, since(start));
+    }
+    report("build_voronoi loop", baseline, sets_n, sites_n, baseline, true);
+
+    for (int threads = 0; threads < 2; ++threads) {
+        std::vector<bl::FlatDiagram> diagrams;
+        std::vector<SweepBuffers> buffers;
+        double best = 1.0e30;
+        for (size_t r = 0; r < rounds; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            build_voronoi_batch(sets, diagrams, threads == 0 ? single : pool, buffers);
+            best = std::min(best, since(start));
+        }
+        bool same = diagrams.size() == sets_n;
+        for (size_t i = 0; same && i < sets_n; ++i) {
+            same = sameDiagram(diagrams[i], expected[i]);
+        }
+        report(threads == 0 ? "batch/1 thread" : "batch/all threads", best, sets_n, sites_n, baseline, same);
+    }
+
+    return 0;
+}
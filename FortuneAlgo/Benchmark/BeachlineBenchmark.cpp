@@ -0,0 +1,95 @@
+//
+//  BeachlineBenchmark.cpp
+//  FortuneAlgo
+//
+//  Measures the cost of beachline bookkeeping in build_voronoi:
+//  wall time and the number of heap allocations per input site.
+//  Only the public build_voronoi interface is used, so the same file
+//  can be built against older revisions to compare the numbers.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target beachline_bench
+//
+//  Usage:
+//    beachline_bench [n_1 n_2 ...]    (default: 100000 1000000 2000000)
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+
+static size_t allocations_num = 0;
+static size_t allocated_bytes = 0;
+
+
+void *operator new(size_t size) {
+    ++allocations_num;
+    allocated_bytes += size;
+    if (void *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+
+std::vector<Point2D> uniformPoints(size_t number, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+int main(int argc, const char *argv[]) {
+    
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000, 2000000};
+    }
+    
+    printf("%10s %10s %14s %14s %12s\n", "sites", "time, s", "ns per site", "allocs/site", "bytes/site");
+    
+    for (size_t n : sizes) {
+        
+        std::vector<Point2D> points = uniformPoints(n, 42);
+        std::vector<bl::HalfEdgePtr> halfedges, faces;
+        std::vector<bl::VertexPtr> vertices;
+        
+        size_t allocs_before = allocations_num, bytes_before = allocated_bytes;
+        auto start = std::chrono::steady_clock::now();
+        
+        build_voronoi(points, halfedges, vertices, faces);
+        
+        auto finish = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        
+        printf("%10zu %10.3f %14.1f %14.2f %12.1f\n", n, seconds, 1.0e9 * seconds / n,
+               double(allocations_num - allocs_before) / n,
+               double(allocated_bytes - bytes_before) / n);
+    }
+    
+    return 0;
+}
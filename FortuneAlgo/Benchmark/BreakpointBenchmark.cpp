@@ -0,0 +1,96 @@
+//
+//  BreakpointBenchmark.cpp
+//  FortuneAlgo
+//
+//  Compares evaluation of a beachline breakpoint through
+//  findIntersectionPoints (as BLNodePool::value() used to do it)
+//  with the scalar findBreakpoint kernel.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target breakpoint_bench
+//
+//  Usage:
+//    breakpoint_bench [pairs_num [repeats]]    (default: 1000000 20)
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Point2D.h"
+#include "Parabola.hpp"
+
+
+struct BreakpointQuery {
+    Point2D f1, f2;
+    double directrix;
+};
+
+
+std::vector<BreakpointQuery> randomQueries(size_t number, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<BreakpointQuery> queries(number);
+    for (size_t i = 0; i < number; ++i) {
+        queries[i].f1 = Point2D(dist(gen), dist(gen));
+        queries[i].f2 = Point2D(dist(gen), dist(gen));
+        // the sweepline is always below both foci
+        queries[i].directrix = std::max(queries[i].f1.y, queries[i].f2.y) + dist(gen);
+    }
+    return queries;
+}
+
+
+double vectorBreakpoint(const Point2D &f1, const Point2D &f2, double d) {
+    std::vector<Point2D> ips = findIntersectionPoints(f1, f2, d);
+    if (ips.size() == 2) {
+        return f1.y < f2.y ? ips[0].x : ips[1].x;
+    }
+    return ips[0].x;
+}
+
+
+template<class Function>
+double measure(const std::vector<BreakpointQuery> &queries, int repeats, Function f, double &checksum) {
+    checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (const BreakpointQuery &q : queries) {
+            checksum += f(q.f1, q.f2, q.directrix);
+        }
+    }
+    auto finish = std::chrono::steady_clock::now();
+    return 1.0e9 * std::chrono::duration<double>(finish - start).count() / (double(queries.size()) * repeats);
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    size_t number = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::vector<BreakpointQuery> queries = randomQueries(number, 42);
+
+    // both paths must agree up to rounding
+    double max_error = 0.0;
+    for (const BreakpointQuery &q : queries) {
+        double x1 = vectorBreakpoint(q.f1, q.f2, q.directrix);
+        double x2 = findBreakpoint(q.f1, q.f2, q.directrix);
+        max_error = std::max(max_error, fabs(x1 - x2) / std::max(1.0, fabs(x1)));
+    }
+
+    double checksum_vector, checksum_scalar;
+    double ns_vector = measure(queries, repeats, vectorBreakpoint, checksum_vector);
+    double ns_scalar = measure(queries, repeats, findBreakpoint<double>, checksum_scalar);
+
+    printf("%24s %12s %16s\n", "", "ns per call", "checksum");
+    printf("%24s %12.2f %16.6e\n", "findIntersectionPoints", ns_vector, checksum_vector);
+    printf("%24s %12.2f %16.6e\n", "findBreakpoint", ns_scalar, checksum_scalar);
+    printf("speedup: %.2fx, max relative difference: %.3e\n", ns_vector / ns_scalar, max_error);
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+//
+//  FingerBenchmark.cpp
+//  FortuneAlgo
+//
+//  Compares the beachline search from the root with the finger search
+//  from the last inserted arc. Site events are processed in the sweep order,
+//  so what matters is whether sites following each other in that order are
+//  close: rows of a sensor grid are, uniform sites are not. Every input is
+//  given both in its scan order and shuffled; the sweep sorts the sites
+//  anyway, so only the time of that sort should differ between the two.
+//  Each case is repeated until it has run for at least --min-time seconds.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target finger_bench
+//
+//  Usage:
+//    finger_bench [--sizes 1000,100000] [--min-time 0.5] [--beachline avl|wide]
+//
+//  Reported columns:
+//    root, ms     mean wall time of build_voronoi with the search from the root
+//    finger, ms   the same with the finger search
+//    speedup      root time divided by the finger time
+//    evals/site   breakpoints evaluated per site with each search
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<Point2D> uniformPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+// Sensor grid read row by row: rows at exact heights, small jitter along a row
+std::vector<Point2D> rowPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> jitter(-0.25, 0.25);
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(number))));
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = (double(i % side) + jitter(gen)) / side;
+        points[i].y = double(i / side) / side;
+    }
+    return points;
+}
+
+
+// GPS-like traces: 64 random walks with a slowly turning heading
+std::vector<Point2D> tracePoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> turn(0.0, 0.1);
+    size_t traces = 64, length = (number + traces - 1) / traces;
+    double step = 1.0 / length;
+    std::vector<Point2D> points;
+    points.reserve(number);
+    while (points.size() < number) {
+        Point2D p(uniform(gen), uniform(gen));
+        double heading = 2.0 * M_PI * uniform(gen);
+        for (size_t i = 0; i < length && points.size() < number; ++i) {
+            heading += turn(gen);
+            p.x = std::fabs(std::fmod(p.x + step * std::cos(heading) + 1.0, 2.0) - 1.0);
+            p.y = std::fabs(std::fmod(p.y + step * std::sin(heading) + 1.0, 2.0) - 1.0);
+            points.push_back(p);
+        }
+    }
+    return points;
+}
+
+
+struct Distribution {
+    const char *name;
+    std::vector<Point2D> (*generate)(size_t, std::mt19937 &);
+};
+
+
+const Distribution DISTRIBUTIONS[] = {
+    {"uniform", uniformPoints},
+    {"rows", rowPoints},
+    {"traces", tracePoints},
+};
+
+
+std::vector<std::string> splitList(const char *list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+// Mean time of build_voronoi repeated for at least `min_time` seconds
+double timeBuild(const std::vector<Point2D> &points, SweepBuffers &buffers, double min_time, SweepStats &stats) {
+    bl::FlatDiagram diagram;
+    int iterations = 0;
+    double total = 0.0;
+    while (iterations == 0 || total < min_time) {
+        auto start = std::chrono::steady_clock::now();
+        build_voronoi(points, diagram, buffers, &stats);
+        auto finish = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double>(finish - start).count();
+        ++iterations;
+    }
+    return total / iterations;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {10000, 100000, 1000000};
+    double min_time = 0.5;
+    BeachlineType beachline = AVL_BEACHLINE;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes.clear();
+            for (const std::string &s : splitList(argv[i + 1])) {
+                sizes.push_back(static_cast<size_t>(std::stod(s)));
+            }
+        } else if (strcmp(argv[i], "--min-time") == 0) {
+            min_time = std::atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--beachline") == 0) {
+            beachline = strcmp(argv[i + 1], "wide") == 0 ? WIDE_BEACHLINE : AVL_BEACHLINE;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, min time: %.2f s, beachline: %s\n", SEED, min_time,
+           beachline == WIDE_BEACHLINE ? "wide" : "avl");
+    printf("%-32s %12s %12s %8s %12s %12s\n", "benchmark", "root, ms", "finger, ms", "speedup",
+           "evals/site", "evals/site");
+
+    for (size_t n : sizes) {
+        for (const Distribution &dist : DISTRIBUTIONS) {
+            for (bool shuffled : {false, true}) {
+
+                std::mt19937 gen(SEED);
+                std::vector<Point2D> points = dist.generate(n, gen);
+                if (shuffled) {
+                    std::shuffle(points.begin(), points.end(), gen);
+                }
+
+                SweepBuffers buffers;
+                buffers.beachline = beachline;
+                SweepStats root_stats, finger_stats;
+                double root_time = timeBuild(points, buffers, min_time, root_stats);
+                buffers.finger_search = true;
+                double finger_time = timeBuild(points, buffers, min_time, finger_stats);
+
+                double root_evals = double(root_stats.breakpoint_cache_hits + root_stats.breakpoint_cache_misses) / n;
+                double finger_evals = double(finger_stats.breakpoint_cache_hits + finger_stats.breakpoint_cache_misses) / n;
+
+                char name[64];
+                snprintf(name, sizeof(name), "%s/%s/%zu", dist.name, shuffled ? "shuffled" : "sorted", n);
+                printf("%-32s %12.3f %12.3f %8.2f %12.1f %12.1f\n", name, 1.0e3 * root_time, 1.0e3 * finger_time,
+                       root_time / finger_time, root_evals, finger_evals);
+                fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
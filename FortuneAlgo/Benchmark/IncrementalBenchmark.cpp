@@ -0,0 +1,211 @@
+//
+//  IncrementalBenchmark.cpp
+//  FortuneAlgo
+//
+//  Simulation ticks on a diagram of uniform sites: every tick removes
+//  --changes random sites and inserts as many new ones with IncrementalVoronoi,
+//  which rebuilds only the changed cells. The time of a tick is compared with
+//  build_voronoi over all the sites, what a tick would cost without it.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target incremental_bench
+//
+//  Usage:
+//    incremental_bench [--sizes 100000,2000000] [--changes 300] [--ticks 10]
+//
+//  Reported columns:
+//    tick, ms      mean wall time of the changes of one tick
+//    build, ms     wall time of build_voronoi over the sites after the last tick
+//    speedup       build time over tick time
+//    us/change     mean time of one insertion or removal
+//    faces/change  mean number of changed faces reported by one change
+//    rebuilds      changes which fell back to the sweep over all the sites
+//
+//  Every size is also built once with a quarter of the sites repeating earlier
+//  ones, which must not become sites, followed by a tick that inserts some
+//  existing points again. The diagram must then have the Delaunay edges of
+//  build_voronoi over the sites left; the tool exits with 1 if it does not.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "IncrementalVoronoi.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<size_t> parseSizes(const char *list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            sizes.push_back(static_cast<size_t>(std::stod(item)));
+        }
+    }
+    return sizes;
+}
+
+
+void runSize(size_t n, size_t changes, size_t ticks) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    std::vector<Point2D> points(n);
+    for (Point2D &p : points) {
+        p = Point2D(uniform(gen), uniform(gen));
+    }
+
+    IncrementalVoronoi voronoi;
+    voronoi.build(points);
+    size_t rebuilds = voronoi.rebuilds_num();
+
+    std::vector<uint32_t> sites(n);
+    for (size_t i = 0; i < n; ++i) {
+        sites[i] = static_cast<uint32_t>(i);
+    }
+
+    size_t faces = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t tick = 0; tick < ticks; ++tick) {
+        for (size_t c = 0; c < changes; ++c) {
+            size_t k = gen() % sites.size();
+            voronoi.remove(sites[k]);
+            faces += voronoi.changed_faces().size();
+            sites[k] = sites.back();
+            sites.pop_back();
+        }
+        for (size_t c = 0; c < changes; ++c) {
+            uint32_t site = voronoi.insert(Point2D(uniform(gen), uniform(gen)));
+            faces += voronoi.changed_faces().size();
+            if (site != bl::NO_INDEX) {
+                sites.push_back(site);
+            }
+        }
+    }
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    points.clear();
+    for (uint32_t site : sites) {
+        points.push_back(voronoi.point(site));
+    }
+    bl::FlatDiagram diagram;
+    start = std::chrono::steady_clock::now();
+    build_voronoi(points, diagram);
+    double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double tick_time = time / ticks;
+    size_t changes_num = 2 * changes * ticks;
+    char label[64];
+    snprintf(label, sizeof(label), "uniform/%zu", n);
+    printf("%-24s %10.2f %10.1f %9.1f %10.2f %13.1f %9zu\n", label, 1.0e3 * tick_time, 1.0e3 * build,
+           build / tick_time, 1.0e6 * time / changes_num, double(faces) / changes_num,
+           voronoi.rebuilds_num() - rebuilds);
+    fflush(stdout);
+}
+
+
+typedef std::pair<std::pair<double, double>, std::pair<double, double>> PointPair;
+
+
+// Pairs of neighbouring sites given by their points, sorted
+std::vector<PointPair> delaunayEdges(const bl::FlatDiagram &diagram, const std::vector<Point2D> &points) {
+    std::vector<PointPair> edges;
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        uint32_t twin = diagram.twin[h];
+        if (twin != bl::NO_INDEX && h < twin) {
+            const Point2D &a = points[diagram.l_site[h]], &b = points[diagram.r_site[h]];
+            std::pair<double, double> pa(a.x, a.y), pb(b.x, b.y);
+            edges.push_back(PointPair(std::min(pa, pb), std::max(pa, pb)));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+
+// Builds sites with a quarter of them repeated, changes them and compares the result with build_voronoi
+bool checkRepeats(size_t n, size_t changes) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    std::vector<Point2D> points;
+    size_t repeats = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 4 == 3) {
+            points.push_back(points[gen() % i]);
+            repeats++;
+        } else {
+            points.push_back(Point2D(uniform(gen), uniform(gen)));
+        }
+    }
+
+    IncrementalVoronoi voronoi;
+    voronoi.build(points);
+    bool same = voronoi.sites_num() == n - repeats;
+
+    // removals, new points and points of the sites left, which must not be added
+    for (size_t c = 0; same && c < changes; ++c) {
+        voronoi.remove(static_cast<uint32_t>(gen() % n));
+        voronoi.insert(Point2D(uniform(gen), uniform(gen)));
+        uint32_t site = static_cast<uint32_t>(gen() % n);
+        if (voronoi.is_site(site)) {
+            same = voronoi.insert(voronoi.point(site)) == bl::NO_INDEX;
+        }
+    }
+
+    // halfedges of the incremental diagram refer to sites by their indices, removed ones have none
+    std::vector<Point2D> sites, indexed;
+    for (uint32_t s = 0; s < voronoi.diagram().faces.size(); ++s) {
+        indexed.push_back(voronoi.point(s));
+        if (voronoi.is_site(s)) {
+            sites.push_back(voronoi.point(s));
+        }
+    }
+    bl::FlatDiagram diagram;
+    build_voronoi(sites, diagram);
+    same = same && delaunayEdges(voronoi.diagram(), indexed) == delaunayEdges(diagram, sites);
+
+    printf("repeats/%zu: %zu sites repeated, %s\n", n, repeats, same ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return same;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 2000000};
+    size_t changes = 300, ticks = 10;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes = parseSizes(argv[i + 1]);
+        } else if (strcmp(argv[i], "--changes") == 0) {
+            changes = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (strcmp(argv[i], "--ticks") == 0) {
+            ticks = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, changes per tick: %zu insertions and %zu removals\n", SEED, changes, changes);
+    printf("%-24s %10s %10s %9s %10s %13s %9s\n", "benchmark", "tick, ms", "build, ms", "speedup",
+           "us/change", "faces/change", "rebuilds");
+
+    bool repeats_ok = true;
+    for (size_t n : sizes) {
+        runSize(n, changes, ticks);
+        repeats_ok = checkRepeats(n, changes) && repeats_ok;
+    }
+
+    return repeats_ok ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+//
+//  LloydBenchmark.cpp
+//  FortuneAlgo
+//
+//  Lloyd relaxation of uniform sites in the unit square. The loop written
+//  around the library before relax_lloyd, which builds every diagram from
+//  scratch, clips all the cells with clip_cells and computes their centroids
+//  on one thread, is compared with relax_lloyd on one and on all threads.
+//  All of them do the same number of iterations and must end with the same sites.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target lloyd_bench
+//
+//  Usage:
+//    lloyd_bench [--sizes 100000,1000000] [--iterations 50] [--verbose 1]
+//
+//  Reported columns:
+//    sweep, ms     mean wall time of building the diagram per iteration
+//    cells, ms     mean wall time of the centroids and moving the sites per iteration
+//    total, ms     mean wall time of an iteration
+//    speedup       total time of the loop from scratch over the total time of the row
+//    mean shift    mean distance the sites moved in the last iteration
+//
+//  With --verbose 1 relax_lloyd on all threads also prints every iteration.
+//
+//  Every size is also checked with a quarter of the sites repeating earlier
+//  ones: cell_centroids must give the first copies the centroids of the sites
+//  without the repeats and leave the repeats in place, and relax_lloyd must end
+//  with the same sites as the loop from scratch. The tool exits with 1 otherwise.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "LloydRelaxation.hpp"
+#include "ThreadPool.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<size_t> parseSizes(const char *list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            sizes.push_back(static_cast<size_t>(std::stod(item)));
+        }
+    }
+    return sizes;
+}
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// Centroid of cell i, relative to its site as relax_lloyd computes it
+Point2D cellCentroid(const ClippedCells &cells, size_t i, const Point2D &site) {
+    double area2 = 0.0, cx = 0.0, cy = 0.0;
+    uint32_t begin = cells.offsets[i], end = cells.offsets[i + 1];
+    for (uint32_t k = begin; k < end; ++k) {
+        uint32_t next = k + 1 < end ? k + 1 : begin;
+        Point2D a = Point2D(cells.x[k], cells.y[k]) - site, b = Point2D(cells.x[next], cells.y[next]) - site;
+        double cross = crossProduct(a, b);
+        area2 += cross;
+        cx += (a.x + b.x) * cross;
+        cy += (a.y + b.y) * cross;
+    }
+    if (area2 <= 0.0) {
+        return site;
+    }
+    return Point2D(site.x + cx / (3.0 * area2), site.y + cy / (3.0 * area2));
+}
+
+
+// The loop before relax_lloyd, returns the mean shift of the last iteration
+double relaxFromScratch(std::vector<Point2D> &points, const BoundingBox &box, size_t iterations,
+                        double &sweep, double &cells_time) {
+    double mean_shift = 0.0;
+    for (size_t it = 0; it < iterations; ++it) {
+        auto start = std::chrono::steady_clock::now();
+        bl::FlatDiagram diagram;
+        build_voronoi(points, diagram);
+        sweep += since(start);
+
+        start = std::chrono::steady_clock::now();
+        ClippedCells cells;
+        clip_cells(points, diagram, box, cells);
+        double shift_sum = 0.0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            Point2D centroid = cellCentroid(cells, i, points[i]);
+            shift_sum += (centroid - points[i]).norm();
+            points[i] = centroid;
+        }
+        mean_shift = shift_sum / points.size();
+        cells_time += since(start);
+    }
+    return mean_shift;
+}
+
+
+void report(const char *name, size_t n, size_t iterations, double sweep, double cells,
+            double baseline, double mean_shift, bool same) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%zu", name, n);
+    double total = sweep + cells;
+    printf("%-24s %10.1f %10.1f %10.1f %9.2f %12.3g%s\n", label, 1.0e3 * sweep / iterations,
+           1.0e3 * cells / iterations, 1.0e3 * total / iterations, baseline / total, mean_shift,
+           same ? "" : "  MISMATCH");
+    fflush(stdout);
+}
+
+
+void runSize(size_t n, size_t iterations, bool verbose, ThreadPool &single, ThreadPool &pool) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    std::vector<Point2D> initial(n);
+    for (Point2D &p : initial) {
+        p = Point2D(uniform(gen), uniform(gen));
+    }
+    BoundingBox box(0.0, 0.0, 1.0, 1.0);
+
+    std::vector<Point2D> expected = initial;
+    double sweep = 0.0, cells = 0.0;
+    double mean_shift = relaxFromScratch(expected, box, iterations, sweep, cells);
+    double baseline = sweep + cells;
+    report("from scratch", n, iterations, sweep, cells, baseline, mean_shift, true);
+
+    for (int threads = 0; threads < 2; ++threads) {
+        std::vector<Point2D> points = initial;
+        std::vector<LloydIteration> iterations_report;
+        LloydSettings settings;
+        settings.max_iterations = iterations;
+        size_t done = relax_lloyd(points, box, threads == 0 ? single : pool, settings, &iterations_report);
+
+        sweep = cells = 0.0;
+        for (const LloydIteration &it : iterations_report) {
+            sweep += it.sweep_time;
+            cells += it.centroid_time;
+        }
+        bool same = done == iterations;
+        for (size_t i = 0; same && i < n; ++i) {
+            same = points[i].x == expected[i].x && points[i].y == expected[i].y;
+        }
+        report(threads == 0 ? "relax_lloyd/1 thread" : "relax_lloyd/all threads", n, iterations,
+               sweep, cells, baseline, iterations_report.back().mean_shift, same);
+
+        if (verbose && threads == 1) {
+            for (size_t k = 0; k < iterations_report.size(); ++k) {
+                const LloydIteration &it = iterations_report[k];
+                printf("  iteration %3zu: sweep %8.1f ms, cells %8.1f ms, max shift %10.3g, mean shift %10.3g\n",
+                       k + 1, 1.0e3 * it.sweep_time, 1.0e3 * it.centroid_time, it.max_shift, it.mean_shift);
+            }
+        }
+    }
+}
+
+
+bool checkRepeats(size_t n, size_t iterations, ThreadPool &pool) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    // `first[i]` is the index of the first copy of site i among the unique sites
+    std::vector<Point2D> points, unique;
+    std::vector<uint32_t> first;
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 4 == 3) {
+            size_t j = gen() % i;
+            points.push_back(points[j]);
+            first.push_back(first[j]);
+        } else {
+            points.push_back(Point2D(uniform(gen), uniform(gen)));
+            first.push_back(static_cast<uint32_t>(unique.size()));
+            unique.push_back(points.back());
+        }
+    }
+    BoundingBox box(0.0, 0.0, 1.0, 1.0);
+
+    bl::FlatDiagram diagram;
+    std::vector<Point2D> centroids, reference;
+    build_voronoi(points, diagram);
+    cell_centroids(points, diagram, box, centroids, pool);
+    build_voronoi(unique, diagram);
+    cell_centroids(unique, diagram, box, reference, pool);
+
+    bool same = true;
+    std::vector<char> seen(unique.size(), 0);
+    for (size_t i = 0; same && i < n; ++i) {
+        const Point2D &expected = seen[first[i]] ? points[i] : reference[first[i]];
+        same = centroids[i].x == expected.x && centroids[i].y == expected.y;
+        seen[first[i]] = 1;
+    }
+
+    // the repeats stay where they are in the first iteration and get cells of their own later
+    std::vector<Point2D> relaxed = points, expected = points;
+    double sweep = 0.0, cells = 0.0;
+    relaxFromScratch(expected, box, iterations, sweep, cells);
+    LloydSettings settings;
+    settings.max_iterations = iterations;
+    same = same && relax_lloyd(relaxed, box, pool, settings) == iterations;
+    for (size_t i = 0; same && i < n; ++i) {
+        same = relaxed[i].x == expected[i].x && relaxed[i].y == expected[i].y;
+    }
+
+    printf("repeats/%zu: %zu sites repeated, %s\n", n, n - unique.size(), same ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return same;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 1000000};
+    size_t iterations = 50;
+    bool verbose = false;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes = parseSizes(argv[i + 1]);
+        } else if (strcmp(argv[i], "--iterations") == 0) {
+            iterations = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = std::stoi(argv[i + 1]) != 0;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (iterations == 0) {
+        fprintf(stderr, "--iterations must be positive\n");
+        return 1;
+    }
+
+    ThreadPool single(1), pool;
+    printf("seed: %u, iterations: %zu, threads: %zu\n", SEED, iterations, pool.size());
+    printf("%-24s %10s %10s %10s %9s %12s\n", "benchmark", "sweep, ms", "cells, ms", "total, ms",
+           "speedup", "mean shift");
+
+    bool repeats_ok = true;
+    for (size_t n : sizes) {
+        runSize(n, iterations, verbose, single, pool);
+        repeats_ok = checkRepeats(n, iterations, pool) && repeats_ok;
+    }
+
+    return repeats_ok ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+//
+//  LocatorBenchmark.cpp
+//  FortuneAlgo
+//
+//  Point location in the diagram of uniform sites: uniform random queries are
+//  answered by the nearest site found by brute force, by PointLocator::locate
+//  one query at a time, and by the batch locate on one and on all threads,
+//  with the queries in random order or already sorted along rows. Brute force
+//  runs over --brute queries only, every other row over all of them, and all
+//  answers are checked against the distance to the nearest site.
+//
+//  The locator is also checked by brute force on sites with repeats: an exact
+//  50x50 lattice with every point given twice and more, and 2000 uniform sites
+//  with a quarter of them repeated, against queries around and at the sites.
+//  An answer must be a nearest site and never a repeat of an earlier one;
+//  the tool exits with 1 otherwise.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target locate_bench
+//
+//  Usage:
+//    locate_bench [--sizes 100000,1000000] [--queries 10000000] [--brute 1000]
+//
+//  Reported columns:
+//    ns/query      wall time per query
+//    Mq/s          millions of queries per second
+//    speedup       brute force time over the time of the row, per query
+//    build, ms     wall time of PointLocator::build, in the row of single queries
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Point2D.h"
+#include "PointLocator.hpp"
+#include "ThreadPool.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<size_t> parseSizes(const char *list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            sizes.push_back(static_cast<size_t>(std::stod(item)));
+        }
+    }
+    return sizes;
+}
+
+
+std::vector<Point2D> uniformPoints(size_t n, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> uniform;
+    std::vector<Point2D> points(n);
+    for (Point2D &p : points) {
+        p = Point2D(uniform(gen), uniform(gen));
+    }
+    return points;
+}
+
+
+double distance2(const Point2D &a, const Point2D &b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+
+uint32_t bruteForce(const std::vector<Point2D> &points, const Point2D &query) {
+    uint32_t nearest = 0;
+    double best = distance2(points[0], query);
+    for (size_t i = 1; i < points.size(); ++i) {
+        double d = distance2(points[i], query);
+        if (d < best) {
+            best = d;
+            nearest = static_cast<uint32_t>(i);
+        }
+    }
+    return nearest;
+}
+
+
+// Answers of the first `checked` queries which are farther than the nearest site, ties are fine
+size_t mismatches(const std::vector<Point2D> &points, const std::vector<Point2D> &queries,
+                  const std::vector<uint32_t> &sites, const std::vector<uint32_t> &nearest) {
+    size_t wrong = 0;
+    for (size_t i = 0; i < nearest.size(); ++i) {
+        if (distance2(points[sites[i]], queries[i]) != distance2(points[nearest[i]], queries[i])) {
+            wrong++;
+        }
+    }
+    return wrong;
+}
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void report(const char *name, size_t n, double per_query, double brute, double build, size_t wrong) {
+    char label[64], build_column[32] = "-";
+    snprintf(label, sizeof(label), "%s/%zu", name, n);
+    if (build >= 0.0) {
+        snprintf(build_column, sizeof(build_column), "%.1f", 1.0e3 * build);
+    }
+    printf("%-28s %10.1f %10.2f %10.0f %10s%s\n", label, 1.0e9 * per_query, 1.0e-6 / per_query,
+           brute / per_query, build_column, wrong == 0 ? "" : "  MISMATCH");
+    fflush(stdout);
+}
+
+
+void runSize(size_t n, size_t queries_n, size_t brute_n, ThreadPool &single, ThreadPool &pool) {
+    std::mt19937 gen(SEED);
+    std::vector<Point2D> points = uniformPoints(n, gen);
+    std::vector<Point2D> queries = uniformPoints(queries_n, gen);
+    brute_n = std::min(brute_n, queries_n);
+
+    bl::FlatDiagram diagram;
+    build_voronoi(points, diagram);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> nearest(brute_n);
+    for (size_t i = 0; i < brute_n; ++i) {
+        nearest[i] = bruteForce(points, queries[i]);
+    }
+    double brute = since(start) / brute_n;
+    report("brute force", n, brute, brute, -1.0, 0);
+
+    start = std::chrono::steady_clock::now();
+    PointLocator locator;
+    locator.build(points, diagram);
+    double build = since(start);
+
+    std::vector<uint32_t> sites(queries_n);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries_n; ++i) {
+        sites[i] = locator.locate(queries[i]);
+    }
+    report("locate", n, since(start) / queries_n, brute, build, mismatches(points, queries, sites, nearest));
+
+    start = std::chrono::steady_clock::now();
+    locator.locate(queries, sites, single);
+    report("batch/1 thread", n, since(start) / queries_n, brute, -1.0, mismatches(points, queries, sites, nearest));
+
+    start = std::chrono::steady_clock::now();
+    locator.locate(queries, sites, pool);
+    report("batch/all threads", n, since(start) / queries_n, brute, -1.0, mismatches(points, queries, sites, nearest));
+
+    // the same queries sorted along rows, as the pixels of a raster
+    std::vector<Point2D> rows(queries);
+    size_t rows_n = std::max<size_t>(1, static_cast<size_t>(std::sqrt(double(queries_n))));
+    std::sort(rows.begin(), rows.end(), [rows_n](const Point2D &a, const Point2D &b) {
+        size_t row_a = static_cast<size_t>(a.y * rows_n), row_b = static_cast<size_t>(b.y * rows_n);
+        return row_a < row_b || (row_a == row_b && a.x < b.x);
+    });
+    std::vector<uint32_t> rows_nearest(brute_n);
+    for (size_t i = 0; i < brute_n; ++i) {
+        rows_nearest[i] = bruteForce(points, rows[i]);
+    }
+    start = std::chrono::steady_clock::now();
+    locator.locate(rows, sites, pool, true);
+    report("batch/all threads, sorted", n, since(start) / queries_n, brute, -1.0,
+           mismatches(points, rows, sites, rows_nearest));
+}
+
+
+// Locates queries near and at `points` one by one and in a batch, checks them by brute force
+bool checkRepeats(const char *name, const std::vector<Point2D> &points, double extent,
+                  std::mt19937 &gen, size_t brute_n, ThreadPool &pool) {
+    std::uniform_real_distribution<double> uniform(-1.0, extent + 1.0);
+    std::vector<Point2D> queries;
+    for (size_t i = 0; i < brute_n; ++i) {
+        queries.push_back(i % 2 == 0 ? Point2D(uniform(gen), uniform(gen)) : points[gen() % points.size()]);
+    }
+    std::vector<uint32_t> nearest(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        nearest[i] = bruteForce(points, queries[i]);
+    }
+
+    // a repeat is a site at the point of a site with a lower index
+    std::vector<uint32_t> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+        const Point2D &p1 = points[i], &p2 = points[j];
+        return p1.y < p2.y || (p1.y == p2.y && (p1.x < p2.x || (p1.x == p2.x && i < j)));
+    });
+    std::vector<char> repeat(points.size(), 0);
+    for (size_t k = 1; k < order.size(); ++k) {
+        const Point2D &p = points[order[k]], &q = points[order[k - 1]];
+        repeat[order[k]] = p.x == q.x && p.y == q.y;
+    }
+
+    bl::FlatDiagram diagram;
+    build_voronoi(points, diagram);
+    PointLocator locator;
+    locator.build(points, diagram);
+
+    std::vector<uint32_t> single(queries.size()), batch;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        single[i] = locator.locate(queries[i]);
+    }
+    locator.locate(queries, batch, pool);
+    size_t wrong = mismatches(points, queries, single, nearest) + mismatches(points, queries, batch, nearest);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        wrong += repeat[single[i]] + repeat[batch[i]];
+    }
+
+    printf("repeats/%s/%zu: %zu sites repeated, %zu queries, %s\n", name, points.size(),
+           size_t(std::count(repeat.begin(), repeat.end(), 1)), queries.size(), wrong == 0 ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return wrong == 0;
+}
+
+
+bool checkRepeats(size_t brute_n, ThreadPool &pool) {
+    std::mt19937 gen(SEED);
+
+    // exact lattice, every point at least twice, in a random order
+    std::vector<Point2D> lattice;
+    for (int copy = 0; copy < 2; ++copy) {
+        for (int j = 0; j < 50; ++j) {
+            for (int i = 0; i < 50; ++i) {
+                lattice.push_back(Point2D(i, j));
+            }
+        }
+    }
+    for (int k = 0; k < 500; ++k) {
+        lattice.push_back(lattice[gen() % 2500]);
+    }
+    std::shuffle(lattice.begin(), lattice.end(), gen);
+
+    std::vector<Point2D> uniform = uniformPoints(2000, gen);
+    for (size_t i = 3; i < uniform.size(); i += 4) {
+        uniform[i] = uniform[gen() % i];
+    }
+
+    bool ok = checkRepeats("lattice", lattice, 49.0, gen, brute_n, pool);
+    return checkRepeats("uniform", uniform, 1.0, gen, brute_n, pool) && ok;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 1000000};
+    size_t queries_n = 10000000, brute_n = 1000;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes = parseSizes(argv[i + 1]);
+        } else if (strcmp(argv[i], "--queries") == 0) {
+            queries_n = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else if (strcmp(argv[i], "--brute") == 0) {
+            brute_n = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (queries_n == 0 || brute_n == 0) {
+        fprintf(stderr, "--queries and --brute must be positive\n");
+        return 1;
+    }
+
+    ThreadPool single(1), pool;
+    printf("seed: %u, queries: %zu, threads: %zu\n", SEED, queries_n, pool.size());
+    printf("%-28s %10s %10s %10s %10s\n", "benchmark", "ns/query", "Mq/s", "speedup", "build, ms");
+
+    for (size_t n : sizes) {
+        runSize(n, queries_n, brute_n, single, pool);
+    }
+
+    return checkRepeats(brute_n, pool) ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+//
+//  ParallelBenchmark.cpp
+//  FortuneAlgo
+//
+//  Scaling benchmark for build_voronoi_parallel: times the build with
+//  1, 2, 4, ... up to --threads workers against a single build_voronoi
+//  sweep of the same sites, and build_voronoi_halves on two workers.
+//  Each case is repeated until it has run for at least --min-time seconds.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target parallel_bench
+//
+//  Usage:
+//    parallel_bench [--sizes 100000,1000000] [--dists uniform,clusters] [--threads 16] [--min-time 0.5]
+//
+//  Reported columns:
+//    time       mean wall time of one build
+//    speedup    serial sweep time divided by the time of the build
+//    fallback   1 if the strips disagreed and the diagram was built serially
+//    failed     cells that failed certification and were cut
+//    foreign    sites the failed cells were cut by
+//    ghosts     sites swept outside their own strip, over all strips
+//
+//  Uniform sites where every 4th, 20th or 100th one repeats an earlier site are
+//  also built on 2 and 4 workers, in strips and in halves. The builds must not
+//  fall back to the serial build and the edges between the cells must be the
+//  same as in the serial diagram; the tool exits with 1 if they are not.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+#include "ParallelVoronoi.hpp"
+#include "ThreadPool.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<Point2D> uniformPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+std::vector<Point2D> normalPoints(size_t number, std::mt19937 &gen) {
+    std::normal_distribution<double> dist(0.5, 0.1);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+// Dense gaussian blobs around 64 uniformly placed centers
+std::vector<Point2D> clusteredPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 0.005);
+    std::vector<Point2D> centers(64);
+    for (Point2D &c : centers) {
+        c = Point2D(uniform(gen), uniform(gen));
+    }
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        const Point2D &c = centers[gen() % centers.size()];
+        points[i].x = c.x + normal(gen);
+        points[i].y = c.y + normal(gen);
+    }
+    return points;
+}
+
+
+struct Distribution {
+    const char *name;
+    std::vector<Point2D> (*generate)(size_t, std::mt19937 &);
+};
+
+
+const Distribution DISTRIBUTIONS[] = {
+    {"uniform", uniformPoints},
+    {"normal", normalPoints},
+    {"clusters", clusteredPoints},
+};
+
+
+// Sites of the repeats check, enough for the strips to be swept in parallel
+const size_t REPEATS_SITES = 60000;
+
+
+// Pairs of sites on the two sides of each halfedge, and -1 for every empty cell
+std::vector<std::pair<int, int>> diagramEdges(const bl::FlatDiagram &diagram) {
+    std::vector<std::pair<int, int>> edges;
+    for (size_t h = 0; h < diagram.halfedges_num(); ++h) {
+        edges.push_back({static_cast<int>(diagram.l_site[h]), static_cast<int>(diagram.r_site[h])});
+    }
+    for (size_t i = 0; i < diagram.faces.size(); ++i) {
+        if (diagram.faces[i] == bl::NO_INDEX) {
+            edges.push_back({static_cast<int>(i), -1});
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+
+/**
+ Build uniform sites where every `period`-th one repeats an earlier site
+ in strips and in halves, and compare them with the serial diagram.
+ */
+bool checkRepeats(size_t period) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<Point2D> points;
+    for (size_t i = 0; i < REPEATS_SITES; ++i) {
+        if (i % period == period - 1) {
+            points.push_back(points[gen() % i]);
+        } else {
+            points.push_back(Point2D(uniform(gen), uniform(gen)));
+        }
+    }
+
+    bl::FlatDiagram diagram;
+    build_voronoi(points, diagram);
+    std::vector<std::pair<int, int>> reference = diagramEdges(diagram);
+
+    bool ok = true;
+    for (size_t t : {2, 4}) {
+        ThreadPool pool(t);
+        ParallelStats stats;
+        build_voronoi_parallel(points, diagram, pool, &stats);
+        bool same = !stats.serial_fallback && diagramEdges(diagram) == reference;
+        printf("build_voronoi_parallel/repeats/%zu/%zu: %zu sites repeated, %s\n",
+               REPEATS_SITES, t, REPEATS_SITES / period, same ? "ok" : "MISMATCH");
+        ok = ok && same;
+
+        build_voronoi_halves(points, diagram, pool, &stats);
+        same = !stats.serial_fallback && diagramEdges(diagram) == reference;
+        printf("build_voronoi_halves/repeats/%zu/%zu: %zu sites repeated, %s\n",
+               REPEATS_SITES, t, REPEATS_SITES / period, same ? "ok" : "MISMATCH");
+        ok = ok && same;
+        fflush(stdout);
+    }
+    return ok;
+}
+
+
+std::vector<std::string> splitList(const char *list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+// Mean time of `build` repeated for at least `min_time` seconds
+template<typename Build>
+double timeBuild(double min_time, Build build) {
+    int iterations = 0;
+    double total = 0.0;
+    while (iterations == 0 || total < min_time) {
+        auto start = std::chrono::steady_clock::now();
+        build();
+        auto finish = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double>(finish - start).count();
+        ++iterations;
+    }
+    return total / iterations;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 1000000, 10000000};
+    std::vector<std::string> dists;
+    size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double min_time = 0.5;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes.clear();
+            for (const std::string &s : splitList(argv[i + 1])) {
+                sizes.push_back(static_cast<size_t>(std::stod(s)));
+            }
+        } else if (strcmp(argv[i], "--dists") == 0) {
+            dists = splitList(argv[i + 1]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            max_threads = std::max(1, std::atoi(argv[i + 1]));
+        } else if (strcmp(argv[i], "--min-time") == 0) {
+            min_time = std::atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<size_t> threads;
+    for (size_t t = 1; t < max_threads; t *= 2) {
+        threads.push_back(t);
+    }
+    threads.push_back(max_threads);
+
+    printf("seed: %u, min time: %.2f s, hardware threads: %u\n", SEED, min_time, std::thread::hardware_concurrency());
+    printf("%-40s %12s %8s %8s %8s %8s %10s\n", "benchmark", "time, ms", "speedup", "fallback", "failed", "foreign", "ghosts");
+
+    for (size_t n : sizes) {
+        for (const Distribution &dist : DISTRIBUTIONS) {
+
+            bool selected = dists.empty();
+            for (const std::string &name : dists) {
+                selected = selected || name == dist.name;
+            }
+            if (!selected) {
+                continue;
+            }
+
+            std::mt19937 gen(SEED);
+            std::vector<Point2D> points = dist.generate(n, gen);
+            bl::FlatDiagram diagram;
+            SweepBuffers buffers;
+
+            char name[64];
+            double serial = timeBuild(min_time, [&]() { build_voronoi(points, diagram, buffers); });
+            snprintf(name, sizeof(name), "build_voronoi/%s/%zu", dist.name, n);
+            printf("%-40s %12.3f %8.2f\n", name, 1.0e3 * serial, 1.0);
+            fflush(stdout);
+
+            for (size_t t : threads) {
+                ThreadPool pool(t);
+                ParallelStats stats;
+                double seconds = timeBuild(min_time, [&]() { build_voronoi_parallel(points, diagram, pool, &stats); });
+                snprintf(name, sizeof(name), "build_voronoi_parallel/%s/%zu/%zu", dist.name, n, t);
+                printf("%-40s %12.3f %8.2f %8d %8zu %8zu %10zu\n", name, 1.0e3 * seconds, serial / seconds,
+                       int(stats.serial_fallback), stats.failed_cells, stats.foreign_sites, stats.ghost_sites);
+                fflush(stdout);
+            }
+
+            ThreadPool pool(2);
+            ParallelStats stats;
+            double seconds = timeBuild(min_time, [&]() { build_voronoi_halves(points, diagram, pool, &stats); });
+            snprintf(name, sizeof(name), "build_voronoi_halves/%s/%zu", dist.name, n);
+            printf("%-40s %12.3f %8.2f %8d %8zu %8zu %10zu\n", name, 1.0e3 * seconds, serial / seconds,
+                   int(stats.serial_fallback), stats.failed_cells, stats.foreign_sites, stats.ghost_sites);
+            fflush(stdout);
+        }
+    }
+
+    bool repeats_ok = true;
+    for (size_t period : {4, 20, 100}) {
+        repeats_ok = checkRepeats(period) && repeats_ok;
+    }
+
+    return repeats_ok ? 0 : 1;
+}
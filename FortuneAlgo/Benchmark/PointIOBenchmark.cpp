@@ -0,0 +1,231 @@
+//
+//  PointIOBenchmark.cpp
+//  FortuneAlgo
+//
+//  Times loading uniform sites from disk: a text file read with ifstream as the
+//  demo used to, the same file read with read_points_text on one and on all
+//  threads, and a binary point file mapped with MappedPoints. Then times
+//  build_voronoi on a vector copy and on the mapped points, which are not copied.
+//  Finally writes the diagram with write_diagram and maps it back with MappedDiagram.
+//  The files are written into --dir and removed afterwards. Loads run right after
+//  the file is written, so the file is usually in the page cache.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target io_bench
+//
+//  Usage:
+//    io_bench [--sizes 100000,10000000] [--dir /tmp]
+//
+//  Reported columns:
+//    load, ms      wall time to get the points or the diagram into memory,
+//                  for "diagram write" the time to write it
+//    build, ms     wall time of build_voronoi on the loaded points
+//    MB/s          size of the file read per second of loading
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Point2D.h"
+#include "PointIO.hpp"
+#include "DiagramIO.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<size_t> parseSizes(const char *list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            sizes.push_back(static_cast<size_t>(std::stod(item)));
+        }
+    }
+    return sizes;
+}
+
+
+std::vector<Point2D> uniformPoints(size_t n) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform;
+    std::vector<Point2D> points(n);
+    for (Point2D &p : points) {
+        p.x = uniform(gen);
+        p.y = uniform(gen);
+    }
+    return points;
+}
+
+
+bool writeText(const std::string &file_name, const std::vector<Point2D> &points) {
+    FILE *file = fopen(file_name.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "%zu\n", points.size());
+    for (const Point2D &p : points) {
+        fprintf(file, "%.17g %.17g\n", p.x, p.y);
+    }
+    return fclose(file) == 0;
+}
+
+
+// The loader of the demo before read_points_text
+std::vector<Point2D> readStream(const std::string &file_name) {
+    std::vector<Point2D> points;
+    std::ifstream in(file_name);
+    size_t points_n = 0;
+    double x, y;
+    if (in >> points_n) {
+        points.reserve(points_n);
+        for (size_t i = 0; i < points_n && in >> x >> y; ++i) {
+            points.push_back(Point2D(x, y));
+        }
+    }
+    return points;
+}
+
+
+size_t fileSize(const std::string &file_name) {
+    std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+    return in ? static_cast<size_t>(in.tellg()) : 0;
+}
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+void report(const char *name, size_t n, double load, double build, size_t bytes, bool ok) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%zu", name, n);
+    if (build >= 0.0) {
+        printf("%-24s %12.1f %12.1f %10.1f%s\n", label, 1.0e3 * load, 1.0e3 * build,
+               bytes / load / 1.0e6, ok ? "" : "  MISMATCH");
+    } else {
+        printf("%-24s %12.1f %12s %10.1f%s\n", label, 1.0e3 * load, "-",
+               bytes / load / 1.0e6, ok ? "" : "  MISMATCH");
+    }
+    fflush(stdout);
+}
+
+
+bool sameDiagram(const bl::FlatDiagram &a, const MappedDiagram &b) {
+    bl::FlatDiagram copy;
+    b.copy_to(copy);
+    return a.vx == copy.vx && a.vy == copy.vy && a.twin == copy.twin && a.next == copy.next &&
+           a.prev == copy.prev && a.origin == copy.origin && a.l_site == copy.l_site &&
+           a.r_site == copy.r_site && a.faces == copy.faces;
+}
+
+
+bool samePoints(const std::vector<Point2D> &a, const Point2D *b, size_t b_n) {
+    if (a.size() != b_n) {
+        return false;
+    }
+    for (size_t i = 0; i < b_n; ++i) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void runSize(size_t n, const std::string &dir) {
+    std::vector<Point2D> points = uniformPoints(n);
+    std::string text_name = dir + "/io_bench_points.txt";
+    std::string binary_name = dir + "/io_bench_points.bin";
+    if (!writeText(text_name, points) || !write_points_binary(binary_name, points)) {
+        fprintf(stderr, "cannot write into %s\n", dir.c_str());
+        return;
+    }
+    size_t text_size = fileSize(text_name), binary_size = fileSize(binary_name);
+
+    SweepBuffers buffers;
+    bl::FlatDiagram diagram;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Point2D> loaded = readStream(text_name);
+    double load = since(start);
+    report("ifstream", n, load, -1.0, text_size, samePoints(points, loaded.data(), loaded.size()));
+
+    start = std::chrono::steady_clock::now();
+    read_points_text(text_name, loaded, 1, 1);
+    load = since(start);
+    report("text/1 thread", n, load, -1.0, text_size, samePoints(points, loaded.data(), loaded.size()));
+
+    start = std::chrono::steady_clock::now();
+    read_points_text(text_name, loaded);
+    load = since(start);
+    start = std::chrono::steady_clock::now();
+    build_voronoi(loaded, diagram, buffers);
+    double build = since(start);
+    report("text/all threads", n, load, build, text_size, samePoints(points, loaded.data(), loaded.size()));
+
+    start = std::chrono::steady_clock::now();
+    MappedPoints mapped;
+    mapped.open(binary_name);
+    load = since(start);
+    start = std::chrono::steady_clock::now();
+    build_voronoi(mapped.data(), mapped.size(), diagram, buffers);
+    build = since(start);
+    report("mapped", n, load, build, binary_size, samePoints(points, mapped.data(), mapped.size()));
+
+    std::string diagram_name = dir + "/io_bench_diagram.bin";
+    start = std::chrono::steady_clock::now();
+    bool written = write_diagram(diagram_name, diagram);
+    double write = since(start);
+    size_t diagram_size = fileSize(diagram_name);
+    report("diagram write", n, write, -1.0, diagram_size, written);
+
+    start = std::chrono::steady_clock::now();
+    MappedDiagram mapped_diagram;
+    mapped_diagram.open(diagram_name);
+    load = since(start);
+    report("diagram map", n, load, -1.0, diagram_size, sameDiagram(diagram, mapped_diagram));
+
+    mapped.close();
+    mapped_diagram.close();
+    remove(text_name.c_str());
+    remove(binary_name.c_str());
+    remove(diagram_name.c_str());
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 1000000, 10000000};
+    std::string dir = "/tmp";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes = parseSizes(argv[i + 1]);
+        } else if (strcmp(argv[i], "--dir") == 0) {
+            dir = argv[i + 1];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, threads: %u\n", SEED, std::thread::hardware_concurrency());
+    printf("%-24s %12s %12s %10s\n", "benchmark", "load, ms", "build, ms", "MB/s");
+
+    for (size_t n : sizes) {
+        runSize(n, dir);
+    }
+
+    return 0;
+}
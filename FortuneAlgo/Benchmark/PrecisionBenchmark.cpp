@@ -0,0 +1,346 @@
+//
+//  PrecisionBenchmark.cpp
+//  FortuneAlgo
+//
+//  Compares build_voronoi in single and double precision: times both
+//  sweeps on the same sites and counts where the float diagram goes wrong.
+//  Sites are rounded to float first, so both sweeps see the same input
+//  and every difference comes from the arithmetic of the sweep.
+//  Each case is repeated until it has run for at least --min-time seconds.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target precision_bench
+//
+//  Usage:
+//    precision_bench [--sizes 1000,100000] [--dists uniform,grid] [--min-time 0.5]
+//
+//  Reported columns:
+//    time       mean wall time of one build_voronoi call
+//    sites/s    input sites processed per second
+//    speedup    double time divided by the time of the build
+//    MB         memory held by the diagram and the sweep buffers after the build
+//    mismatch   Delaunay edges (pairs of neighbouring sites) present in only one
+//               of the two diagrams, relative to the edges of the double diagram
+//    bad        vertices not equidistant from the sites around them,
+//               up to 1e-3 of the mean distance between sites
+//
+//  Every size is also built with a quarter of the sites repeating earlier ones,
+//  in both precisions, on both beachlines and with both searches. The diagram
+//  must be the one of the sites without the repeats, with empty cells for the
+//  repeats; the tool exits with 1 if it is not. In double precision that is the
+//  diagram built on the AVL beachline, float diagrams are compared with the
+//  ones of the same beachline and search, as they may differ in rounding.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<Point2D> uniformPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+std::vector<Point2D> normalPoints(size_t number, std::mt19937 &gen) {
+    std::normal_distribution<double> dist(0.5, 0.1);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+// Dense gaussian blobs around 64 uniformly placed centers
+std::vector<Point2D> clusteredPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 0.005);
+    std::vector<Point2D> centers(64);
+    for (Point2D &c : centers) {
+        c = Point2D(uniform(gen), uniform(gen));
+    }
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        const Point2D &c = centers[gen() % centers.size()];
+        points[i].x = c.x + normal(gen);
+        points[i].y = c.y + normal(gen);
+    }
+    return points;
+}
+
+
+// Square lattice with a small jitter: many events at almost the same sweepline
+std::vector<Point2D> gridPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> jitter(-1.0e-3, 1.0e-3);
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(number))));
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = (double(i % side) + jitter(gen)) / side;
+        points[i].y = (double(i / side) + jitter(gen)) / side;
+    }
+    return points;
+}
+
+
+struct Distribution {
+    const char *name;
+    std::vector<Point2D> (*generate)(size_t, std::mt19937 &);
+};
+
+
+const Distribution DISTRIBUTIONS[] = {
+    {"uniform", uniformPoints},
+    {"normal", normalPoints},
+    {"clusters", clusteredPoints},
+    {"grid", gridPoints},
+};
+
+
+std::vector<std::string> splitList(const char *list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+// Mean time of `build` repeated for at least `min_time` seconds
+template<typename Build>
+double timeBuild(double min_time, Build build) {
+    int iterations = 0;
+    double total = 0.0;
+    while (iterations == 0 || total < min_time) {
+        auto start = std::chrono::steady_clock::now();
+        build();
+        auto finish = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double>(finish - start).count();
+        ++iterations;
+    }
+    return total / iterations;
+}
+
+
+// Pairs of sites sharing an edge, sorted
+template<typename T>
+std::vector<std::pair<uint32_t, uint32_t>> delaunayEdges(const bl::FlatDiagramT<T> &diagram) {
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        if (h < diagram.twin[h]) {
+            uint32_t a = diagram.l_site[h], b = diagram.r_site[h];
+            edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+
+size_t mismatchedEdges(const bl::FlatDiagram &reference, const bl::FlatDiagramT<float> &diagram) {
+    std::vector<std::pair<uint32_t, uint32_t>> e1 = delaunayEdges(reference), e2 = delaunayEdges(diagram), diff;
+    std::set_symmetric_difference(e1.begin(), e1.end(), e2.begin(), e2.end(), std::back_inserter(diff));
+    return diff.size();
+}
+
+
+// Vertices whose distances to the two sites of an outgoing halfedge differ by more than `tolerance`
+size_t badVertices(const std::vector<Point2D> &points, const bl::FlatDiagramT<float> &diagram, double tolerance) {
+    std::vector<char> bad(diagram.vertices_num(), 0);
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        uint32_t v = diagram.origin[h];
+        if (v == bl::NO_INDEX) {
+            continue;
+        }
+        Point2D p(diagram.vx[v], diagram.vy[v]);
+        double d1 = (p - points[diagram.l_site[h]]).norm(), d2 = (p - points[diagram.r_site[h]]).norm();
+        if (std::fabs(d1 - d2) > tolerance) {
+            bad[v] = 1;
+        }
+    }
+    return std::count(bad.begin(), bad.end(), 1);
+}
+
+
+template<typename T>
+double diagramMegabytes(const bl::FlatDiagramT<T> &diagram, const SweepBuffersT<T> &buffers) {
+    size_t bytes = diagram.vx.capacity() * sizeof(T) * 2 +
+                   (diagram.origin.capacity() + diagram.twin.capacity() + diagram.next.capacity() +
+                    diagram.prev.capacity() + diagram.l_site.capacity() + diagram.r_site.capacity() +
+                    diagram.faces.capacity()) * sizeof(uint32_t) +
+                   buffers.sites.capacity() * sizeof(int) +
+                   buffers.avl.pool.size() * sizeof(bl::BLNodeT<T>) + buffers.wide.memory();
+    return bytes / (1024.0 * 1024.0);
+}
+
+
+// Diagram of `points` where some sites repeat earlier ones equals the diagram of `unique`,
+// which keeps their first copies; `first[i]` is the index of the first copy of the site i in `unique`.
+// The diagram of `unique` is built on the AVL beachline if `avl_reference` is set
+template<typename T>
+bool sameAsUnique(const std::vector<Point2DT<T>> &points, const std::vector<Point2DT<T>> &unique,
+                  const std::vector<uint32_t> &first, BeachlineType beachline, bool finger_search,
+                  bool avl_reference) {
+    SweepBuffersT<T> buffers;
+    bl::FlatDiagramT<T> diagram, reference;
+    SweepStats stats;
+    buffers.beachline = beachline;
+    buffers.finger_search = finger_search;
+    build_voronoi(points, diagram, buffers, &stats);
+    if (avl_reference) {
+        buffers.beachline = AVL_BEACHLINE;
+        buffers.finger_search = false;
+    }
+    build_voronoi(unique, reference, buffers);
+
+    bool same = stats.sites_dropped == points.size() - unique.size() &&
+                diagram.vx == reference.vx && diagram.vy == reference.vy &&
+                diagram.twin == reference.twin && diagram.next == reference.next &&
+                diagram.prev == reference.prev && diagram.origin == reference.origin;
+    for (uint32_t h = 0; same && h < diagram.halfedges_num(); ++h) {
+        same = first[diagram.l_site[h]] == reference.l_site[h] && first[diagram.r_site[h]] == reference.r_site[h];
+    }
+    std::vector<char> seen(unique.size(), 0);
+    for (size_t i = 0; same && i < points.size(); ++i) {
+        same = seen[first[i]] ? diagram.faces[i] == bl::NO_INDEX : diagram.faces[i] == reference.faces[first[i]];
+        seen[first[i]] = 1;
+    }
+    return same;
+}
+
+
+// Builds the sites with a quarter of them repeated and prints whether the diagrams match
+bool checkRepeats(size_t n) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::vector<Point2Df> points_f, unique_f;
+    std::vector<uint32_t> first;
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 4 == 3) {
+            size_t j = gen() % i;
+            points_f.push_back(points_f[j]);
+            first.push_back(first[j]);
+        } else {
+            points_f.push_back(Point2Df(uniform(gen), uniform(gen)));
+            first.push_back(static_cast<uint32_t>(unique_f.size()));
+            unique_f.push_back(points_f.back());
+        }
+    }
+    std::vector<Point2D> points(n), unique(unique_f.size());
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = Point2D(points_f[i].x, points_f[i].y);
+    }
+    for (size_t i = 0; i < unique.size(); ++i) {
+        unique[i] = Point2D(unique_f[i].x, unique_f[i].y);
+    }
+
+    bool same = true;
+    for (BeachlineType beachline : {AVL_BEACHLINE, WIDE_BEACHLINE}) {
+        for (bool finger_search : {false, true}) {
+            bool same_d = sameAsUnique(points, unique, first, beachline, finger_search, true);
+            bool same_f = sameAsUnique(points_f, unique_f, first, beachline, finger_search, false);
+            printf("repeats/%s%s/%zu: %zu sites repeated, double %s, float %s\n",
+                   beachline == WIDE_BEACHLINE ? "wide" : "avl", finger_search ? "/finger" : "", n,
+                   n - unique.size(), same_d ? "ok" : "MISMATCH", same_f ? "ok" : "MISMATCH");
+            same = same && same_d && same_f;
+        }
+    }
+    fflush(stdout);
+    return same;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::vector<std::string> dists;
+    double min_time = 0.5;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes.clear();
+            for (const std::string &s : splitList(argv[i + 1])) {
+                sizes.push_back(static_cast<size_t>(std::stod(s)));
+            }
+        } else if (strcmp(argv[i], "--dists") == 0) {
+            dists = splitList(argv[i + 1]);
+        } else if (strcmp(argv[i], "--min-time") == 0) {
+            min_time = std::atof(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, min time: %.2f s\n", SEED, min_time);
+    printf("%-32s %12s %12s %8s %8s %10s %8s\n", "benchmark", "time, ms", "sites/s", "speedup", "MB", "mismatch", "bad");
+
+    bool repeats_ok = true;
+    for (size_t n : sizes) {
+        for (const Distribution &dist : DISTRIBUTIONS) {
+
+            bool selected = dists.empty();
+            for (const std::string &name : dists) {
+                selected = selected || name == dist.name;
+            }
+            if (!selected) {
+                continue;
+            }
+
+            std::mt19937 gen(SEED);
+            std::vector<Point2D> points = dist.generate(n, gen);
+            std::vector<Point2Df> points_f(n);
+            for (size_t i = 0; i < n; ++i) {
+                points_f[i] = Point2Df(float(points[i].x), float(points[i].y));
+                points[i] = Point2D(points_f[i].x, points_f[i].y);
+            }
+
+            bl::FlatDiagram diagram;
+            SweepBuffers buffers;
+            double seconds = timeBuild(min_time, [&]() { build_voronoi(points, diagram, buffers); });
+            char name[64];
+            snprintf(name, sizeof(name), "build_voronoi<double>/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %12.4g %8.2f %8.1f\n", name, 1.0e3 * seconds, n / seconds, 1.0,
+                   diagramMegabytes(diagram, buffers));
+            fflush(stdout);
+
+            bl::FlatDiagramT<float> diagram_f;
+            SweepBuffersT<float> buffers_f;
+            double seconds_f = timeBuild(min_time, [&]() { build_voronoi(points_f, diagram_f, buffers_f); });
+            size_t edges = delaunayEdges(diagram).size();
+            double mismatch = edges > 0 ? double(mismatchedEdges(diagram, diagram_f)) / edges : 0.0;
+            size_t bad = badVertices(points, diagram_f, 1.0e-3 / std::sqrt(double(n)));
+            snprintf(name, sizeof(name), "build_voronoi<float>/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %12.4g %8.2f %8.1f %9.4f%% %8zu\n", name, 1.0e3 * seconds_f, n / seconds_f,
+                   seconds / seconds_f, diagramMegabytes(diagram_f, buffers_f), 100.0 * mismatch, bad);
+            fflush(stdout);
+        }
+        repeats_ok = checkRepeats(n) && repeats_ok;
+    }
+
+    return repeats_ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+//
+//  RenderBenchmark.cpp
+//  FortuneAlgo
+//
+//  Renders the diagram of uniform sites in the unit square into SVG and PNG
+//  files with render_svg and render_png, on one and on all threads of a pool.
+//  The default size is 3.4e6 sites, about 1e7 edges.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target render_bench
+//
+//  Usage:
+//    render_bench [--sizes 100000,3400000] [--width 4096] [--out render_bench]
+//
+//  The images go to <out>.svg and <out>.png and are overwritten by every size.
+//
+//  Reported columns:
+//    time, ms   wall time of rendering the file
+//    edges      edges of the diagram
+//    Medges/s   millions of edges rendered per second
+//    size, MB   size of the file
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "Point2D.h"
+#include "DiagramRenderer.hpp"
+#include "ThreadPool.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+std::vector<size_t> parseSizes(const char *list) {
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            sizes.push_back(static_cast<size_t>(std::stod(item)));
+        }
+    }
+    return sizes;
+}
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+double fileSize(const std::string &file_name) {
+    struct stat st;
+    return stat(file_name.c_str(), &st) == 0 ? double(st.st_size) : 0.0;
+}
+
+
+typedef bool (*Renderer)(const std::string &, const std::vector<Point2D> &, const bl::FlatDiagram &,
+                         const RenderSettings &, ThreadPool &);
+
+
+void report(const char *name, size_t n, const std::string &file_name, Renderer render,
+            const std::vector<Point2D> &points, const bl::FlatDiagram &diagram,
+            const RenderSettings &settings, ThreadPool &pool) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = render(file_name, points, diagram, settings, pool);
+    double time = since(start);
+    size_t edges = diagram.halfedges_num() / 2;
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%zu", name, n);
+    printf("%-24s %10.1f %10zu %10.2f %10.1f%s\n", label, 1.0e3 * time, edges, 1.0e-6 * edges / time,
+           1.0e-6 * fileSize(file_name), ok ? "" : "  FAILED");
+    fflush(stdout);
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 3400000};
+    size_t width = 4096;
+    std::string out = "render_bench";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes = parseSizes(argv[i + 1]);
+        } else if (strcmp(argv[i], "--width") == 0) {
+            width = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (strcmp(argv[i], "--out") == 0) {
+            out = argv[i + 1];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    ThreadPool single(1), pool;
+    printf("seed: %u, width: %zu, threads: %zu\n", SEED, width, pool.size());
+    printf("%-24s %10s %10s %10s %10s\n", "benchmark", "time, ms", "edges", "Medges/s", "size, MB");
+
+    RenderSettings settings;
+    settings.width = width;
+    settings.site_radius = 0.5;
+
+    for (size_t n : sizes) {
+        std::mt19937 gen(SEED);
+        std::uniform_real_distribution<double> uniform;
+        std::vector<Point2D> points(n);
+        for (Point2D &p : points) {
+            p = Point2D(uniform(gen), uniform(gen));
+        }
+        bl::FlatDiagram diagram;
+        build_voronoi(points, diagram);
+
+        report("svg/1 thread", n, out + ".svg", render_svg, points, diagram, settings, single);
+        report("svg/all threads", n, out + ".svg", render_svg, points, diagram, settings, pool);
+        report("png/1 thread", n, out + ".png", render_png, points, diagram, settings, single);
+        report("png/all threads", n, out + ".png", render_png, points, diagram, settings, pool);
+    }
+
+    return 0;
+}
@@ -0,0 +1,255 @@
+//
+//  StreamingBenchmark.cpp
+//  FortuneAlgo
+//
+//  Runs the streaming sweep over sites generated already sorted by y, so the
+//  input is never stored: uniform sites in the unit square come from sorted
+//  y-coordinates (sums of exponential gaps) with random x, rows of a sensor grid
+//  come row by row. Reports the time per site and the peak memory of the sweep,
+//  which should grow with the width of the beachline, about sqrt(n), not with n.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target stream_bench
+//
+//  Usage:
+//    stream_bench [--sizes 100000,10000000] [--beachline avl|wide]
+//
+//  Reported columns:
+//    time, ms      wall time of the whole stream including the sink
+//    ns/site       the same per site
+//    live sites    peak number of sites with cells not emitted yet
+//    halfedges     peak number of halfedges kept for them
+//    queue         peak size of the circle event queue
+//    closed        share of the cells emitted before the end of the stream
+//
+//  Every size also streams up to 1e6 uniform sites with every third one
+//  repeated. The cells of the repeats must come without edges and the other
+//  cells with the edges of the diagram built by build_voronoi; the tool exits
+//  with 1 if they do not.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Point2D.h"
+#include "StreamingVoronoi.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+// Uniform sites in the unit square in the sweep order
+class UniformStream {
+public:
+    UniformStream(size_t _number) : number(_number), index(0), y(0.0), gen(SEED) {}
+
+    bool operator()(Point2D &point) {
+        if (index == number) {
+            return false;
+        }
+        // gaps between sorted uniform values are exponential
+        y += gap(gen) / (number + 1);
+        point.x = uniform(gen);
+        point.y = y;
+        ++index;
+        return true;
+    }
+
+private:
+    size_t number, index;
+    double y;
+    std::mt19937 gen;
+    std::uniform_real_distribution<double> uniform;
+    std::exponential_distribution<double> gap;
+};
+
+
+// Sensor grid read row by row: rows at exact heights, small sorted jitter along a row
+class RowStream {
+public:
+    RowStream(size_t _number) : number(_number), index(0), gen(SEED) {
+        side = static_cast<size_t>(std::ceil(std::sqrt(double(number))));
+    }
+
+    bool operator()(Point2D &point) {
+        if (index == number) {
+            return false;
+        }
+        size_t row = index / side, column = index % side;
+        point.x = (double(column) + jitter(gen)) / side;
+        point.y = double(row) / side;
+        ++index;
+        return true;
+    }
+
+private:
+    size_t number, index, side;
+    std::mt19937 gen;
+    std::uniform_real_distribution<double> jitter{0.0, 0.5};
+};
+
+
+std::vector<std::string> splitList(const char *list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+template<class Source>
+void runStream(const char *name, size_t n, Source source, BeachlineType beachline) {
+    size_t closed = 0, edges = 0;
+    StreamingVoronoi voronoi([&](const StreamedCell &cell) {
+        closed += cell.closed;
+        edges += cell.edges.size();
+    }, beachline);
+
+    size_t live_sites = 0, live_halfedges = 0;
+    Point2D point;
+    SweepStats stats;
+    auto start = std::chrono::steady_clock::now();
+    while (source(point)) {
+        voronoi.add_site(point);
+        live_sites = std::max(live_sites, voronoi.live_sites());
+        live_halfedges = std::max(live_halfedges, voronoi.live_halfedges());
+    }
+    voronoi.finish(&stats);
+    auto finish = std::chrono::steady_clock::now();
+    double time = std::chrono::duration<double>(finish - start).count();
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%zu", name, n);
+    printf("%-24s %12.1f %10.1f %12zu %12zu %10zu %8.4f\n", label, 1.0e3 * time, 1.0e9 * time / n,
+           live_sites, live_halfedges, stats.max_queue_size, double(closed) / n);
+    fflush(stdout);
+}
+
+
+// Neighbour and ends of an edge, an infinite end is at infinity
+typedef std::tuple<uint64_t, double, double, double, double> EdgeKey;
+
+
+// Streams uniform sites with every third one repeated and compares the cells with the diagram
+// of the sites without the repeats
+bool checkRepeats(size_t n, BeachlineType beachline) {
+    std::vector<Point2D> unique;
+    UniformStream source(n);
+    Point2D point;
+    while (source(point)) {
+        unique.push_back(point);
+    }
+
+    // stream position of the first copy of every site and whether a position is a repeat
+    std::vector<uint64_t> ids(unique.size());
+    std::vector<char> repeat;
+    std::vector<std::vector<EdgeKey>> cells;
+    std::vector<char> closed;
+    std::vector<int> emitted;
+    StreamingVoronoi voronoi([&](const StreamedCell &cell) {
+        std::vector<EdgeKey> &edges = cells[cell.site];
+        for (const StreamedEdge &e : cell.edges) {
+            bool from = e.from != NO_VERTEX, to = e.to != NO_VERTEX;
+            edges.push_back(EdgeKey(e.neighbour,
+                                    from ? e.from_point.x : Point2D::Inf, from ? e.from_point.y : Point2D::Inf,
+                                    to ? e.to_point.x : Point2D::Inf, to ? e.to_point.y : Point2D::Inf));
+        }
+        closed[cell.site] = cell.closed;
+        emitted[cell.site]++;
+    }, beachline);
+    for (size_t i = 0; i < unique.size(); ++i) {
+        for (int copy = 0; copy < (i % 3 == 2 ? 2 : 1); ++copy) {
+            if (copy == 0) {
+                ids[i] = repeat.size();
+            }
+            repeat.push_back(copy > 0);
+            cells.emplace_back();
+            closed.push_back(0);
+            emitted.push_back(0);
+            voronoi.add_site(unique[i]);
+        }
+    }
+    voronoi.finish();
+
+    SweepBuffers buffers;
+    buffers.beachline = beachline;
+    bl::FlatDiagram diagram;
+    build_voronoi(unique, diagram, buffers);
+
+    bool same = true;
+    for (size_t id = 0; same && id < repeat.size(); ++id) {
+        same = emitted[id] == 1 && (!repeat[id] || (cells[id].empty() && !closed[id]));
+    }
+    std::vector<EdgeKey> edges;
+    for (size_t i = 0; same && i < unique.size(); ++i) {
+        edges.clear();
+        uint32_t start = diagram.faces[i], h = start;
+        do {
+            uint32_t from = diagram.origin[h], to = diagram.origin[diagram.twin[h]];
+            edges.push_back(EdgeKey(ids[diagram.r_site[h]],
+                                    from != bl::NO_INDEX ? diagram.vx[from] : Point2D::Inf,
+                                    from != bl::NO_INDEX ? diagram.vy[from] : Point2D::Inf,
+                                    to != bl::NO_INDEX ? diagram.vx[to] : Point2D::Inf,
+                                    to != bl::NO_INDEX ? diagram.vy[to] : Point2D::Inf));
+            h = diagram.next[h];
+        } while (h != bl::NO_INDEX && h != start);
+        std::vector<EdgeKey> &streamed = cells[ids[i]];
+        std::sort(edges.begin(), edges.end());
+        std::sort(streamed.begin(), streamed.end());
+        same = edges == streamed && bool(closed[ids[i]]) == (h == start);
+    }
+
+    printf("repeats/%zu: %zu sites repeated, %s\n", repeat.size(), repeat.size() - unique.size(),
+           same ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return same;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {100000, 1000000, 10000000};
+    BeachlineType beachline = AVL_BEACHLINE;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes.clear();
+            for (const std::string &s : splitList(argv[i + 1])) {
+                sizes.push_back(static_cast<size_t>(std::stod(s)));
+            }
+        } else if (strcmp(argv[i], "--beachline") == 0) {
+            beachline = strcmp(argv[i + 1], "wide") == 0 ? WIDE_BEACHLINE : AVL_BEACHLINE;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, beachline: %s\n", SEED, beachline == WIDE_BEACHLINE ? "wide" : "avl");
+    printf("%-24s %12s %10s %12s %12s %10s %8s\n", "benchmark", "time, ms", "ns/site",
+           "live sites", "halfedges", "queue", "closed");
+
+    bool repeats_ok = true;
+    for (size_t n : sizes) {
+        runStream("uniform", n, UniformStream(n), beachline);
+        runStream("rows", n, RowStream(n), beachline);
+        repeats_ok = checkRepeats(std::min<size_t>(n, 1000000), beachline) && repeats_ok;
+    }
+
+    return repeats_ok ? 0 : 1;
+}
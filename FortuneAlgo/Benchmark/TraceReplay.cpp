@@ -0,0 +1,262 @@
+//
+//  TraceReplay.cpp
+//  FortuneAlgo
+//
+//  Records the events of a sweep into a binary trace file and steps through
+//  trace files offline. Recording builds the diagram of --sites uniform sites,
+//  or of the sites of a binary point file, with and without the trace to show
+//  its overhead. Replaying needs nothing but the trace: it splits the time by
+//  event type and by the progress of the sweepline and lists the slowest events.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target trace_replay
+//
+//  Usage:
+//    trace_replay --record trace.bin [--sites 1000000] [--points sites.bin]
+//                 [--beachline avl|wide] [--rounds 5]
+//    trace_replay [--bands 10] [--top 10] trace.bin
+//
+//  Reported columns of the replay:
+//    events     number of events of the row
+//    time, ms   sum of the event times
+//    share      share of the time of all events
+//    ns/event   mean, median, 99th percentile and largest time of an event
+//    compared   mean breakpoints compared with the site or looked up per event
+//    evaluated  mean breakpoints computed anew per event
+//    queue      mean size of the circle event queue
+//
+//  Bands hold the same number of events in their order, so the rows show how
+//  an event gets slower as the beachline grows. Event times include the read of
+//  the time stamp counter by the recorder, which adds a few tens of nanoseconds.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Point2D.h"
+#include "PointIO.hpp"
+#include "SweepTrace.hpp"
+#include "VoronoiDiagram.hpp"
+
+
+const unsigned int SEED = 42;
+
+const char *EVENT_NAMES[TRACE_EVENT_TYPES] = {"site", "site beside", "site dropped", "circle", "false circle"};
+
+
+double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int record(const std::string &file_name, size_t sites_n, const char *points_file,
+           BeachlineType beachline, size_t rounds) {
+    std::vector<Point2D> generated;
+    MappedPoints mapped;
+    const Point2D *points;
+    if (points_file != nullptr) {
+        if (!mapped.open(points_file)) {
+            fprintf(stderr, "cannot read the point file %s\n", points_file);
+            return 1;
+        }
+        points = mapped.data();
+        sites_n = mapped.size();
+    } else {
+        std::mt19937 gen(SEED);
+        std::uniform_real_distribution<double> uniform;
+        generated.resize(sites_n);
+        for (Point2D &p : generated) {
+            p = Point2D(uniform(gen), uniform(gen));
+        }
+        points = generated.data();
+    }
+
+    bl::FlatDiagram diagram;
+    SweepBuffers buffers;
+    buffers.beachline = beachline;
+    SweepTrace trace;
+    trace.records.reserve(3 * sites_n);
+
+    double plain = 1.0e30, traced = 1.0e30;
+    for (size_t r = 0; r < rounds; ++r) {
+        buffers.trace = nullptr;
+        auto start = std::chrono::steady_clock::now();
+        build_voronoi(points, sites_n, diagram, buffers);
+        plain = std::min(plain, since(start));
+
+        buffers.trace = &trace;
+        start = std::chrono::steady_clock::now();
+        build_voronoi(points, sites_n, diagram, buffers);
+        traced = std::min(traced, since(start));
+    }
+
+    if (!write_trace(file_name, trace)) {
+        fprintf(stderr, "cannot write the trace file %s\n", file_name.c_str());
+        return 1;
+    }
+    printf("sites: %zu, events: %zu, trace: %.1f MB\n", sites_n, trace.records.size(),
+           1.0e-6 * (TRACE_FILE_HEADER + trace.records.size() * sizeof(TraceRecord)));
+    printf("build_voronoi %10.1f ms\n", 1.0e3 * plain);
+    printf("with trace    %10.1f ms   overhead %.1f%%\n", 1.0e3 * traced, 100.0 * (traced / plain - 1.0));
+    return 0;
+}
+
+
+/**
+ Times and breakpoint counts of a group of events.
+ */
+struct EventGroup {
+    std::vector<uint32_t> times;
+    double time = 0.0, compared = 0.0, evaluated = 0.0, queue = 0.0;
+
+    void add(const TraceRecord &r) {
+        times.push_back(r.time);
+        time += r.time;
+        compared += r.compared;
+        evaluated += r.evaluated;
+        queue += r.queue_size;
+    }
+};
+
+
+uint32_t percentile(std::vector<uint32_t> &times, double p) {
+    size_t k = static_cast<size_t>(p * (times.size() - 1));
+    std::nth_element(times.begin(), times.begin() + k, times.end());
+    return times[k];
+}
+
+
+void printGroup(const char *name, EventGroup &group, double total, double tick_ns) {
+    size_t n = group.times.size();
+    if (n == 0) {
+        printf("%-22s %10d\n", name, 0);
+        return;
+    }
+    double median = tick_ns * percentile(group.times, 0.5), p99 = tick_ns * percentile(group.times, 0.99);
+    double longest = tick_ns * *std::max_element(group.times.begin(), group.times.end());
+    printf("%-22s %10zu %10.1f %6.1f%% %8.0f %8.0f %8.0f %10.0f %9.2f %9.2f %9.0f\n", name, n,
+           1.0e-6 * tick_ns * group.time, total > 0.0 ? 100.0 * group.time / total : 0.0,
+           tick_ns * group.time / n, median, p99, longest, group.compared / n, group.evaluated / n, group.queue / n);
+}
+
+
+void printGroupHeader(const char *title) {
+    printf("\n%-22s %10s %10s %7s %8s %8s %8s %10s %9s %9s %9s\n", title, "events", "time, ms", "share",
+           "ns mean", "median", "p99", "max", "compared", "evaluated", "queue");
+}
+
+
+int replay(const std::string &file_name, size_t bands, size_t top) {
+    SweepTrace trace;
+    if (!read_trace(file_name, trace)) {
+        fprintf(stderr, "cannot read the trace file %s\n", file_name.c_str());
+        return 1;
+    }
+    const std::vector<TraceRecord> &records = trace.records;
+    printf("sites: %llu, events: %zu, ns per tick: %.4g\n", static_cast<unsigned long long>(trace.sites_num),
+           records.size(), trace.tick_ns);
+    if (records.empty()) {
+        return 0;
+    }
+
+    double total = 0.0;
+    std::vector<EventGroup> types(TRACE_EVENT_TYPES);
+    for (const TraceRecord &r : records) {
+        total += r.time;
+        if (r.type < TRACE_EVENT_TYPES) {
+            types[r.type].add(r);
+        }
+    }
+
+    printGroupHeader("event");
+    for (int t = 0; t < TRACE_EVENT_TYPES; ++t) {
+        printGroup(EVENT_NAMES[t], types[t], total, trace.tick_ns);
+    }
+
+    printGroupHeader("sweepline");
+    bands = std::min(std::max<size_t>(bands, 1), records.size());
+    for (size_t b = 0; b < bands; ++b) {
+        size_t begin = b * records.size() / bands, end = (b + 1) * records.size() / bands;
+        EventGroup band;
+        for (size_t i = begin; i < end; ++i) {
+            band.add(records[i]);
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%.4g .. %.4g", records[begin].y, records[end - 1].y);
+        printGroup(label, band, total, trace.tick_ns);
+    }
+
+    std::vector<size_t> slowest(records.size());
+    for (size_t i = 0; i < slowest.size(); ++i) {
+        slowest[i] = i;
+    }
+    top = std::min(top, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + top, slowest.end(), [&](size_t a, size_t b) {
+        return records[a].time > records[b].time;
+    });
+
+    printf("\n%-10s %-14s %12s %12s %10s %10s %10s %9s %9s\n", "event #", "type", "x", "y", "site", "arc",
+           "ns", "compared", "queue");
+    for (size_t k = 0; k < top; ++k) {
+        const TraceRecord &r = records[slowest[k]];
+        printf("%-10zu %-14s %12.6g %12.6g %10u %10u %10.0f %9u %9u\n", slowest[k],
+               r.type < TRACE_EVENT_TYPES ? EVENT_NAMES[r.type] : "?", r.x, r.y, r.site, r.arc,
+               trace.tick_ns * r.time, r.compared, r.queue_size);
+    }
+    return 0;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::string record_file, trace_file;
+    const char *points_file = nullptr;
+    size_t sites_n = 1000000, rounds = 5, bands = 10, top = 10;
+    BeachlineType beachline = AVL_BEACHLINE;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            trace_file = argv[i];
+            continue;
+        }
+        if (i + 1 == argc) {
+            fprintf(stderr, "option %s needs a value\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--record") == 0) {
+            record_file = argv[i + 1];
+        } else if (strcmp(argv[i], "--sites") == 0) {
+            sites_n = static_cast<size_t>(std::stod(argv[i + 1]));
+        } else if (strcmp(argv[i], "--points") == 0) {
+            points_file = argv[i + 1];
+        } else if (strcmp(argv[i], "--beachline") == 0) {
+            beachline = strcmp(argv[i + 1], "wide") == 0 ? WIDE_BEACHLINE : AVL_BEACHLINE;
+        } else if (strcmp(argv[i], "--rounds") == 0) {
+            rounds = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (strcmp(argv[i], "--bands") == 0) {
+            bands = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (strcmp(argv[i], "--top") == 0) {
+            top = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        ++i;
+    }
+
+    if (!record_file.empty()) {
+        return record(record_file, sites_n, points_file, beachline, std::max<size_t>(rounds, 1));
+    }
+    if (trace_file.empty()) {
+        fprintf(stderr, "usage: trace_replay --record trace.bin [--sites n] [--points sites.bin]"
+                        " [--beachline avl|wide] [--rounds n]\n"
+                        "       trace_replay [--bands n] [--top n] trace.bin\n");
+        return 1;
+    }
+    return replay(trace_file, bands, top);
+}
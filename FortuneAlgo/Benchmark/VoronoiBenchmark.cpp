@@ -0,0 +1,468 @@
+//
+//  VoronoiBenchmark.cpp
+//  FortuneAlgo
+//
+//  Benchmark suite for build_voronoi: times the sweep on inputs from
+//  1e3 to 1e7 sites drawn from several distributions with fixed seeds.
+//  Each case is repeated with one VoronoiBuilder until it has run for
+//  at least --min-time seconds. Clipping of the resulting cells to the
+//  unit square is timed the same way on its own, and so are the Delaunay
+//  triangles built straight by the sweep and collected from the diagram.
+//
+//  Build:
+//    cmake -S . -B build && cmake --build build --target voronoi_bench
+//
+//  Usage:
+//    voronoi_bench [--sizes 1000,100000] [--dists uniform,clusters] [--min-time 0.5]
+//                  [--beachline avl|wide]
+//
+//  Configure with -DFORTUNE_SWEEP_PROFILE=ON to print the profile of the last
+//  sweep of every build_voronoi row: event counts, beachline size and height
+//  and the shares of time spent in the queue, the beachline and the output.
+//
+//  Reported columns:
+//    time       mean wall time of one build_voronoi call
+//    sites/s    input sites processed per second
+//    ns/event   time per processed event (sites and popped circle events)
+//    allocs     heap allocations made by the last repetition
+//    peak RSS   peak resident set size of the process so far; sizes run in
+//               ascending order, so it is dominated by the current size
+//
+//  Every size is also clipped once with a quarter of the uniform sites repeating
+//  earlier ones. Cells of the repeats must be empty and the other cells the
+//  same as without the repeats.
+//
+//  Triangles built by the sweep must be the ones collected from the diagram up
+//  to the rotation of their corners, counterclockwise, with every neighbour
+//  across the same edge both ways. The same is checked on the sites with the
+//  repeats, whose triangles must also be those of the sites without them.
+//  The tool exits with 1 if any of the checks fails.
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+#include "VoronoiBuilder.hpp"
+#include "ClippedCells.hpp"
+#include "Predicates.hpp"
+
+
+const unsigned int SEED = 42;
+
+
+static size_t allocations_num = 0;
+
+
+void *operator new(size_t size) {
+    ++allocations_num;
+    if (void *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+
+std::vector<Point2D> uniformPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+std::vector<Point2D> normalPoints(size_t number, std::mt19937 &gen) {
+    std::normal_distribution<double> dist(0.5, 0.1);
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = dist(gen);
+        points[i].y = dist(gen);
+    }
+    return points;
+}
+
+
+// Dense gaussian blobs around 64 uniformly placed centers
+std::vector<Point2D> clusteredPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 0.005);
+    std::vector<Point2D> centers(64);
+    for (Point2D &c : centers) {
+        c = Point2D(uniform(gen), uniform(gen));
+    }
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        const Point2D &c = centers[gen() % centers.size()];
+        points[i].x = c.x + normal(gen);
+        points[i].y = c.y + normal(gen);
+    }
+    return points;
+}
+
+
+// Square lattice with a small jitter: many events at almost the same sweepline
+std::vector<Point2D> gridPoints(size_t number, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> jitter(-1.0e-3, 1.0e-3);
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(double(number))));
+    std::vector<Point2D> points(number);
+    for (size_t i = 0; i < number; ++i) {
+        points[i].x = (double(i % side) + jitter(gen)) / side;
+        points[i].y = (double(i / side) + jitter(gen)) / side;
+    }
+    return points;
+}
+
+
+struct Distribution {
+    const char *name;
+    std::vector<Point2D> (*generate)(size_t, std::mt19937 &);
+};
+
+
+const Distribution DISTRIBUTIONS[] = {
+    {"uniform", uniformPoints},
+    {"normal", normalPoints},
+    {"clusters", clusteredPoints},
+    {"grid", gridPoints},
+};
+
+
+double peakRSSMegabytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+    return usage.ru_maxrss / 1024.0;             // kilobytes
+#endif
+}
+
+
+// Profile of the last sweep, filled by a library built with FORTUNE_SWEEP_PROFILE
+void printProfile(const SweepStats &stats) {
+    double total = stats.queue_time + stats.beachline_time + stats.output_time;
+    if (total <= 0.0) {
+        total = 1.0;
+    }
+    printf("    events: %zu sites (%zu beside, %zu dropped), %zu circles pushed, %zu cancelled, %zu false\n",
+           stats.site_events, stats.sites_beside, stats.sites_dropped, stats.circle_events_pushed,
+           stats.circle_events_cancelled, stats.circle_events_false);
+    printf("    beachline: %zu max / %.0f mean arcs, height %d max / %.1f mean, %zu rebalances\n",
+           stats.max_beachline_arcs, stats.mean_beachline_arcs, stats.max_beachline_height,
+           stats.mean_beachline_height, stats.rebalances);
+    printf("    time: queue %.0f%%, beachline %.0f%%, output %.0f%%\n", 100.0 * stats.queue_time / total,
+           100.0 * stats.beachline_time / total, 100.0 * stats.output_time / total);
+}
+
+
+// Uniform sites where every 4th one repeats an earlier site, `unique` are the same sites
+// without the repeats and `first[i]` is the index of the first copy of site i among them
+void repeatedPoints(size_t n, std::vector<Point2D> &points, std::vector<Point2D> &unique,
+                    std::vector<uint32_t> &first) {
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        if (i % 4 == 3) {
+            size_t j = gen() % i;
+            points.push_back(points[j]);
+            first.push_back(first[j]);
+        } else {
+            points.push_back(Point2D(uniform(gen), uniform(gen)));
+            first.push_back(static_cast<uint32_t>(unique.size()));
+            unique.push_back(points.back());
+        }
+    }
+}
+
+
+// Clips the cells of uniform sites with a quarter of them repeated and of the same sites
+// without the repeats, prints whether the cells match
+bool checkRepeatedCells(size_t n, BeachlineType beachline) {
+    std::vector<Point2D> points, unique;
+    std::vector<uint32_t> first;
+    repeatedPoints(n, points, unique, first);
+
+    VoronoiBuilder builder(beachline);
+    BoundingBox box(0.0, 0.0, 1.0, 1.0);
+    ClippedCells cells, reference;
+    clip_cells(points, builder.build(points), box, cells);
+    clip_cells(unique, builder.build(unique), box, reference);
+
+    bool same = true;
+    std::vector<char> seen(unique.size(), 0);
+    for (size_t i = 0; same && i < n; ++i) {
+        uint32_t u = first[i];
+        if (seen[u]) {
+            same = cells.cell_size(i) == 0;
+            continue;
+        }
+        seen[u] = 1;
+        same = cells.cell_size(i) == reference.cell_size(u);
+        for (size_t k = 0; same && k < cells.cell_size(i); ++k) {
+            size_t a = cells.offsets[i] + k, b = reference.offsets[u] + k;
+            int other = cells.neighbour[a];
+            same = cells.x[a] == reference.x[b] && cells.y[a] == reference.y[b] &&
+                   (other == BOX_EDGE ? BOX_EDGE : static_cast<int>(first[other])) == reference.neighbour[b];
+        }
+    }
+    printf("clip_cells/repeats/%zu: %zu sites repeated, %s\n", n, n - unique.size(), same ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return same;
+}
+
+
+// Rotation of the corners of triangle t of `b` which makes it triangle t of `a`, -1 if there is none
+int cornerRotation(const DelaunayTriangles &a, const DelaunayTriangles &b, size_t t) {
+    for (int r = 0; r < 3; ++r) {
+        bool same = true;
+        for (int k = 0; same && k < 3; ++k) {
+            size_t i = 3 * t + k, j = 3 * t + (k + r) % 3;
+            same = a.triangles[i] == b.triangles[j] && a.neighbours[i] == b.neighbours[j];
+        }
+        if (same) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ Check the triangles built by the sweep against the ones collected from the diagram:
+ triangle t has the same corners and neighbours in both up to a rotation, the corners
+ go counterclockwise and every neighbour has t across the same edge.
+ */
+bool sameTriangles(const std::vector<Point2D> &points, const DelaunayTriangles &swept,
+                   const DelaunayTriangles &collected) {
+    if (swept.triangles_num() != collected.triangles_num() || swept.neighbours.size() != swept.triangles.size()) {
+        return false;
+    }
+    const std::vector<uint32_t> &corners = swept.triangles, &neighbours = swept.neighbours;
+    for (size_t t = 0; t < swept.triangles_num(); ++t) {
+        if (cornerRotation(swept, collected, t) < 0 ||
+            orient2d(points[corners[3 * t]], points[corners[3 * t + 1]], points[corners[3 * t + 2]]) <= 0.0) {
+            return false;
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            uint32_t u = neighbours[3 * t + k];
+            if (u == bl::NO_INDEX) {
+                continue;
+            }
+            // the edge from corner k + 1 to corner k + 2 goes the other way around u
+            uint32_t l = corners[3 * t + (k + 1) % 3], r = corners[3 * t + (k + 2) % 3];
+            bool twin = false;
+            for (size_t m = 0; !twin && m < 3 && u < swept.triangles_num(); ++m) {
+                twin = corners[3 * u + (m + 1) % 3] == r && corners[3 * u + (m + 2) % 3] == l &&
+                       neighbours[3 * u + m] == t;
+            }
+            if (!twin) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Builds the triangles of uniform sites with a quarter of them repeated both ways,
+// prints whether they match each other and the triangles of the sites without the repeats
+bool checkRepeatedTriangles(size_t n, BeachlineType beachline) {
+    std::vector<Point2D> points, unique;
+    std::vector<uint32_t> first;
+    repeatedPoints(n, points, unique, first);
+
+    VoronoiBuilder builder(beachline);
+    SweepBuffers buffers;
+    buffers.beachline = beachline;
+    DelaunayTriangles swept, collected, reference;
+    build_voronoi(points, swept, buffers);
+    make_triangles(builder.build(points), collected);
+    build_voronoi(unique, reference, buffers);
+
+    bool same = sameTriangles(points, swept, collected) && swept.triangles_num() == reference.triangles_num();
+    for (size_t i = 0; same && i < swept.triangles.size(); ++i) {
+        same = first[swept.triangles[i]] == reference.triangles[i] && swept.neighbours[i] == reference.neighbours[i];
+    }
+    printf("triangles/repeats/%zu: %zu sites repeated, %s\n", n, n - unique.size(), same ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return same;
+}
+
+
+std::vector<std::string> splitList(const char *list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+
+int main(int argc, const char *argv[]) {
+
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000, 10000000};
+    std::vector<std::string> dists;
+    double min_time = 0.5;
+    BeachlineType beachline = AVL_BEACHLINE;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sizes") == 0) {
+            sizes.clear();
+            for (const std::string &s : splitList(argv[i + 1])) {
+                sizes.push_back(static_cast<size_t>(std::stod(s)));
+            }
+        } else if (strcmp(argv[i], "--dists") == 0) {
+            dists = splitList(argv[i + 1]);
+        } else if (strcmp(argv[i], "--min-time") == 0) {
+            min_time = std::atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "--beachline") == 0) {
+            beachline = strcmp(argv[i + 1], "wide") == 0 ? WIDE_BEACHLINE : AVL_BEACHLINE;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    printf("seed: %u, min time: %.2f s, beachline: %s\n", SEED, min_time,
+           beachline == WIDE_BEACHLINE ? "wide" : "avl");
+    printf("%-32s %12s %6s %12s %10s %8s %12s\n", "benchmark", "time, ms", "iters", "sites/s", "ns/event", "allocs", "peak RSS, MB");
+
+    bool checks_ok = true;
+    for (size_t n : sizes) {
+        for (const Distribution &dist : DISTRIBUTIONS) {
+
+            bool selected = dists.empty();
+            for (const std::string &name : dists) {
+                selected = selected || name == dist.name;
+            }
+            if (!selected) {
+                continue;
+            }
+
+            std::mt19937 gen(SEED);
+            std::vector<Point2D> points = dist.generate(n, gen);
+            VoronoiBuilder builder(beachline);
+            SweepStats stats;
+
+            int iterations = 0;
+            double total = 0.0;
+            size_t allocs = 0;
+            while (iterations == 0 || total < min_time) {
+                size_t allocs_before = allocations_num;
+                auto start = std::chrono::steady_clock::now();
+                builder.build(points, &stats);
+                auto finish = std::chrono::steady_clock::now();
+                allocs = allocations_num - allocs_before;
+                total += std::chrono::duration<double>(finish - start).count();
+                ++iterations;
+            }
+
+            double seconds = total / iterations;
+            size_t events = n + stats.circle_events_processed + stats.circle_events_false;
+
+            char name[64];
+            snprintf(name, sizeof(name), "build_voronoi/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %6d %12.4g %10.1f %8zu %12.1f\n", name, 1.0e3 * seconds, iterations,
+                   n / seconds, 1.0e9 * seconds / events, allocs, peakRSSMegabytes());
+#ifdef FORTUNE_SWEEP_PROFILE
+            printProfile(stats);
+#endif
+            fflush(stdout);
+
+            ClippedCells cells;
+            BoundingBox box(0.0, 0.0, 1.0, 1.0);
+            iterations = 0;
+            total = 0.0;
+            while (iterations == 0 || total < min_time) {
+                size_t allocs_before = allocations_num;
+                auto start = std::chrono::steady_clock::now();
+                clip_cells(points, builder.diagram(), box, cells);
+                auto finish = std::chrono::steady_clock::now();
+                allocs = allocations_num - allocs_before;
+                total += std::chrono::duration<double>(finish - start).count();
+                ++iterations;
+            }
+
+            seconds = total / iterations;
+            snprintf(name, sizeof(name), "clip_cells/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %6d %12.4g %10s %8zu %12.1f\n", name, 1.0e3 * seconds, iterations,
+                   n / seconds, "-", allocs, peakRSSMegabytes());
+            fflush(stdout);
+
+            DelaunayTriangles triangles;
+            SweepBuffers buffers;
+            buffers.beachline = beachline;
+            iterations = 0;
+            total = 0.0;
+            while (iterations == 0 || total < min_time) {
+                size_t allocs_before = allocations_num;
+                auto start = std::chrono::steady_clock::now();
+                build_voronoi(points, triangles, buffers, &stats);
+                auto finish = std::chrono::steady_clock::now();
+                allocs = allocations_num - allocs_before;
+                total += std::chrono::duration<double>(finish - start).count();
+                ++iterations;
+            }
+
+            seconds = total / iterations;
+            snprintf(name, sizeof(name), "delaunay/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %6d %12.4g %10.1f %8zu %12.1f\n", name, 1.0e3 * seconds, iterations,
+                   n / seconds, 1.0e9 * seconds / events, allocs, peakRSSMegabytes());
+            fflush(stdout);
+
+            DelaunayTriangles collected;
+            iterations = 0;
+            total = 0.0;
+            while (iterations == 0 || total < min_time) {
+                size_t allocs_before = allocations_num;
+                auto start = std::chrono::steady_clock::now();
+                make_triangles(builder.diagram(), collected);
+                auto finish = std::chrono::steady_clock::now();
+                allocs = allocations_num - allocs_before;
+                total += std::chrono::duration<double>(finish - start).count();
+                ++iterations;
+            }
+
+            seconds = total / iterations;
+            snprintf(name, sizeof(name), "make_triangles/%s/%zu", dist.name, n);
+            printf("%-32s %12.3f %6d %12.4g %10s %8zu %12.1f\n", name, 1.0e3 * seconds, iterations,
+                   n / seconds, "-", allocs, peakRSSMegabytes());
+
+            bool same = sameTriangles(points, triangles, collected);
+            printf("triangles/%s/%zu: %s\n", dist.name, n, same ? "ok" : "MISMATCH");
+            fflush(stdout);
+            checks_ok = same && checks_ok;
+        }
+        checks_ok = checkRepeatedCells(n, beachline) && checks_ok;
+        checks_ok = checkRepeatedTriangles(n, beachline) && checks_ok;
+    }
+
+    return checks_ok ? 0 : 1;
+}
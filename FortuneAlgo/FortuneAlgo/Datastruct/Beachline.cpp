@@ -11,121 +11,201 @@
 namespace beachline {
 
     
-    BLNode::BLNode(const std::pair<int,int>& _indices,
-                   double* _sweepline ,
-                   const std::vector<Point2D>* _points,
-                   BLNodePtr _left,
-                   BLNodePtr _right,
-                   BLNodePtr _parent,
-                   int _height) : indices(_indices), left(_left), right(_right),
-                                  parent(_parent), height(_height),
-                                  sweepline(_sweepline), points(_points),
-                                  next(nullptr), prev(nullptr) {}
-
-
-    double BLNode::value() {
+    template<typename T>
+    BLNodeT<T>::BLNodeT(const std::pair<int,int>& _indices,
+                        BLNodePtr _left,
+                        BLNodePtr _right,
+                        BLNodePtr _parent,
+                        int _height) : height(_height), indices(_indices),
+                                  left(_left), right(_right), parent(_parent),
+                                  next(NO_NODE), prev(NO_NODE), circle_event(NO_EVENT), edge(NO_INDEX),
+                                  cached_x(0), cached_epoch(0) {}
+    
+    
+    template<typename T>
+    BLNodePoolT<T>::BLNodePoolT(const Point2DT<T> *_points) :
+        points(_points), value_hits(0), value_misses(0), rotations(0), sweepline(0), epoch(1) {}
+    
+    
+    template<typename T>
+    BLNodePtr BLNodePoolT<T>::create(const std::pair<int,int> &indices) {
+        if (!free_nodes.empty()) {
+            BLNodePtr node = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[node] = BLNodeT<T>(indices);
+            return node;
+        }
+        assert(nodes.size() < NO_NODE);
+        nodes.push_back(BLNodeT<T>(indices));
+        return static_cast<BLNodePtr>(nodes.size() - 1);
+    }
+    
+    
+    template<typename T>
+    void BLNodePoolT<T>::release(BLNodePtr node) {
+        assert(nodes[node].circle_event == NO_EVENT);
+        free_nodes.push_back(node);
+    }
+    
+    
+    template<typename T>
+    void BLNodePoolT<T>::reserve(size_t n) {
+        nodes.reserve(n);
+    }
+    
+    
+    template<typename T>
+    void BLNodePoolT<T>::clear() {
+        nodes.clear();
+        free_nodes.clear();
+        sweepline = 0;
+        value_hits = 0;
+        value_misses = 0;
+        rotations = 0;
+    }
+    
+    
+    template<typename T>
+    size_t BLNodePoolT<T>::size() const {
+        return nodes.size() - free_nodes.size();
+    }
+    
+    
+    template<typename T>
+    void BLNodePoolT<T>::set_sweepline(T y) {
+        if (y == sweepline) {
+            return;
+        }
+        sweepline = y;
+        if (++epoch == 0) {
+            // counter wrapped around, old tags could look valid again
+            for (BLNodeT<T> &n : nodes) {
+                n.cached_epoch = 0;
+            }
+            epoch = 1;
+        }
+    }
+    
+    
+    template<typename T>
+    void BLNodePoolT<T>::set_indices(BLNodePtr node, const std::pair<int,int> &indices) {
+        nodes[node].indices = indices;
+        nodes[node].cached_epoch = 0;
+    }
+
+
+    template<typename T>
+    T BLNodePoolT<T>::value(BLNodePtr node) {
         if (points == nullptr)
-            return std::numeric_limits<double>::infinity();
-        if (is_leaf()) {
-            return (*points)[indices.first].x;
+            return std::numeric_limits<T>::infinity();
+        BLNodeT<T> &n = nodes[node];
+        if (n.is_leaf()) {
+            return points[n.indices.first].x;
         } else {
-            Point2D p1 = (*points)[indices.first], p2 = (*points)[indices.second];
-            
-            std::vector<Point2D> ips = findIntersectionPoints(p1, p2, *sweepline);
-            if (ips.size() == 2) {
-                if (p1.y < p2.y) {
-                    return ips[0].x;
-                } else {
-                    return ips[1].x;
-                }
-            } else {
-                return ips[0].x;
+            if (n.cached_epoch == epoch) {
+                ++value_hits;
+                return n.cached_x;
             }
+            ++value_misses;
+            n.cached_x = findBreakpoint(points[n.indices.first], points[n.indices.second], sweepline);
+            n.cached_epoch = epoch;
+            return n.cached_x;
         }
     }
 
     /**
      Connect as a list
      */
-    void connect(BLNodePtr prev, BLNodePtr next) {
-        prev->next = next;
-        next->prev = prev;
+    template<typename T>
+    void connect(BLNodePoolT<T> &pool, BLNodePtr prev, BLNodePtr next) {
+        pool[prev].next = next;
+        pool[next].prev = prev;
     }
 
 
     /**
      Check if the node is a root node
      */
-    bool is_root(BLNodePtr node) {
-        return node->parent == nullptr;
+    template<typename T>
+    bool is_root(BLNodePoolT<T> &pool, BLNodePtr node) {
+        return pool[node].parent == NO_NODE;
     }
 
 
     /**
      Get height of the node
      */
-    int get_height(BLNodePtr node) {
-        if (node == nullptr) return 0;
-        return node->height;
+    template<typename T>
+    int get_height(BLNodePoolT<T> &pool, BLNodePtr node) {
+        if (node == NO_NODE) return 0;
+        return pool[node].height;
     }
 
 
     /**
      Update height of the node
      */
-    void update_height(BLNodePtr node) {
-        if (node == nullptr)
+    template<typename T>
+    void update_height(BLNodePoolT<T> &pool, BLNodePtr node) {
+        if (node == NO_NODE)
             return;
-        node->height = std::max(get_height(node->left), get_height(node->right)) + 1;
+        pool[node].height = std::max(get_height(pool, pool[node].left), get_height(pool, pool[node].right)) + 1;
     }
 
 
     /**
      Get balance of the node (difference between the height of left and right subtrees)
      */
-    int get_balance(BLNodePtr node) {
-        return get_height(node->left) - get_height(node->right);
+    template<typename T>
+    int get_balance(BLNodePoolT<T> &pool, BLNodePtr node) {
+        return get_height(pool, pool[node].left) - get_height(pool, pool[node].right);
     }
 
 
     /**
      Performs rotation of a tree around `node` such that it goes to the left subtree
      */
-    BLNodePtr rotate_left(BLNodePtr node) {
+    template<typename T>
+    BLNodePtr rotate_left(BLNodePoolT<T> &pool, BLNodePtr node) {
         
-        if (node == nullptr)
-            return nullptr;
+        if (node == NO_NODE)
+            return NO_NODE;
         
-        if (node->right == nullptr)
+        if (pool[node].right == NO_NODE)
             return node;
         
         // get right node, which becomes a new root node
-        BLNodePtr rnode = node->right;
+        BLNodePtr rnode = pool[node].right;
         
         // establish connections with a root node if threre is one
-        if (!is_root(node)) {
-            if (node->parent->left == node) {
-                node->parent->left = rnode;
+        if (!is_root(pool, node)) {
+            BLNodeT<T> &parent = pool[pool[node].parent];
+            if (parent.left == node) {
+                parent.left = rnode;
             } else {
-                node->parent->right = rnode;
+                parent.right = rnode;
             }
         }
-        rnode->parent = node->parent;
+        pool[rnode].parent = pool[node].parent;
         
         // connect right subtree of the left child as a left subtree of `node`
-        node->right = rnode->left;
-        if (rnode->left != nullptr) {
-            rnode->left->parent = node;
+        pool[node].right = pool[rnode].left;
+        if (pool[rnode].left != NO_NODE) {
+            pool[pool[rnode].left].parent = node;
         }
         
         // connect `node` as a right child of it's child
-        rnode->left = node;
-        node->parent = rnode;
+        pool[rnode].left = node;
+        pool[node].parent = rnode;
         
         // update height attribute
-        update_height(node);
-        update_height(rnode);
-        update_height(rnode->parent);
+        update_height(pool, node);
+        update_height(pool, rnode);
+        update_height(pool, pool[rnode].parent);
+        
+#ifdef FORTUNE_SWEEP_PROFILE
+        pool.rotations++;
+#endif
         
         return rnode;
     }
@@ -134,41 +214,47 @@ namespace beachline {
     /**
      Performs rotation of a tree around `node` such that it goes to the right subtree
      */
-    BLNodePtr rotate_right(BLNodePtr node) {
+    template<typename T>
+    BLNodePtr rotate_right(BLNodePoolT<T> &pool, BLNodePtr node) {
         
-        if (node == nullptr)
-            return nullptr;
+        if (node == NO_NODE)
+            return NO_NODE;
         
-        if (node->left == nullptr)
+        if (pool[node].left == NO_NODE)
             return node;
         
         // left node becomes root node of subtree
-        BLNodePtr lnode = node->left;
+        BLNodePtr lnode = pool[node].left;
         
         // establish connections with a root node if threre is one
-        if (!is_root(node)) {
-            if (node->parent->left == node) {
-                node->parent->left = lnode;
+        if (!is_root(pool, node)) {
+            BLNodeT<T> &parent = pool[pool[node].parent];
+            if (parent.left == node) {
+                parent.left = lnode;
             } else {
-                node->parent->right = lnode;
+                parent.right = lnode;
             }
         }
-        lnode->parent = node->parent;
+        pool[lnode].parent = pool[node].parent;
         
         // connect right subtree of the left child as a left subtree of `node`
-        node->left = lnode->right;
-        if (lnode->right != nullptr) {
-            lnode->right->parent = node;
+        pool[node].left = pool[lnode].right;
+        if (pool[lnode].right != NO_NODE) {
+            pool[pool[lnode].right].parent = node;
         }
         
         // connect `node` as a right child of it's child
-        lnode->right = node;
-        node->parent = lnode;
+        pool[lnode].right = node;
+        pool[node].parent = lnode;
         
         // update height attribute
-        update_height(node);
-        update_height(lnode);
-        update_height(lnode->parent);
+        update_height(pool, node);
+        update_height(pool, lnode);
+        update_height(pool, pool[lnode].parent);
+        
+#ifdef FORTUNE_SWEEP_PROFILE
+        pool.rotations++;
+#endif
         
         return lnode;
     }
@@ -178,85 +264,104 @@ namespace beachline {
      Find a leaf in a tree such that x is under the parabolic arc,
      which corresponds to this leaf.
      */
-    BLNodePtr find(BLNodePtr root, double x) {
-        if (root == nullptr) {
-            return nullptr;
+    template<typename T>
+    BLNodePtr find(BLNodePoolT<T> &pool, BLNodePtr root, T x) {
+        if (root == NO_NODE) {
+            return NO_NODE;
         }
         BLNodePtr node = root;
-        while (!node->is_leaf()) {
-            if (node->value() < x) {
-                node = node->right;
+        while (!pool[node].is_leaf()) {
+            if (pool.value(node) < x) {
+                node = pool[node].right;
             } else {
-                node = node->left;
+                node = pool[node].left;
             }
         }
         return node;
     }
 
 
+    /**
+     Rebalance the tree going up from `node`.
+     Returns the index of a root node.
+     */
+    template<typename T>
+    static BLNodePtr rebalance(BLNodePoolT<T> &pool, BLNodePtr node) {
+        BLNodePtr root = node;
+        while (node != NO_NODE) {
+            // update height of a node
+            update_height(pool, node);
+            // calculate balance factor of a node
+            int balance = get_balance(pool, node);
+            if (balance > 1) { // left subtree is higher than right subtree by more than 1
+                BLNodePtr left = pool[node].left;
+                if (left != NO_NODE && !pool[left].is_leaf() && get_balance(pool, left) < 0) { // @TODO ensure that
+                    pool[node].left = rotate_left(pool, left);
+                }
+                node = rotate_right(pool, node);
+            } else if (balance < -1) { // right subtree is lower than left subtree by more than 1
+                BLNodePtr right = pool[node].right;
+                if (right != NO_NODE && !pool[right].is_leaf() && get_balance(pool, right) > 0) {
+                    pool[node].right = rotate_right(pool, right);
+                }
+                node = rotate_left(pool, node);
+            }
+            
+            //_validate(pool, node);
+            
+            root = node;
+            node = pool[node].parent;
+        }
+        return root;
+    }
+
+
     /**
      Replace a leaf `node` with a new subtree, which has root `new_node`.
-     The function rebalances the tree and returns the pointer to a new root node.
+     The leaf is released to the pool.
+     The function rebalances the tree and returns the index of a new root node.
      */
-    BLNodePtr replace(BLNodePtr node, BLNodePtr new_node) {
+    template<typename T>
+    BLNodePtr replace(BLNodePoolT<T> &pool, BLNodePtr node, BLNodePtr new_node) {
         
-        if (node == nullptr) {
+        if (node == NO_NODE) {
             return new_node;
         }
         
-        // Find x-coordinate
-        double x = new_node->value();
-        
         // Get a parent node
-        BLNodePtr parent_node = node->parent;
-        
-        // Remove leaf, because it's replaced by a new subtree
-        //        delete node;
-        
-        // Insert the node
-        new_node->parent = parent_node;
-        if (parent_node != nullptr) {
-            if (parent_node->value() < x) {
-                parent_node->right = new_node;
+        BLNodePtr parent_node = pool[node].parent;
+        
+        // Insert the node in place of the leaf (comparing breakpoint values
+        // here is unreliable when both breakpoints are close to each other)
+        pool[new_node].parent = parent_node;
+        if (parent_node != NO_NODE) {
+            if (pool[parent_node].right == node) {
+                pool[parent_node].right = new_node;
             } else {
-                parent_node->left = new_node;
+                pool[parent_node].left = new_node;
             }
         }
         
+        // Remove leaf, because it's replaced by a new subtree
+        pool.release(node);
+        
         // Rebalance the tree
-        node = new_node;
-        while (parent_node != nullptr) {
-            update_height(parent_node);
-            int balance = get_balance(parent_node);
-            if (balance > 1) { // left subtree is higher than right subtree by more than 1
-                if (parent_node->left != nullptr && !parent_node->left->is_leaf() && get_balance(parent_node->left) < 0) { // @TODO ensure that
-                    parent_node->left = rotate_left(parent_node->left);
-                }
-                parent_node = rotate_right(parent_node);
-            } else if (balance < -1) { // right subtree is lower than left subtree by more than 1
-                if (parent_node->right != nullptr && !parent_node->right->is_leaf() && get_balance(parent_node->right) > 0) {
-                    parent_node->right = rotate_right(parent_node->right);
-                }
-                parent_node = rotate_left(parent_node);
-            }
-            
-            //_validate(parent_node);
-            
-            node = parent_node;
-            parent_node = parent_node->parent;
-        }
+        BLNodePtr root = (parent_node != NO_NODE) ? rebalance(pool, parent_node) : new_node;
         
-        //_check_balance(node);
+        //_check_balance(pool, root);
         
-        return node;
+        return root;
     }
 
 
     /**
      Remove a disappearing arc related to a circle event.
-     The function rebalances the tree and returns the pointer to a new root node.
+     The remaining breakpoint between its neighbours gets the halfedge `edge`.
+     The leaf and its parent are released to the pool.
+     The function rebalances the tree and returns the index of a new root node.
      */
-    BLNodePtr remove(BLNodePtr leaf) {
+    template<typename T>
+    BLNodePtr remove(BLNodePoolT<T> &pool, BLNodePtr leaf, uint32_t edge) {
         
         // General idea behind this code:
         // This function removes the leaf and it's parent corresponding to one breakpoint.
@@ -264,71 +369,63 @@ namespace beachline {
         // it replaces this breakpoint with a new one. This is possible because when the circle
         // event appears, two breakpoints coincide and thus they should be represented by one.
         
-        if (leaf == nullptr)
-            return nullptr;
+        if (leaf == NO_NODE)
+            return NO_NODE;
         
-        BLNodePtr parent = leaf->parent, grandparent = parent->parent;
-        std::pair<int,int> bp1(leaf->prev->get_id(), leaf->get_id());
-        std::pair<int,int> bp2(leaf->get_id(), leaf->next->get_id());
-        std::pair<int,int> other_bp;
+        BLNodePtr prev = pool[leaf].prev, next = pool[leaf].next;
+        BLNodePtr parent = pool[leaf].parent, grandparent = pool[parent].parent;
+        
+        assert(next != NO_NODE);
+        assert(prev != NO_NODE);
+        assert(parent != NO_NODE);
+        assert(grandparent != NO_NODE);
         
-        assert(leaf->next != nullptr);
-        assert(leaf->prev != nullptr);
-        assert(parent != nullptr);
-        assert(grandparent != nullptr);
+        std::pair<int,int> bp1(pool[prev].get_id(), pool[leaf].get_id());
+        std::pair<int,int> bp2(pool[leaf].get_id(), pool[next].get_id());
+        std::pair<int,int> other_bp;
         
-        assert(parent->has_indices(bp1) || parent->has_indices(bp2));
+        assert(pool[parent].has_indices(bp1) || pool[parent].has_indices(bp2));
         
-        if (parent->has_indices(bp1)) {
+        if (pool[parent].has_indices(bp1)) {
             other_bp = bp2;
-        } else if (parent->has_indices(bp2)) {
+        } else if (pool[parent].has_indices(bp2)) {
             other_bp = bp1;
         }
         
         BLNodePtr other_subtree;
-        if (parent->left == leaf)
-            other_subtree = parent->right;
+        if (pool[parent].left == leaf)
+            other_subtree = pool[parent].right;
         else
-            other_subtree = parent->left;
+            other_subtree = pool[parent].left;
         
-        other_subtree->parent = grandparent;
-        if (grandparent->left == parent) {
-            grandparent->left = other_subtree;
+        pool[other_subtree].parent = grandparent;
+        if (pool[grandparent].left == parent) {
+            pool[grandparent].left = other_subtree;
         } else {
-            grandparent->right = other_subtree;
+            pool[grandparent].right = other_subtree;
         }
         
-        BLNodePtr new_root = grandparent;
-        // Go up and rebalance the whole tree
-        while (grandparent != nullptr) {
-            if (grandparent->has_indices(other_bp))
-                grandparent->indices = std::make_pair(leaf->prev->get_id(), leaf->next->get_id());
-            // update height of a node
-            update_height(grandparent);
-            // calculate balance factor of a node
-            int balance = get_balance(grandparent);
-            if (balance > 1) { // left subtree is higher than right subtree by more than 1
-                if (grandparent->left != nullptr && !grandparent->left->is_leaf() && get_balance(grandparent->left) < 0) {
-                    grandparent->left = rotate_left(grandparent->left);
-                }
-                grandparent = rotate_right(grandparent);
-            } else if (balance < -1) { // right subtree is lower than left subtree by more than 1
-                if (grandparent->right != nullptr && !grandparent->right->is_leaf() && get_balance(grandparent->right) > 0) {
-                    grandparent->right = rotate_right(grandparent->right);
-                }
-                grandparent = rotate_left(grandparent);
+        // Replace the second breakpoint with a new one
+        std::pair<int,int> new_bp(pool[prev].get_id(), pool[next].get_id());
+        for (BLNodePtr node = grandparent; node != NO_NODE; node = pool[node].parent) {
+            if (pool[node].has_indices(other_bp)) {
+                pool.set_indices(node, new_bp);
+                pool[node].edge = edge;
+                break;
             }
-            
-            //_validate(grandparent);
-            
-            new_root = grandparent;
-            grandparent = grandparent->parent;
         }
         
+        // Go up and rebalance the whole tree
+        BLNodePtr new_root = rebalance(pool, grandparent);
+        
         // Connect previous with next leaf
-        connect(leaf->prev, leaf->next);
+        connect(pool, prev, next);
+        
+        // Nodes are not referenced by the tree anymore
+        pool.release(leaf);
+        pool.release(parent);
         
-        //_check_balance(new_root);
+        //_check_balance(pool, new_root);
         
         return new_root;
     }
@@ -337,32 +434,33 @@ namespace beachline {
     /**
      Returns breakpoints for a given arc
      */
-    std::pair<BLNodePtr, BLNodePtr> breakpoints(BLNodePtr leaf) {
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> breakpoints(BLNodePoolT<T> &pool, BLNodePtr leaf) {
         
-        if (leaf == nullptr || leaf->next == nullptr || leaf->prev == nullptr)
-            return std::make_pair<BLNodePtr>(nullptr, nullptr);
+        if (leaf == NO_NODE || pool[leaf].next == NO_NODE || pool[leaf].prev == NO_NODE)
+            return std::make_pair(NO_NODE, NO_NODE);
         
-        BLNodePtr parent = leaf->parent, gparent = leaf->parent;
-        std::pair<int,int> bp1(leaf->prev->get_id(), leaf->get_id()); // left breakpoint
-        std::pair<int,int> bp2(leaf->get_id(), leaf->next->get_id()); // right breakpoint
+        BLNodePtr parent = pool[leaf].parent, gparent = pool[leaf].parent;
+        std::pair<int,int> bp1(pool[pool[leaf].prev].get_id(), pool[leaf].get_id()); // left breakpoint
+        std::pair<int,int> bp2(pool[leaf].get_id(), pool[pool[leaf].next].get_id()); // right breakpoint
         std::pair<int,int> other_bp;
         
         bool left_is_missing = true;
         
-        if (parent->has_indices(bp1)) {
+        if (pool[parent].has_indices(bp1)) {
             other_bp = bp2;
             left_is_missing = false;
-        } else if (parent->has_indices(bp2)) {
+        } else if (pool[parent].has_indices(bp2)) {
             other_bp = bp1;
             left_is_missing = true;
         }
         
-        // Go up and rebalance the whole tree
-        while (gparent != nullptr) {
-            if (gparent->has_indices(other_bp)) {
+        // Go up and find the other breakpoint
+        while (gparent != NO_NODE) {
+            if (pool[gparent].has_indices(other_bp)) {
                 break;
             }
-            gparent = gparent->parent;
+            gparent = pool[gparent].parent;
         }
         
         if (left_is_missing) {
@@ -370,129 +468,238 @@ namespace beachline {
         } else {
             return std::make_pair(parent, gparent);
         }
-        
-//        // BUG doesn't take into account gparent WRONG!!!
-//        if (parent->parent != nullptr) {
-//            if (parent->parent->left == parent) {
-//                return std::make_pair(parent, gparent);
-//            } else {
-//                return std::make_pair(gparent, parent);
-//            }
-//        }
-//
-//        return std::make_pair(parent, gparent);
     }
 
 
-    BLNodePtr make_subtree(int index, int index_behind, double *sweepline,
-                           const std::vector<Point2D> *points,
-                           std::vector<HalfEdgePtr> &edges) {
+    template<typename T>
+    BLNodePtr make_subtree(BLNodePoolT<T> &pool, int index, int index_behind,
+                           const std::pair<uint32_t, uint32_t> &twin_edges) {
         
         // create nodes corresponding to branching points
-        BLNodePtr node1 = std::make_shared<BLNode>(std::make_pair(index_behind, index), sweepline, points);
-        BLNodePtr node2 = std::make_shared<BLNode>(std::make_pair(index, index_behind), sweepline, points);
+        BLNodePtr node1 = pool.create(std::make_pair(index_behind, index));
+        BLNodePtr node2 = pool.create(std::make_pair(index, index_behind));
         
         // create leaf nodes
-        BLNodePtr leaf1 = std::make_shared<BLNode>(std::make_pair(index_behind, index_behind), sweepline, points);
-        BLNodePtr leaf2 = std::make_shared<BLNode>(std::make_pair(index, index), sweepline, points);
-        BLNodePtr leaf3 = std::make_shared<BLNode>(std::make_pair(index_behind, index_behind), sweepline, points);
+        BLNodePtr leaf1 = pool.create(std::make_pair(index_behind, index_behind));
+        BLNodePtr leaf2 = pool.create(std::make_pair(index, index));
+        BLNodePtr leaf3 = pool.create(std::make_pair(index_behind, index_behind));
         
         // adjust tree connections
-        node1->right = node2;
-        node2->parent = node1;
+        pool[node1].right = node2;
+        pool[node2].parent = node1;
         
-        node1->left = leaf1;
-        leaf1->parent = node1;
+        pool[node1].left = leaf1;
+        pool[leaf1].parent = node1;
         
-        node2->left = leaf2;
-        leaf2->parent = node2;
+        pool[node2].left = leaf2;
+        pool[leaf2].parent = node2;
         
-        node2->right = leaf3;
-        leaf3->parent = node2;
+        pool[node2].right = leaf3;
+        pool[leaf3].parent = node2;
         
         // add halfedges
-        std::pair<HalfEdgePtr, HalfEdgePtr> twin_edges = make_twins(index_behind, index);
-        node1->edge = twin_edges.first;//second;//first;
-        node2->edge = twin_edges.second;//first;//second;
-        
-        edges.push_back(twin_edges.first);
-        edges.push_back(twin_edges.second);
+        pool[node1].edge = twin_edges.first;//second;//first;
+        pool[node2].edge = twin_edges.second;//first;//second;
         
         // connect leaf nodes
-        connect(leaf1, leaf2);
-        connect(leaf2, leaf3);
+        connect(pool, leaf1, leaf2);
+        connect(pool, leaf2, leaf3);
         
         // reset height of a node
-        update_height(node2);
-        update_height(node1);
+        update_height(pool, node2);
+        update_height(pool, node1);
         
         // return the result
         return node1;
     }
 
 
-    BLNodePtr make_simple_subtree(int index, int index_behind, double *sweepline,
-                                  const std::vector<Point2D> *points,
-                                  std::vector<HalfEdgePtr> &edges) {
+    template<typename T>
+    BLNodePtr make_simple_subtree(BLNodePoolT<T> &pool, int index, int index_behind,
+                                  const std::pair<uint32_t, uint32_t> &twin_edges) {
         
         BLNodePtr node, leaf_l, leaf_r;
         
-        std::pair<HalfEdgePtr, HalfEdgePtr> twin_edges = make_twins(index_behind, index);
-        
-        edges.push_back(twin_edges.first);
-        edges.push_back(twin_edges.second);
-        
-        if ((*points)[index].x < (*points)[index_behind].x) {
+        if (pool.points[index].x < pool.points[index_behind].x) {
             // Depends on the point order
-            node = std::make_shared<BLNode>(std::make_pair(index, index_behind), sweepline, points);
-            leaf_l = std::make_shared<BLNode>(std::make_pair(index, index), sweepline, points);
-            leaf_r = std::make_shared<BLNode>(std::make_pair(index_behind, index_behind), sweepline, points);
-            node->edge = twin_edges.second;//twin_edges.first;
+            node = pool.create(std::make_pair(index, index_behind));
+            leaf_l = pool.create(std::make_pair(index, index));
+            leaf_r = pool.create(std::make_pair(index_behind, index_behind));
+            pool[node].edge = twin_edges.second;//twin_edges.first;
         } else {
-            node = std::make_shared<BLNode>(std::make_pair(index_behind, index), sweepline, points);
-            leaf_l = std::make_shared<BLNode>(std::make_pair(index_behind, index_behind), sweepline, points);
-            leaf_r = std::make_shared<BLNode>(std::make_pair(index, index), sweepline, points);
-            node->edge = twin_edges.first;//twin_edges.second;
+            node = pool.create(std::make_pair(index_behind, index));
+            leaf_l = pool.create(std::make_pair(index_behind, index_behind));
+            leaf_r = pool.create(std::make_pair(index, index));
+            pool[node].edge = twin_edges.first;//twin_edges.second;
         }
         
-        node->left = leaf_l;
-        node->right = leaf_r;
+        pool[node].left = leaf_l;
+        pool[node].right = leaf_r;
         
-        leaf_l->parent = node;
-        leaf_r->parent = node;
+        pool[leaf_l].parent = node;
+        pool[leaf_r].parent = node;
         
-        connect(leaf_l, leaf_r);
-        update_height(node);
+        connect(pool, leaf_l, leaf_r);
+        update_height(pool, node);
         
         return node;
     }
 
 
-    bool _validate(BLNodePtr node) {
+    template<typename T>
+    AVLBeachlineT<T>::AVLBeachlineT() : root(NO_NODE), finger_search(false), finger(NO_NODE) {}
+    
+    
+    template<typename T>
+    void AVLBeachlineT<T>::reset(const Point2DT<T> *points) {
+        pool.clear();
+        pool.points = points;
+        root = NO_NODE;
+        finger = NO_NODE;
+    }
+    
+    
+    template<typename T>
+    int AVLBeachlineT<T>::tree_height() {
+        return root == NO_NODE ? 0 : pool[root].height;
+    }
+    
+    
+    template<typename T>
+    BLNodePtr AVLBeachlineT<T>::init(int site) {
+        root = pool.create(std::make_pair(site, site));
+        finger = root;
+        return root;
+    }
+    
+    
+    template<typename T>
+    BLNodePtr AVLBeachlineT<T>::find(T x) {
+        if (!finger_search || finger == NO_NODE)
+            return beachline::find(pool, root, x);
+        
+        // walk a few arcs along the list, breakpoints are compared the same way as in `find`
+        const Point2DT<T> *points = pool.points;
+        auto breakpoint_less = [&](BLNodePtr left, BLNodePtr right) {
+            ++pool.value_misses;
+            return findBreakpoint(points[pool[left].get_id()], points[pool[right].get_id()], pool.get_sweepline()) < x;
+        };
+        BLNodePtr arc = finger;
+        bool go_left = false, go_right = false;
+        for (int step = 0; ; ++step) {
+            BLNodePtr prev = pool[arc].prev, next = pool[arc].next;
+            if (!go_right && prev != NO_NODE && !breakpoint_less(prev, arc))
+                go_left = true;
+            else if (!go_left && next != NO_NODE && breakpoint_less(arc, next))
+                go_right = true;
+            else
+                return arc;
+            if (step == FINGER_STEPS)
+                break;
+            arc = go_left ? prev : next;
+        }
+        
+        // the arc is in the subtree on the side of the finger of the first breakpoint beyond `x`
+        BLNodePtr node = arc, parent = pool[node].parent;
+        while (parent != NO_NODE) {
+            bool from_left = pool[parent].left == node;
+            if (go_right && from_left && !(pool.value(parent) < x))
+                break;
+            if (go_left && !from_left && pool.value(parent) < x)
+                break;
+            node = parent;
+            parent = pool[node].parent;
+        }
+        return beachline::find(pool, node, x);
+    }
+    
+    
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> AVLBeachlineT<T>::split(BLNodePtr arc, int site,
+                                                            const std::pair<uint32_t, uint32_t> &twin_edges) {
+        BLNodePtr subtree = make_subtree(pool, site, pool[arc].get_id(), twin_edges);
+        BLNodePtr left_leaf = pool[subtree].left;
+        BLNodePtr right_leaf = pool[pool[subtree].right].right;
+        
+        if (pool[arc].prev != NO_NODE)
+            connect(pool, pool[arc].prev, left_leaf);
+        
+        if (pool[arc].next != NO_NODE)
+            connect(pool, right_leaf, pool[arc].next);
+        
+        // Replace old leaf with a subtree and rebalance it
+        root = replace(pool, arc, subtree);
+        finger = pool[left_leaf].next;
+        return std::make_pair(left_leaf, right_leaf);
+    }
+    
+    
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> AVLBeachlineT<T>::insert_beside(BLNodePtr arc, int site,
+                                                                    const std::pair<uint32_t, uint32_t> &twin_edges) {
+        BLNodePtr subtree = make_simple_subtree(pool, site, pool[arc].get_id(), twin_edges);
+        BLNodePtr left_leaf = pool[subtree].left;
+        BLNodePtr right_leaf = pool[subtree].right;
+        
+        if (pool[arc].prev != NO_NODE)
+            connect(pool, pool[arc].prev, left_leaf);
+        
+        if (pool[arc].next != NO_NODE)
+            connect(pool, right_leaf, pool[arc].next);
+        
+        root = replace(pool, arc, subtree);
+        finger = pool[left_leaf].get_id() == site ? left_leaf : right_leaf;
+        return std::make_pair(left_leaf, right_leaf);
+    }
+    
+    
+    template<typename T>
+    bool AVLBeachlineT<T>::breakpoint_edges(BLNodePtr arc, uint32_t &left, uint32_t &right) {
+        std::pair<BLNodePtr, BLNodePtr> nodes = breakpoints(pool, arc);
+        if (nodes.first == NO_NODE || nodes.second == NO_NODE)
+            return false;
+        left = pool[nodes.first].edge;
+        right = pool[nodes.second].edge;
+        return true;
+    }
+    
+    
+    template<typename T>
+    void AVLBeachlineT<T>::remove(BLNodePtr arc, uint32_t edge) {
+        if (finger == arc)
+            finger = pool[arc].prev;
+        root = beachline::remove(pool, arc, edge);
+    }
+
+
+    template<typename T>
+    bool _validate(BLNodePoolT<T> &pool, BLNodePtr node) {
         
-        if (node == nullptr)
+        if (node == NO_NODE)
             return true;
         
-        if (node->is_leaf()) {
-            if (node->left != nullptr || node->right != nullptr) {
-                std::cout << "LEAF NOT A LEAF: " << node->indices.first << ", " << node->indices.second << std::endl;
+        BLNodeT<T> &n = pool[node];
+        if (n.is_leaf()) {
+            if (n.left != NO_NODE || n.right != NO_NODE) {
+                std::cout << "LEAF NOT A LEAF: " << n.indices.first << ", " << n.indices.second << std::endl;
                 return false;
             }
         } else {
-            if (node->left == nullptr || node->right == nullptr) {
-                std::cout << " BP WITHOUT LEAF: " << node->indices.first << ", " << node->indices.second << std::endl;
+            if (n.left == NO_NODE || n.right == NO_NODE) {
+                std::cout << " BP WITHOUT LEAF: " << n.indices.first << ", " << n.indices.second << std::endl;
                 return false;
             }
         }
         return true;
     }
 
-    bool _check_balance(BLNodePtr node) {
-        if (node == nullptr) return true;
-        if (_check_balance(node->left) && _check_balance(node->right)) {
-            if (fabs(get_balance(node)) > 1) {
+    template<typename T>
+    bool _check_balance(BLNodePoolT<T> &pool, BLNodePtr node) {
+        if (node == NO_NODE) return true;
+        if (_check_balance(pool, pool[node].left) && _check_balance(pool, pool[node].right)) {
+            if (abs(get_balance(pool, node)) > 1) {
                 
-                std::cout << "+unbalanced (" << node->indices.first << ", " << node->indices.second << ")" << std::endl;
+                std::cout << "+unbalanced (" << pool[node].indices.first << ", " << pool[node].indices.second << ")" << std::endl;
                 
                 return false;
             }
@@ -504,31 +711,33 @@ namespace beachline {
     /**
      Print tree
      */
-    void print_tree(BLNodePtr root, int width) {
+    template<typename T>
+    void print_tree(BLNodePoolT<T> &pool, BLNodePtr root, int width) {
         
-        if (root == nullptr)
+        if (root == NO_NODE)
             return;
         
-        std::vector<std::vector<BLNodePtr>> layers(root->height);
+        int height = pool[root].height;
+        std::vector<std::vector<BLNodePtr>> layers(height);
         
         layers[0].push_back(root);
         int size = 2;
-        for (int i = 1; i < root->height; ++i) {
-            layers[i].resize(size);
+        for (int i = 1; i < height; ++i) {
+            layers[i].resize(size, NO_NODE);
             for (int j = 0; j < layers[i-1].size(); ++j) {
-                if (layers[i-1][j] != nullptr) {
-                    layers[i][2*j] = layers[i-1][j]->left;
-                    layers[i][2*j+1] = layers[i-1][j]->right;
+                if (layers[i-1][j] != NO_NODE) {
+                    layers[i][2*j] = pool[layers[i-1][j]].left;
+                    layers[i][2*j+1] = pool[layers[i-1][j]].right;
                 }
             }
             size *= 2;
         }
         
         size /= 2;
-        for (int i = 0; i < root->height; ++i) {
+        for (int i = 0; i < height; ++i) {
             for (int j = 0; j < layers[i].size(); ++j) {
-                if (layers[i][j] != nullptr)
-                    std::cout << std::setw(width * size) << "<" << layers[i][j]->indices.first << ", " << layers[i][j]->indices.second << ">";
+                if (layers[i][j] != NO_NODE)
+                    std::cout << std::setw(width * size) << "<" << pool[layers[i][j]].indices.first << ", " << pool[layers[i][j]].indices.second << ">";
                 else
                     std::cout << std::setw(width * size) << "      ";
             }
@@ -537,6 +746,29 @@ namespace beachline {
         }
     }
 
-}
 
+#define INSTANTIATE_BEACHLINE(T) \
+    template class BLNodeT<T>; \
+    template class BLNodePoolT<T>; \
+    template class AVLBeachlineT<T>; \
+    template void connect(BLNodePoolT<T> &, BLNodePtr, BLNodePtr); \
+    template bool is_root(BLNodePoolT<T> &, BLNodePtr); \
+    template int get_height(BLNodePoolT<T> &, BLNodePtr); \
+    template void update_height(BLNodePoolT<T> &, BLNodePtr); \
+    template int get_balance(BLNodePoolT<T> &, BLNodePtr); \
+    template BLNodePtr rotate_left(BLNodePoolT<T> &, BLNodePtr); \
+    template BLNodePtr rotate_right(BLNodePoolT<T> &, BLNodePtr); \
+    template BLNodePtr find(BLNodePoolT<T> &, BLNodePtr, T); \
+    template BLNodePtr replace(BLNodePoolT<T> &, BLNodePtr, BLNodePtr); \
+    template BLNodePtr remove(BLNodePoolT<T> &, BLNodePtr, uint32_t); \
+    template std::pair<BLNodePtr, BLNodePtr> breakpoints(BLNodePoolT<T> &, BLNodePtr); \
+    template BLNodePtr make_subtree(BLNodePoolT<T> &, int, int, const std::pair<uint32_t, uint32_t> &); \
+    template BLNodePtr make_simple_subtree(BLNodePoolT<T> &, int, int, const std::pair<uint32_t, uint32_t> &); \
+    template bool _validate(BLNodePoolT<T> &, BLNodePtr); \
+    template bool _check_balance(BLNodePoolT<T> &, BLNodePtr); \
+    template void print_tree(BLNodePoolT<T> &, BLNodePtr, int);
+
+    INSTANTIATE_BEACHLINE(float)
+    INSTANTIATE_BEACHLINE(double)
 
+}
@@ -17,54 +17,58 @@
 #include <vector>
 #include <random>
 #include <cassert>
+#include <cstdint>
 
 #include "Parabola.hpp"
 #include "DCEL.hpp"
-
-
-class Event;
+#include "EventQueue.hpp"
 
 
 namespace beachline {
     
     using namespace DCEL;
     
-    class BLNode;
-    typedef std::shared_ptr<BLNode> BLNodePtr;
+    template<typename T> class BLNodeT;
+    template<typename T> class BLNodePoolT;
+    
+    // Nodes are addressed by 32-bit indices into a BLNodePool
+    typedef uint32_t BLNodePtr;
+    
+    // Index of a missing node (plays the role of nullptr)
+    const BLNodePtr NO_NODE = std::numeric_limits<BLNodePtr>::max();
 
-    class BLNode {
+    template<typename T>
+    class BLNodeT {
     public:
         
         // Height of the tree
         int height;
         
-        // Pointer to a position of a sweepline
-        double *sweepline;
-        
-        // Pointer to a vector of input points
-        const std::vector<Point2D> *points;
-        
         // Indices of the points
         std::pair<int, int> indices;
         
-        // Pointers to left, right children and parent node
+        // Indices of left, right children and parent node
         BLNodePtr left, right, parent;
         
-        // Pointer to a circle event for a leaf node or halfedge for an internal node
-        std::shared_ptr<Event> circle_event;
-        std::shared_ptr<HalfEdge> edge;
+        // Indices of a next and previous arc-nodes
+        BLNodePtr next, prev;
+        
+        // Handle of a pending circle event for a leaf node
+        uint32_t circle_event;
+        
+        // Index of a halfedge for an internal node
+        uint32_t edge;
+        
+        // Breakpoint x-coordinate computed at the sweepline epoch `cached_epoch`
+        T cached_x;
+        uint32_t cached_epoch;
         
         // Constructor
-        BLNode(const std::pair<int,int>& _indices,
-               double* _sweepline = nullptr,
-               const std::vector<Point2D>* _points = nullptr,
-               BLNodePtr _left = nullptr,
-               BLNodePtr _right = nullptr,
-               BLNodePtr _parent = nullptr,
-               int _height = 1);
-        
-        // Pointers to a next and previous arc-nodes
-        BLNodePtr next, prev;
+        BLNodeT(const std::pair<int,int>& _indices,
+                BLNodePtr _left = NO_NODE,
+                BLNodePtr _right = NO_NODE,
+                BLNodePtr _parent = NO_NODE,
+                int _height = 1);
         
         // Leaf is defined as <p_i,p_i>
         inline bool is_leaf() {
@@ -86,103 +90,323 @@ namespace beachline {
             return indices.first == p.first && indices.second == p.second;
         }
         
+    };
+    
+    
+    /**
+     Storage for the nodes of one beachline.
+     Removed nodes are recycled through a free list, all the memory
+     is released at once when the pool is destroyed or cleared.
+     */
+    template<typename T>
+    class BLNodePoolT {
+    public:
+        
+        // Input points, indexed by the sites of the nodes
+        const Point2DT<T> *points;
+        
+        // Number of breakpoint evaluations answered from the cache and computed anew
+        size_t value_hits, value_misses;
+        
+        // Number of rotations, counted with FORTUNE_SWEEP_PROFILE only
+        size_t rotations;
+        
+        BLNodePoolT(const Point2DT<T> *_points = nullptr);
+        
+        // Access a node by its index
+        inline BLNodeT<T> &operator[](BLNodePtr node) {
+            return nodes[node];
+        }
+        
+        // Create a new node, the index stays valid until the node is released
+        BLNodePtr create(const std::pair<int,int> &indices);
+        
+        // Return the node to the free list
+        void release(BLNodePtr node);
+        
+        // Reserve memory for `n` nodes
+        void reserve(size_t n);
+        
+        // Release all the nodes at once, the memory is kept for the next beachline
+        void clear();
+        
+        // Number of nodes in use
+        size_t size() const;
+        
+        // Move the sweepline, cached breakpoints stay valid only if it did not move
+        void set_sweepline(T y);
+        
+        inline T get_sweepline() const {
+            return sweepline;
+        }
+        
+        // Change the sites of a breakpoint and drop its cached value
+        void set_indices(BLNodePtr node, const std::pair<int,int> &indices);
+        
         // Return x-coordinate of:
         //  - in case of leaf node - corresponding focus of parabola;
         //  - in case of internal node - breakpoint;
-        double value();
+        T value(BLNodePtr node);
+        
+    private:
+        
+        std::vector<BLNodeT<T>> nodes;
+        std::vector<BLNodePtr> free_nodes;
+        
+        // Current position of the sweepline
+        T sweepline;
+        
+        // Incremented each time the sweepline moves, 0 marks an empty cache
+        uint32_t epoch;
         
     };
     
     
+    typedef BLNodeT<double> BLNode;
+    typedef BLNodePoolT<double> BLNodePool;
+    
+    
     /**
      Connect as a list
      */
-    void connect(BLNodePtr prev, BLNodePtr next);
+    template<typename T>
+    void connect(BLNodePoolT<T> &pool, BLNodePtr prev, BLNodePtr next);
 
 
     /**
      Check if the node is a root node
      */
-    bool is_root(BLNodePtr node);
+    template<typename T>
+    bool is_root(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Get height of the node
      */
-    int get_height(BLNodePtr node);
+    template<typename T>
+    int get_height(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Update height of the node
      */
-    void update_height(BLNodePtr node);
+    template<typename T>
+    void update_height(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Get balance of the node (difference between the height of left and right subtrees)
      */
-    int get_balance(BLNodePtr node);
+    template<typename T>
+    int get_balance(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Performs rotation of a tree around `node` such that it goes to the left subtree
      */
-    BLNodePtr rotate_left(BLNodePtr node);
+    template<typename T>
+    BLNodePtr rotate_left(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Performs rotation of a tree around `node` such that it goes to the right subtree
      */
-    BLNodePtr rotate_right(BLNodePtr node);
+    template<typename T>
+    BLNodePtr rotate_right(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Find a leaf in a tree such that x is under the parabolic arc,
      which corresponds to this leaf.
      */
-    BLNodePtr find(BLNodePtr root, double x);
+    template<typename T>
+    BLNodePtr find(BLNodePoolT<T> &pool, BLNodePtr root, T x);
     
 
     /**
      Replace a leaf `node` with a new subtree, which has root `new_node`.
-     The function rebalances the tree and returns the pointer to a new root node.
+     The leaf is released to the pool.
+     The function rebalances the tree and returns the index of a new root node.
      */
-    BLNodePtr replace(BLNodePtr node, BLNodePtr new_node);
+    template<typename T>
+    BLNodePtr replace(BLNodePoolT<T> &pool, BLNodePtr node, BLNodePtr new_node);
     
     
     /**
      Remove a disappearing arc related to a circle event.
-     The function rebalances the tree and returns the pointer to a new root node.
+     The remaining breakpoint between its neighbours gets the halfedge `edge`.
+     The leaf and its parent are released to the pool.
+     The function rebalances the tree and returns the index of a new root node.
      */
-    BLNodePtr remove(BLNodePtr leaf);;
+    template<typename T>
+    BLNodePtr remove(BLNodePoolT<T> &pool, BLNodePtr leaf, uint32_t edge);
     
     
     /**
      Returns breakpoints for a given arc
      */
-    std::pair<BLNodePtr, BLNodePtr> breakpoints(BLNodePtr leaf);
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> breakpoints(BLNodePoolT<T> &pool, BLNodePtr leaf);
+    
+    
+    /**
+     Make a subtree for a new arc `index`, which splits the arc `index_behind` in two.
+     `twin_edges` are indices of halfedges (index_behind, index) and (index, index_behind).
+     */
+    template<typename T>
+    BLNodePtr make_subtree(BLNodePoolT<T> &pool, int index, int index_behind,
+                           const std::pair<uint32_t, uint32_t> &twin_edges);
+    
+    
+    /**
+     Make a subtree for a new arc `index`, which is placed next to the arc `index_behind`
+     (both sites are on the same horizontal line).
+     `twin_edges` are indices of halfedges (index_behind, index) and (index, index_behind).
+     */
+    template<typename T>
+    BLNodePtr make_simple_subtree(BLNodePoolT<T> &pool, int index, int index_behind,
+                                  const std::pair<uint32_t, uint32_t> &twin_edges);
     
     
-    BLNodePtr make_subtree(int index, int index_behind, double *sweepline,
-                           const std::vector<Point2D> *points,
-                           std::vector<HalfEdgePtr> &edges);
+    /**
+     Beachline as an AVL tree of breakpoints over the arcs, built from the functions above.
+     Arcs are addressed by their leaf nodes.
+     
+     The sweep works with any beachline class that has the interface of this one,
+     see also WideBeachlineT.
+     */
+    template<typename T>
+    class AVLBeachlineT {
+    public:
+        
+        BLNodePoolT<T> pool;
+        
+        AVLBeachlineT();
+        
+        // Remove all the arcs, the memory is kept for the next beachline
+        void reset(const Point2DT<T> *points);
+
+        // Take the points from a new place, e.g. after the vector holding them has grown
+        inline void set_points(const Point2DT<T> *points) {
+            pool.points = points;
+        }
+        
+        inline void set_sweepline(T y) {
+            pool.set_sweepline(y);
+        }
+        
+        inline bool empty() const {
+            return root == NO_NODE;
+        }
+        
+        // Make the first arc
+        BLNodePtr init(int site);
+        
+        // Arcs passed along the list by the finger search before it climbs the tree
+        static const int FINGER_STEPS = 4;
+        
+        /**
+         Arc above `x`. With finger search the tree is entered from the last inserted arc:
+         if `x` is not under it or the next FINGER_STEPS arcs, the search climbs to the lowest
+         ancestor whose breakpoint is beyond `x` and descends from there. On inputs where consecutive sites are close
+         this costs O(log d) for a distance of d arcs instead of O(log n).
+         */
+        BLNodePtr find(T x);
+        
+        // Start searches from the last inserted arc
+        inline void set_finger_search(bool enabled) {
+            finger_search = enabled;
+        }
+        
+        inline int site(BLNodePtr arc) {
+            return pool[arc].get_id();
+        }
+        
+        inline BLNodePtr prev(BLNodePtr arc) {
+            return pool[arc].prev;
+        }
+        
+        inline BLNodePtr next(BLNodePtr arc) {
+            return pool[arc].next;
+        }
+        
+        inline uint32_t &circle_event(BLNodePtr arc) {
+            return pool[arc].circle_event;
+        }
+        
+        /**
+         Split `arc` by a new arc of `site` below it. Returns the two pieces of the old arc,
+         `twin_edges` go to the breakpoints to the left and to the right of the new arc.
+         */
+        std::pair<BLNodePtr, BLNodePtr> split(BLNodePtr arc, int site, const std::pair<uint32_t, uint32_t> &twin_edges);
+        
+        /**
+         Put a new arc of `site` next to `arc`, both sites are on the sweepline.
+         Returns the two arcs in their order, see make_simple_subtree.
+         */
+        std::pair<BLNodePtr, BLNodePtr> insert_beside(BLNodePtr arc, int site, const std::pair<uint32_t, uint32_t> &twin_edges);
+        
+        /**
+         Halfedges of the breakpoints to the left and to the right of `arc`.
+         Returns false if the arc is the first or the last one.
+         */
+        bool breakpoint_edges(BLNodePtr arc, uint32_t &left, uint32_t &right);
+        
+        /**
+         Remove a disappearing arc, the new breakpoint between its neighbours gets `edge`.
+         */
+        void remove(BLNodePtr arc, uint32_t edge);
+        
+        // Breakpoint evaluations answered from the cache and computed anew
+        inline size_t value_hits() const {
+            return pool.value_hits;
+        }
+        
+        inline size_t value_misses() const {
+            return pool.value_misses;
+        }
+        
+        // Rotations, counted with FORTUNE_SWEEP_PROFILE only
+        inline size_t rebalances() const {
+            return pool.rotations;
+        }
+        
+        // Number of arcs, the leaves of the tree
+        inline size_t arcs_num() const {
+            return (pool.size() + 1) / 2;
+        }
+        
+        // Nodes on the longest path from the root to a leaf
+        int tree_height();
+        
+    private:
+        
+        BLNodePtr root;
+        
+        // Whether `find` starts from `finger`
+        bool finger_search;
+        // Last inserted arc
+        BLNodePtr finger;
+        
+    };
     
     
-    BLNodePtr make_simple_subtree(int index, int index_behind, double *sweepline,
-                                  const std::vector<Point2D> *points,
-                                  std::vector<HalfEdgePtr> &edges);
+    typedef AVLBeachlineT<double> AVLBeachline;
     
     
-    bool _validate(BLNodePtr node);
+    template<typename T>
+    bool _validate(BLNodePoolT<T> &pool, BLNodePtr node);
     
     
-    bool _check_balance(BLNodePtr node);
+    template<typename T>
+    bool _check_balance(BLNodePoolT<T> &pool, BLNodePtr node);
 
 
     /**
      Print tree
      */
-    void print_tree(BLNodePtr root, int width = 7);
+    template<typename T>
+    void print_tree(BLNodePoolT<T> &pool, BLNodePtr root, int width = 7);
     
 }
 
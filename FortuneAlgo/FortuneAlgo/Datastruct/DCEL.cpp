@@ -14,27 +14,32 @@
 namespace DCEL {
     
    
-    Vertex::Vertex(const Point2D &pos, HalfEdgePtr incident_edge) : point(pos), edge(incident_edge)  { }
+    template<typename T>
+    VertexT<T>::VertexT(const Point2DT<T> &pos, HalfEdgePtrT<T> incident_edge) : point(pos), edge(incident_edge)  { }
     
     
-    HalfEdge::HalfEdge(int _l_index, int _r_index, VertexPtr _vertex) :
+    template<typename T>
+    HalfEdgeT<T>::HalfEdgeT(int _l_index, int _r_index, VertexPtrT<T> _vertex) :
         l_index(_l_index), r_index(_r_index), vertex(_vertex) {}
     
     
-    HalfEdgePtr HalfEdge::vertexNextCCW() {
+    template<typename T>
+    HalfEdgePtrT<T> HalfEdgeT<T>::vertexNextCCW() {
         return twin->prev;
     }
     
     
-    HalfEdgePtr HalfEdge::vertexNextCW() {
+    template<typename T>
+    HalfEdgePtrT<T> HalfEdgeT<T>::vertexNextCW() {
         return next->twin;
     }
     
     
-    std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(int left_index, int right_index) {
+    template<typename T>
+    std::pair<HalfEdgePtrT<T>, HalfEdgePtrT<T>> make_twins(int left_index, int right_index) {
         
-        HalfEdgePtr h = std::make_shared<HalfEdge>(left_index, right_index);
-        HalfEdgePtr h_twin = std::make_shared<HalfEdge>(right_index, left_index);
+        HalfEdgePtrT<T> h = std::make_shared<HalfEdgeT<T>>(left_index, right_index);
+        HalfEdgePtrT<T> h_twin = std::make_shared<HalfEdgeT<T>>(right_index, left_index);
         
         h->twin = h_twin;
         h_twin->twin = h;
@@ -43,15 +48,119 @@ namespace DCEL {
     }
     
     
-    std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(const std::pair<int,int> &indices) {
+    template<typename T>
+    void connect_halfedges(HalfEdgePtrT<T> p1, HalfEdgePtrT<T> p2) {
+        p1->next = p2;
+        p2->prev = p1;
+    }
+    
+    
+    template<typename T>
+    uint32_t FlatDiagramT<T>::add_vertex(const Point2DT<T> &point) {
+        vx.push_back(point.x);
+        vy.push_back(point.y);
+        return static_cast<uint32_t>(vx.size() - 1);
+    }
+    
+    
+    template<typename T>
+    std::pair<uint32_t, uint32_t> FlatDiagramT<T>::make_twins(int left_index, int right_index) {
         
-        return make_twins(indices.first, indices.second);
+        uint32_t h = static_cast<uint32_t>(twin.size()), h_twin = h + 1;
+        
+        twin.push_back(h_twin);
+        twin.push_back(h);
+        next.insert(next.end(), 2, NO_INDEX);
+        prev.insert(prev.end(), 2, NO_INDEX);
+        origin.insert(origin.end(), 2, NO_INDEX);
+        l_site.push_back(left_index);
+        l_site.push_back(right_index);
+        r_site.push_back(right_index);
+        r_site.push_back(left_index);
+        
+        return std::make_pair(h, h_twin);
     }
     
     
-    void connect_halfedges(HalfEdgePtr p1, HalfEdgePtr p2) {
-        p1->next = p2;
-        p2->prev = p1;
+    template<typename T>
+    void FlatDiagramT<T>::connect_halfedges(uint32_t h1, uint32_t h2) {
+        next[h1] = h2;
+        prev[h2] = h1;
     }
     
+    
+    template<typename T>
+    void FlatDiagramT<T>::reserve(size_t vertices_n, size_t halfedges_n) {
+        vx.reserve(vertices_n);
+        vy.reserve(vertices_n);
+        for (std::vector<uint32_t> *v : {&twin, &next, &prev, &origin, &l_site, &r_site}) {
+            v->reserve(halfedges_n);
+        }
+    }
+    
+    
+    template<typename T>
+    void FlatDiagramT<T>::clear() {
+        vx.clear();
+        vy.clear();
+        for (std::vector<uint32_t> *v : {&twin, &next, &prev, &origin, &l_site, &r_site, &faces}) {
+            v->clear();
+        }
+    }
+
+    
+    template<typename T>
+    void make_pointer_dcel(const FlatDiagramT<T> &diagram,
+                           std::vector<HalfEdgePtrT<T>> &halfedges,
+                           std::vector<VertexPtrT<T>> &vertices,
+                           std::vector<HalfEdgePtrT<T>> &faces) {
+        size_t vertices_num = diagram.vertices_num(), halfedges_num = diagram.halfedges_num();
+        
+        vertices.resize(vertices_num);
+        for (size_t i = 0; i < vertices_num; ++i) {
+            vertices[i] = std::make_shared<VertexT<T>>(Point2DT<T>(diagram.vx[i], diagram.vy[i]));
+        }
+        
+        halfedges.resize(halfedges_num);
+        for (size_t h = 0; h < halfedges_num; ++h) {
+            halfedges[h] = std::make_shared<HalfEdgeT<T>>(diagram.l_site[h], diagram.r_site[h]);
+        }
+        
+        for (size_t h = 0; h < halfedges_num; ++h) {
+            HalfEdgePtrT<T> he = halfedges[h];
+            he->twin = halfedges[diagram.twin[h]];
+            if (diagram.next[h] != NO_INDEX) {
+                he->next = halfedges[diagram.next[h]];
+            }
+            if (diagram.prev[h] != NO_INDEX) {
+                he->prev = halfedges[diagram.prev[h]];
+            }
+            uint32_t v = diagram.target(h);
+            if (v != NO_INDEX) {
+                he->vertex = vertices[v];
+                vertices[v]->edge = he;
+            }
+        }
+        
+        faces.assign(diagram.faces.size(), nullptr);
+        for (size_t i = 0; i < diagram.faces.size(); ++i) {
+            if (diagram.faces[i] != NO_INDEX) {
+                faces[i] = halfedges[diagram.faces[i]];
+            }
+        }
+    }
+    
+
+#define INSTANTIATE_DCEL(T) \
+    template class VertexT<T>; \
+    template class HalfEdgeT<T>; \
+    template class FlatDiagramT<T>; \
+    template std::pair<HalfEdgePtrT<T>, HalfEdgePtrT<T>> make_twins<T>(int, int); \
+    template void connect_halfedges(HalfEdgePtrT<T>, HalfEdgePtrT<T>); \
+    template void make_pointer_dcel(const FlatDiagramT<T> &, std::vector<HalfEdgePtrT<T>> &, \
+                                    std::vector<VertexPtrT<T>> &, std::vector<HalfEdgePtrT<T>> &);
+    
+    INSTANTIATE_DCEL(float)
+    INSTANTIATE_DCEL(double)
+    
 }
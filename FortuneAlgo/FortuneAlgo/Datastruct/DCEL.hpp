@@ -11,61 +11,152 @@
 
 #include "Point2D.h"
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+
 
 namespace DCEL {
 
-    class Vertex;
-    class HalfEdge;
+    template<typename T> class VertexT;
+    template<typename T> class HalfEdgeT;
     
-    typedef std::shared_ptr<HalfEdge> HalfEdgePtr;
-    typedef std::shared_ptr<Vertex> VertexPtr;
+    template<typename T> using HalfEdgePtrT = std::shared_ptr<HalfEdgeT<T>>;
+    template<typename T> using VertexPtrT = std::shared_ptr<VertexT<T>>;
 
 
-    class Vertex {
+    template<typename T>
+    class VertexT {
     public:
         
-        Point2D point;
-        HalfEdgePtr edge; // The edge points towards this vertex [-->o]
+        Point2DT<T> point;
+        HalfEdgePtrT<T> edge; // The edge points towards this vertex [-->o]
         
-        Vertex(const Point2D &pos, HalfEdgePtr incident_edge = nullptr);
+        VertexT(const Point2DT<T> &pos, HalfEdgePtrT<T> incident_edge = nullptr);
         
-        inline double x() { return point.x; }
-        inline double y() { return point.y; }
+        inline T x() { return point.x; }
+        inline T y() { return point.y; }
 
     };
 
     
-    class HalfEdge {
+    template<typename T>
+    class HalfEdgeT {
     public:
         
         int l_index, r_index;
         
-        VertexPtr vertex;
-        HalfEdgePtr twin;
-        HalfEdgePtr next;
-        HalfEdgePtr prev;
+        VertexPtrT<T> vertex;
+        HalfEdgePtrT<T> twin;
+        HalfEdgePtrT<T> next;
+        HalfEdgePtrT<T> prev;
         
-        HalfEdge(int _l_index, int _r_index, VertexPtr _vertex = nullptr);
+        HalfEdgeT(int _l_index, int _r_index, VertexPtrT<T> _vertex = nullptr);
         
-        inline VertexPtr vertex0() { return vertex; }
-        inline VertexPtr vertex1() { return twin->vertex; }
+        inline VertexPtrT<T> vertex0() { return vertex; }
+        inline VertexPtrT<T> vertex1() { return twin->vertex; }
         inline bool is_finite() {
             return vertex != nullptr && twin->vertex != nullptr;
         }
         
         // Iterators around vertex
-        HalfEdgePtr vertexNextCCW();
-        HalfEdgePtr vertexNextCW();
+        HalfEdgePtrT<T> vertexNextCCW();
+        HalfEdgePtrT<T> vertexNextCW();
     };
+    
+    
+    typedef VertexT<double> Vertex;
+    typedef HalfEdgeT<double> HalfEdge;
+    typedef HalfEdgePtrT<double> HalfEdgePtr;
+    typedef VertexPtrT<double> VertexPtr;
 
     
-    std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(int left_index, int right_index);
+    template<typename T>
+    std::pair<HalfEdgePtrT<T>, HalfEdgePtrT<T>> make_twins(int left_index, int right_index);
+    
+    
+    inline std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(int left_index, int right_index) {
+        return make_twins<double>(left_index, right_index);
+    }
+    
+    
+    inline std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(const std::pair<int,int> &indices) {
+        return make_twins<double>(indices.first, indices.second);
+    }
+    
+    
+    template<typename T>
+    void connect_halfedges(HalfEdgePtrT<T> p1, HalfEdgePtrT<T> p2);
+    
+    
+    // Index of a missing halfedge or vertex (plays the role of nullptr)
+    const uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+    
+    
+    /**
+     Doubly-connected edge list stored as a structure of arrays.
+     Vertices and halfedges are addressed by 32-bit indices, and all the
+     records are released at once together with the arrays.
+     
+     Unlike `HalfEdge::vertex`, `origin[h]` is the vertex the halfedge
+     starts from, so the halfedge points towards `origin[twin[h]]`.
+     Unbounded halfedges have NO_INDEX instead of a vertex.
+     */
+    template<typename T>
+    class FlatDiagramT {
+    public:
+        
+        // Coordinates of vertices
+        std::vector<T> vx, vy;
+        
+        // Halfedge attributes
+        std::vector<uint32_t> twin, next, prev, origin;
+        std::vector<uint32_t> l_site, r_site;
+        
+        // A halfedge on the boundary of a cell of each site
+        std::vector<uint32_t> faces;
+        
+        inline size_t vertices_num() const { return vx.size(); }
+        inline size_t halfedges_num() const { return twin.size(); }
+        
+        // Vertex the halfedge points towards
+        inline uint32_t target(uint32_t h) const { return origin[twin[h]]; }
+        
+        inline bool is_finite(uint32_t h) const {
+            return origin[h] != NO_INDEX && origin[twin[h]] != NO_INDEX;
+        }
+        
+        // Iterators around vertex
+        inline uint32_t vertexNextCCW(uint32_t h) const { return prev[twin[h]]; }
+        inline uint32_t vertexNextCW(uint32_t h) const { return twin[next[h]]; }
+        
+        uint32_t add_vertex(const Point2DT<T> &point);
+        
+        // Returns a pair of twin halfedges, the first one has `left_index` as its left site
+        std::pair<uint32_t, uint32_t> make_twins(int left_index, int right_index);
+        
+        void connect_halfedges(uint32_t h1, uint32_t h2);
+        
+        void reserve(size_t vertices_n, size_t halfedges_n);
+        
+        void clear();
+        
+    };
     
     
-    std::pair<HalfEdgePtr, HalfEdgePtr> make_twins(const std::pair<int,int> &indices);
+    typedef FlatDiagramT<double> FlatDiagram;
     
     
-    void connect_halfedges(HalfEdgePtr p1, HalfEdgePtr p2);
+    /**
+     Convert a flat diagram into pointer-based records. Halfedges and vertices
+     keep their indices, `HalfEdge::vertex` is the target vertex and
+     `Vertex::edge` points into the vertex, as `build_voronoi` produces them.
+     */
+    template<typename T>
+    void make_pointer_dcel(const FlatDiagramT<T> &diagram,
+                           std::vector<HalfEdgePtrT<T>> &halfedges,
+                           std::vector<VertexPtrT<T>> &vertices,
+                           std::vector<HalfEdgePtrT<T>> &faces);
     
 }
 
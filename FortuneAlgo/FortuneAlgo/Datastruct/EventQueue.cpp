@@ -0,0 +1,130 @@
+//
+//  EventQueue.cpp
+//  FortuneAlgo
+//
+
+#include "EventQueue.hpp"
+
+#include <cassert>
+
+
+namespace beachline {
+
+
+    template<typename T>
+    uint32_t CircleEventQueueT<T>::push(const CircleEvent &event) {
+        uint32_t slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            events[slot] = event;
+        } else {
+            assert(events.size() < NO_EVENT);
+            slot = static_cast<uint32_t>(events.size());
+            events.push_back(event);
+            position.push_back(0);
+        }
+        Entry entry = {event.point.y, event.point.x, slot};
+        heap.push_back(entry);
+        position[slot] = static_cast<uint32_t>(heap.size() - 1);
+        sift_up(heap.size() - 1);
+        return slot;
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::remove(uint32_t handle) {
+        assert(handle < position.size() && heap[position[handle]].slot == handle);
+        erase_at(position[handle]);
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::pop() {
+        erase_at(0);
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::reserve(size_t n) {
+        heap.reserve(n);
+        events.reserve(n);
+        position.reserve(n);
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::clear() {
+        heap.clear();
+        events.clear();
+        position.clear();
+        free_slots.clear();
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::erase_at(size_t i) {
+        free_slots.push_back(heap[i].slot);
+        size_t last = heap.size() - 1;
+        if (i != last) {
+            heap[i] = heap[last];
+            position[heap[i].slot] = static_cast<uint32_t>(i);
+            heap.pop_back();
+            // the moved entry may need to go either way
+            if (i > 0 && less(heap[i], heap[(i - 1) / 2])) {
+                sift_up(i);
+            } else {
+                sift_down(i);
+            }
+        } else {
+            heap.pop_back();
+        }
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::sift_up(size_t i) {
+        Entry entry = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!less(entry, heap[parent])) {
+                break;
+            }
+            heap[i] = heap[parent];
+            position[heap[i].slot] = static_cast<uint32_t>(i);
+            i = parent;
+        }
+        heap[i] = entry;
+        position[entry.slot] = static_cast<uint32_t>(i);
+    }
+
+
+    template<typename T>
+    void CircleEventQueueT<T>::sift_down(size_t i) {
+        Entry entry = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= n) {
+                break;
+            }
+            if (child + 1 < n && less(heap[child + 1], heap[child])) {
+                ++child;
+            }
+            if (!less(heap[child], entry)) {
+                break;
+            }
+            heap[i] = heap[child];
+            position[heap[i].slot] = static_cast<uint32_t>(i);
+            i = child;
+        }
+        heap[i] = entry;
+        position[entry.slot] = static_cast<uint32_t>(i);
+    }
+
+
+
+    template class CircleEventQueueT<float>;
+    template class CircleEventQueueT<double>;
+
+}
@@ -0,0 +1,109 @@
+//
+//  EventQueue.hpp
+//  FortuneAlgo
+//
+
+#ifndef EventQueue_hpp
+#define EventQueue_hpp
+
+#include "Point2D.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace beachline {
+
+    // Handle of a missing circle event
+    const uint32_t NO_EVENT = std::numeric_limits<uint32_t>::max();
+
+
+    template<typename T>
+    struct CircleEventT {
+
+        // Lowest point of the circle, position of the event
+        Point2DT<T> point;
+
+        // Center of the circle, a new vertex of Voronoi diagram
+        Point2DT<T> center;
+
+        // Index of the disappearing arc-node
+        uint32_t arc;
+
+    };
+
+
+    /**
+     Binary min-heap of circle events ordered by (y, x) of their points.
+     Events are stored by value in slots; a slot id is a handle that stays
+     valid until the event is popped or removed, so a pending event can be
+     removed in O(log n) instead of being left in the heap as a tombstone.
+     */
+    template<typename T>
+    class CircleEventQueueT {
+    public:
+
+        typedef CircleEventT<T> CircleEvent;
+
+        // Add an event, returns its handle
+        uint32_t push(const CircleEvent &event);
+
+        // Remove a pending event by its handle
+        void remove(uint32_t handle);
+
+        // Event with the smallest (y, x)
+        inline const CircleEvent &top() const {
+            return events[heap[0].slot];
+        }
+
+        // Handle of the top event
+        inline uint32_t top_handle() const {
+            return heap[0].slot;
+        }
+
+        void pop();
+
+        inline bool empty() const {
+            return heap.empty();
+        }
+
+        inline size_t size() const {
+            return heap.size();
+        }
+
+        void reserve(size_t n);
+
+        void clear();
+
+    private:
+
+        // Heap entries keep the key next to the slot id, so sifting
+        // does not touch the event records
+        struct Entry {
+            T y, x;
+            uint32_t slot;
+        };
+
+        static inline bool less(const Entry &e1, const Entry &e2) {
+            return e1.y < e2.y || (e1.y == e2.y && e1.x < e2.x);
+        }
+
+        std::vector<Entry> heap;
+        std::vector<CircleEvent> events;  // indexed by slot
+        std::vector<uint32_t> position;   // position of a slot in the heap
+        std::vector<uint32_t> free_slots;
+
+        void sift_up(size_t i);
+        void sift_down(size_t i);
+        void erase_at(size_t i);
+
+    };
+
+
+    typedef CircleEventT<double> CircleEvent;
+    typedef CircleEventQueueT<double> CircleEventQueue;
+
+}
+
+#endif /* EventQueue_hpp */
@@ -0,0 +1,688 @@
+//
+//  WideBeachline.cpp
+//  FortuneAlgo
+//
+
+#include "WideBeachline.hpp"
+
+#include <cmath>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace beachline {
+
+    /**
+     Number of breakpoints among the first `n` of a node which are to the left of `x`
+     at the sweepline `d`. Breakpoint k is the one of the sites (lx[k], ly[k]) and
+     (rx[k], ry[k]), all the WIDTH entries are evaluated and the extra ones are masked out.
+     The formula is the one of findBreakpoint, both branches are computed and blended.
+     */
+    template<typename T, int WIDTH>
+    static inline int countLess(const T *lx, const T *ly, const T *rx, const T *ry, int n, T d, T x) {
+        int count = 0;
+        for (int k = 0; k < WIDTH; ++k) {
+            T u1 = ly[k] - d, u2 = ry[k] - d;
+            T e = lx[k] - rx[k], dy = ly[k] - ry[k];
+            T B = u1 * e;
+            T s = std::sqrt(u1 * u2 * (e * e + dy * dy));
+            T t_pos = u1 * (u2 * dy - e * e) / (B + s);
+            T t_neg = (B - s) / -dy;
+            T bp = lx[k] + (B > 0 ? t_pos : t_neg);
+            bp = dy == 0 ? T(0.5) * (lx[k] + rx[k]) : bp;
+            count += (k < n) & (bp < x);
+        }
+        return count;
+    }
+
+
+#ifdef __AVX2__
+
+    template<>
+    inline int countLess<double, 8>(const double *lx, const double *ly, const double *rx, const double *ry,
+                                    int n, double d, double x) {
+        const __m256d vd = _mm256_set1_pd(d), vx = _mm256_set1_pd(x);
+        const __m256d zero = _mm256_setzero_pd(), half = _mm256_set1_pd(0.5);
+        int mask = 0;
+        for (int k = 0; k < 8; k += 4) {
+            __m256d ax = _mm256_loadu_pd(lx + k), ay = _mm256_loadu_pd(ly + k);
+            __m256d bx = _mm256_loadu_pd(rx + k), by = _mm256_loadu_pd(ry + k);
+            __m256d u1 = _mm256_sub_pd(ay, vd), u2 = _mm256_sub_pd(by, vd);
+            __m256d e = _mm256_sub_pd(ax, bx), dy = _mm256_sub_pd(ay, by);
+            __m256d e2 = _mm256_mul_pd(e, e);
+            __m256d B = _mm256_mul_pd(u1, e);
+            __m256d s = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_mul_pd(u1, u2), _mm256_add_pd(e2, _mm256_mul_pd(dy, dy))));
+            __m256d t_pos = _mm256_div_pd(_mm256_mul_pd(u1, _mm256_sub_pd(_mm256_mul_pd(u2, dy), e2)), _mm256_add_pd(B, s));
+            __m256d t_neg = _mm256_div_pd(_mm256_sub_pd(B, s), _mm256_sub_pd(zero, dy));
+            __m256d t = _mm256_blendv_pd(t_neg, t_pos, _mm256_cmp_pd(B, zero, _CMP_GT_OQ));
+            __m256d bp = _mm256_add_pd(ax, t);
+            __m256d mid = _mm256_mul_pd(half, _mm256_add_pd(ax, bx));
+            bp = _mm256_blendv_pd(bp, mid, _mm256_cmp_pd(dy, zero, _CMP_EQ_OQ));
+            mask |= _mm256_movemask_pd(_mm256_cmp_pd(bp, vx, _CMP_LT_OQ)) << k;
+        }
+        return __builtin_popcount(mask & ((1 << n) - 1));
+    }
+
+
+    template<>
+    inline int countLess<float, 8>(const float *lx, const float *ly, const float *rx, const float *ry,
+                                   int n, float d, float x) {
+        const __m256 vd = _mm256_set1_ps(d), vx = _mm256_set1_ps(x);
+        const __m256 zero = _mm256_setzero_ps(), half = _mm256_set1_ps(0.5f);
+        __m256 ax = _mm256_loadu_ps(lx), ay = _mm256_loadu_ps(ly);
+        __m256 bx = _mm256_loadu_ps(rx), by = _mm256_loadu_ps(ry);
+        __m256 u1 = _mm256_sub_ps(ay, vd), u2 = _mm256_sub_ps(by, vd);
+        __m256 e = _mm256_sub_ps(ax, bx), dy = _mm256_sub_ps(ay, by);
+        __m256 e2 = _mm256_mul_ps(e, e);
+        __m256 B = _mm256_mul_ps(u1, e);
+        __m256 s = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_mul_ps(u1, u2), _mm256_add_ps(e2, _mm256_mul_ps(dy, dy))));
+        __m256 t_pos = _mm256_div_ps(_mm256_mul_ps(u1, _mm256_sub_ps(_mm256_mul_ps(u2, dy), e2)), _mm256_add_ps(B, s));
+        __m256 t_neg = _mm256_div_ps(_mm256_sub_ps(B, s), _mm256_sub_ps(zero, dy));
+        __m256 t = _mm256_blendv_ps(t_neg, t_pos, _mm256_cmp_ps(B, zero, _CMP_GT_OQ));
+        __m256 bp = _mm256_add_ps(ax, t);
+        __m256 mid = _mm256_mul_ps(half, _mm256_add_ps(ax, bx));
+        bp = _mm256_blendv_ps(bp, mid, _mm256_cmp_ps(dy, zero, _CMP_EQ_OQ));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(bp, vx, _CMP_LT_OQ));
+        return __builtin_popcount(mask & ((1 << n) - 1));
+    }
+
+#endif
+
+
+    template<typename T>
+    WideBeachlineT<T>::WideBeachlineT() :
+    points(nullptr), sweepline(0), root(NO_NODE), height(0), evaluations(0), node_changes(0),
+    finger_search(false), finger(NO_NODE) {}
+
+
+    template<typename T>
+    void WideBeachlineT<T>::reset(const Point2DT<T> *points) {
+        this->points = points;
+        sweepline = 0;
+        root = NO_NODE;
+        height = 0;
+        arcs.clear();
+        leaves.clear();
+        inners.clear();
+        free_arcs.clear();
+        free_leaves.clear();
+        free_inners.clear();
+        evaluations = 0;
+        node_changes = 0;
+        finger = NO_NODE;
+    }
+
+
+    template<typename T>
+    BLNodePtr WideBeachlineT<T>::new_arc(int site) {
+        BLNodePtr arc;
+        if (!free_arcs.empty()) {
+            arc = free_arcs.back();
+            free_arcs.pop_back();
+        } else {
+            arc = static_cast<BLNodePtr>(arcs.size());
+            arcs.push_back(Arc());
+        }
+        Arc &a = arcs[arc];
+        a.site = site;
+        a.prev = a.next = NO_NODE;
+        a.leaf = NO_NODE;
+        a.slot = 0;
+        a.circle_event = NO_EVENT;
+        a.edge = NO_INDEX;
+        return arc;
+    }
+
+
+    template<typename T>
+    uint32_t WideBeachlineT<T>::new_leaf() {
+        uint32_t leaf;
+        if (!free_leaves.empty()) {
+            leaf = free_leaves.back();
+            free_leaves.pop_back();
+            leaves[leaf] = Leaf();
+        } else {
+            leaf = static_cast<uint32_t>(leaves.size());
+            leaves.push_back(Leaf());
+        }
+        leaves[leaf].parent = NO_NODE;
+        return leaf;
+    }
+
+
+    template<typename T>
+    uint32_t WideBeachlineT<T>::new_inner() {
+        uint32_t node;
+        if (!free_inners.empty()) {
+            node = free_inners.back();
+            free_inners.pop_back();
+            inners[node] = Inner();
+        } else {
+            node = static_cast<uint32_t>(inners.size());
+            inners.push_back(Inner());
+        }
+        inners[node].parent = NO_NODE;
+        return node;
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::place(uint32_t leaf, int slot, BLNodePtr arc) {
+        Leaf &l = leaves[leaf];
+        const Point2DT<T> &p = points[arcs[arc].site];
+        l.arc[slot] = arc;
+        l.x[slot] = p.x;
+        l.y[slot] = p.y;
+        arcs[arc].leaf = leaf;
+        arcs[arc].slot = slot;
+    }
+
+
+    template<typename T>
+    typename WideBeachlineT<T>::Separator WideBeachlineT<T>::separator(BLNodePtr left, BLNodePtr right) {
+        const Point2DT<T> &p1 = points[arcs[left].site], &p2 = points[arcs[right].site];
+        Separator s = {p1.x, p1.y, p2.x, p2.y};
+        return s;
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::set_separator(Inner &node, int k, const Separator &s) {
+        node.lx[k] = s.lx;
+        node.ly[k] = s.ly;
+        node.rx[k] = s.rx;
+        node.ry[k] = s.ry;
+    }
+
+
+    template<typename T>
+    T WideBeachlineT<T>::breakpoint(BLNodePtr left, BLNodePtr right) {
+        ++evaluations;
+        return findBreakpoint(points[arcs[left].site], points[arcs[right].site], sweepline);
+    }
+
+
+    template<typename T>
+    T WideBeachlineT<T>::breakpoint(const Inner &node, int k) {
+        ++evaluations;
+        return findBreakpoint(Point2DT<T>(node.lx[k], node.ly[k]), Point2DT<T>(node.rx[k], node.ry[k]), sweepline);
+    }
+
+
+    template<typename T>
+    uint32_t &WideBeachlineT<T>::parent(uint32_t node, bool is_leaf) {
+        return is_leaf ? leaves[node].parent : inners[node].parent;
+    }
+
+
+    template<typename T>
+    int WideBeachlineT<T>::child_index(uint32_t parent, uint32_t node) {
+        const Inner &p = inners[parent];
+        int k = 0;
+        while (p.child[k] != node) {
+            ++k;
+        }
+        return k;
+    }
+
+
+    template<typename T>
+    BLNodePtr WideBeachlineT<T>::init(int site) {
+        BLNodePtr arc = new_arc(site);
+        root = new_leaf();
+        height = 0;
+        place(root, 0, arc);
+        leaves[root].size = 1;
+        finger = arc;
+        return arc;
+    }
+
+
+    template<typename T>
+    BLNodePtr WideBeachlineT<T>::find(T x) {
+        if (root == NO_NODE) {
+            return NO_NODE;
+        }
+        if (!finger_search || finger == NO_NODE) {
+            return descend(root, height, x);
+        }
+
+        // boundaries of the leaf of the finger
+        uint32_t node = arcs[finger].leaf;
+        const Leaf &l = leaves[node];
+        BLNodePtr first = l.arc[0], last = l.arc[l.size - 1];
+        bool go_left = arcs[first].prev != NO_NODE && !(breakpoint(arcs[first].prev, first) < x);
+        bool go_right = !go_left && arcs[last].next != NO_NODE && breakpoint(last, arcs[last].next) < x;
+        if (!go_left && !go_right) {
+            return descend(node, 0, x);
+        }
+
+        // climb to the lowest ancestor with a separator beyond `x` on the side of the finger
+        int level = 0;
+        for (uint32_t p = l.parent; p != NO_NODE; p = inners[p].parent) {
+            const Inner &n = inners[p];
+            int k = child_index(p, node);
+            ++level;
+            if (go_right && k + 1 < n.size && !(breakpoint(n, n.size - 2) < x)) {
+                return descend(p, level, x);
+            }
+            if (go_left && k > 0 && breakpoint(n, 0) < x) {
+                return descend(p, level, x);
+            }
+            node = p;
+        }
+        return descend(root, height, x);
+    }
+
+
+    template<typename T>
+    BLNodePtr WideBeachlineT<T>::descend(uint32_t node, int level, T x) {
+        for (; level > 0; --level) {
+            const Inner &n = inners[node];
+            evaluations += n.size - 1;
+            node = n.child[countLess<T, WIDTH>(n.lx, n.ly, n.rx, n.ry, n.size - 1, sweepline, x)];
+        }
+        // breakpoints of a leaf are between its neighbouring arcs
+        const Leaf &l = leaves[node];
+        evaluations += l.size - 1;
+        return l.arc[countLess<T, WIDTH>(l.x, l.y, l.x + 1, l.y + 1, l.size - 1, sweepline, x)];
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::insert_arcs(uint32_t leaf, int pos, const BLNodePtr *items, int count) {
+        int size = leaves[leaf].size;
+        if (size + count <= WIDTH) {
+            for (int i = size - 1; i >= pos; --i) {
+                place(leaf, i + count, leaves[leaf].arc[i]);
+            }
+            for (int i = 0; i < count; ++i) {
+                place(leaf, pos + i, items[i]);
+            }
+            leaves[leaf].size = size + count;
+            return;
+        }
+
+#ifdef FORTUNE_SWEEP_PROFILE
+        node_changes++;
+#endif
+
+        // split the leaf in two halves
+        BLNodePtr all[WIDTH + 2];
+        int total = 0;
+        for (int i = 0; i < pos; ++i) {
+            all[total++] = leaves[leaf].arc[i];
+        }
+        for (int i = 0; i < count; ++i) {
+            all[total++] = items[i];
+        }
+        for (int i = pos; i < size; ++i) {
+            all[total++] = leaves[leaf].arc[i];
+        }
+
+        uint32_t right = new_leaf();
+        int half = total / 2;
+        for (int i = 0; i < half; ++i) {
+            place(leaf, i, all[i]);
+        }
+        for (int i = half; i < total; ++i) {
+            place(right, i - half, all[i]);
+        }
+        leaves[leaf].size = half;
+        leaves[right].size = total - half;
+
+        add_sibling(leaf, right, true, separator(all[half - 1], all[half]));
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::add_sibling(uint32_t node, uint32_t sibling, bool is_leaf, const Separator &s) {
+        uint32_t p = parent(node, is_leaf);
+
+        if (p == NO_NODE) { // grow a new root
+            uint32_t new_root = new_inner();
+            Inner &r = inners[new_root];
+            r.child[0] = node;
+            r.child[1] = sibling;
+            r.size = 2;
+            set_separator(r, 0, s);
+            parent(node, is_leaf) = new_root;
+            parent(sibling, is_leaf) = new_root;
+            root = new_root;
+            height++;
+            return;
+        }
+
+        int pos = child_index(p, node) + 1;
+        int size = inners[p].size;
+
+        if (size < WIDTH) {
+            Inner &n = inners[p];
+            for (int i = size; i > pos; --i) {
+                n.child[i] = n.child[i - 1];
+            }
+            for (int i = size - 1; i > pos - 1; --i) {
+                n.lx[i] = n.lx[i - 1];
+                n.ly[i] = n.ly[i - 1];
+                n.rx[i] = n.rx[i - 1];
+                n.ry[i] = n.ry[i - 1];
+            }
+            n.child[pos] = sibling;
+            set_separator(n, pos - 1, s);
+            n.size = size + 1;
+            parent(sibling, is_leaf) = p;
+            return;
+        }
+
+#ifdef FORTUNE_SWEEP_PROFILE
+        node_changes++;
+#endif
+
+        // split the parent, the middle separator goes one level up
+        uint32_t children[WIDTH + 1];
+        Separator separators[WIDTH];
+        {
+            const Inner &n = inners[p];
+            int c = 0, k = 0;
+            for (int i = 0; i < size; ++i) {
+                children[c++] = n.child[i];
+                if (i == pos - 1) {
+                    children[c++] = sibling;
+                }
+            }
+            for (int i = 0; i < size - 1; ++i) {
+                if (i == pos - 1) {
+                    separators[k++] = s;
+                }
+                Separator old = {n.lx[i], n.ly[i], n.rx[i], n.ry[i]};
+                separators[k++] = old;
+            }
+            if (pos - 1 == size - 1) {
+                separators[k++] = s;
+            }
+        }
+
+        uint32_t q = new_inner();
+        Inner &a = inners[p], &b = inners[q];
+        int half = (WIDTH + 2) / 2;
+        a.size = half;
+        b.size = WIDTH + 1 - half;
+        for (int i = 0; i < half; ++i) {
+            a.child[i] = children[i];
+            parent(children[i], is_leaf) = p;
+        }
+        for (int i = 0; i + 1 < half; ++i) {
+            set_separator(a, i, separators[i]);
+        }
+        for (int i = half; i < WIDTH + 1; ++i) {
+            b.child[i - half] = children[i];
+            parent(children[i], is_leaf) = q;
+        }
+        for (int i = half; i < WIDTH; ++i) {
+            set_separator(b, i - half, separators[i]);
+        }
+
+        add_sibling(p, q, false, separators[half - 1]);
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::remove_node(uint32_t node, bool is_leaf) {
+#ifdef FORTUNE_SWEEP_PROFILE
+        node_changes++;
+#endif
+
+        uint32_t p = parent(node, is_leaf);
+        if (is_leaf) {
+            free_leaves.push_back(node);
+        } else {
+            free_inners.push_back(node);
+        }
+
+        if (p == NO_NODE) { // the tree is empty
+            root = NO_NODE;
+            height = 0;
+            return;
+        }
+
+        Inner &n = inners[p];
+        int k = child_index(p, node);
+        for (int i = k; i + 1 < n.size; ++i) {
+            n.child[i] = n.child[i + 1];
+        }
+        // the separator on the side of the remaining neighbour goes away
+        for (int i = k > 0 ? k - 1 : 0; i + 2 < n.size; ++i) {
+            n.lx[i] = n.lx[i + 1];
+            n.ly[i] = n.ly[i + 1];
+            n.rx[i] = n.rx[i + 1];
+            n.ry[i] = n.ry[i + 1];
+        }
+        n.size--;
+
+        if (n.size == 0) {
+            remove_node(p, false);
+            return;
+        }
+        // the root with one child is not needed
+        while (height > 0 && inners[root].size == 1) {
+            free_inners.push_back(root);
+            root = inners[root].child[0];
+            parent(root, height == 1) = NO_NODE;
+            height--;
+        }
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::fix_separator_after(BLNodePtr arc) {
+        const Arc &a = arcs[arc];
+        if (a.next == NO_NODE || a.slot != leaves[a.leaf].size - 1) {
+            return;
+        }
+        // the breakpoint is stored in the lowest ancestor, where the leaf of the arc is not the last
+        uint32_t node = a.leaf, p = leaves[node].parent;
+        while (p != NO_NODE) {
+            int k = child_index(p, node);
+            if (k + 1 < inners[p].size) {
+                set_separator(inners[p], k, separator(arc, a.next));
+                return;
+            }
+            node = p;
+            p = inners[p].parent;
+        }
+    }
+
+
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> WideBeachlineT<T>::split(BLNodePtr arc, int site,
+                                                             const std::pair<uint32_t, uint32_t> &twin_edges) {
+        // the old arc stays on the left, new arcs are the middle and the right piece
+        BLNodePtr middle = new_arc(site);
+        BLNodePtr right = new_arc(arcs[arc].site);
+
+        Arc &a = arcs[arc], &m = arcs[middle], &r = arcs[right];
+        r.next = a.next;
+        r.prev = middle;
+        r.edge = a.edge;
+        m.prev = arc;
+        m.next = right;
+        m.edge = twin_edges.second;
+        a.next = middle;
+        a.edge = twin_edges.first;
+        if (r.next != NO_NODE) {
+            arcs[r.next].prev = right;
+        }
+
+        BLNodePtr items[2] = {middle, right};
+        insert_arcs(a.leaf, a.slot + 1, items, 2);
+        finger = middle;
+        return std::make_pair(arc, right);
+    }
+
+
+    template<typename T>
+    std::pair<BLNodePtr, BLNodePtr> WideBeachlineT<T>::insert_beside(BLNodePtr arc, int site,
+                                                                     const std::pair<uint32_t, uint32_t> &twin_edges) {
+        BLNodePtr arc_new = new_arc(site);
+        Arc &a = arcs[arc], &n = arcs[arc_new];
+
+        if (points[site].x < points[a.site].x) { // the new arc goes to the left
+            n.prev = a.prev;
+            n.next = arc;
+            n.edge = twin_edges.second;
+            if (a.prev != NO_NODE) {
+                arcs[a.prev].next = arc_new;
+            }
+            a.prev = arc_new;
+            insert_arcs(a.leaf, a.slot, &arc_new, 1);
+            finger = arc_new;
+            if (n.prev != NO_NODE) {
+                fix_separator_after(n.prev);
+            }
+            return std::make_pair(arc_new, arc);
+        }
+
+        n.prev = arc;
+        n.next = a.next;
+        n.edge = a.edge;
+        if (a.next != NO_NODE) {
+            arcs[a.next].prev = arc_new;
+        }
+        a.next = arc_new;
+        a.edge = twin_edges.first;
+        insert_arcs(a.leaf, a.slot + 1, &arc_new, 1);
+        finger = arc_new;
+        fix_separator_after(arc_new);
+        return std::make_pair(arc, arc_new);
+    }
+
+
+    template<typename T>
+    bool WideBeachlineT<T>::breakpoint_edges(BLNodePtr arc, uint32_t &left, uint32_t &right) {
+        const Arc &a = arcs[arc];
+        if (a.prev == NO_NODE || a.next == NO_NODE) {
+            return false;
+        }
+        left = arcs[a.prev].edge;
+        right = a.edge;
+        return true;
+    }
+
+
+    template<typename T>
+    void WideBeachlineT<T>::remove(BLNodePtr arc, uint32_t edge) {
+        Arc a = arcs[arc];
+        if (finger == arc) {
+            finger = a.prev;
+        }
+        if (a.prev != NO_NODE) {
+            arcs[a.prev].next = a.next;
+            arcs[a.prev].edge = edge;
+        }
+        if (a.next != NO_NODE) {
+            arcs[a.next].prev = a.prev;
+        }
+
+        int size = leaves[a.leaf].size;
+        for (int i = a.slot; i + 1 < size; ++i) {
+            place(a.leaf, i, leaves[a.leaf].arc[i + 1]);
+        }
+        leaves[a.leaf].size = size - 1;
+        if (size == 1) {
+            remove_node(a.leaf, true);
+        }
+        free_arcs.push_back(arc);
+
+        if (a.prev != NO_NODE) {
+            fix_separator_after(a.prev);
+        }
+    }
+
+
+    template<typename T>
+    size_t WideBeachlineT<T>::arcs_num() const {
+        return arcs.size() - free_arcs.size();
+    }
+
+
+    template<typename T>
+    size_t WideBeachlineT<T>::leaves_num() const {
+        return leaves.size() - free_leaves.size();
+    }
+
+
+    template<typename T>
+    size_t WideBeachlineT<T>::inner_num() const {
+        return inners.size() - free_inners.size();
+    }
+
+
+    template<typename T>
+    size_t WideBeachlineT<T>::memory() const {
+        return arcs.capacity() * sizeof(Arc) + leaves.capacity() * sizeof(Leaf) +
+               inners.capacity() * sizeof(Inner) +
+               (free_arcs.capacity() + free_leaves.capacity() + free_inners.capacity()) * sizeof(uint32_t);
+    }
+
+
+    template<typename T>
+    bool WideBeachlineT<T>::_validate() {
+        if (root == NO_NODE) {
+            return true;
+        }
+        // walk down to the first arc
+        uint32_t node = root;
+        for (int level = height; level > 0; --level) {
+            node = inners[node].child[0];
+        }
+        BLNodePtr arc = leaves[node].arc[0];
+        if (arcs[arc].prev != NO_NODE) {
+            return false;
+        }
+        T last = -std::numeric_limits<T>::infinity();
+        for (; arc != NO_NODE; arc = arcs[arc].next) {
+            const Arc &a = arcs[arc];
+            const Leaf &l = leaves[a.leaf];
+            if (l.arc[a.slot] != arc || a.slot >= l.size) {
+                return false;
+            }
+            if (a.next == NO_NODE) {
+                break;
+            }
+            if (arcs[a.next].prev != arc) {
+                return false;
+            }
+            T x = findBreakpoint(points[a.site], points[arcs[a.next].site], sweepline);
+            if (x < last - Tolerance<T>::point()) {
+                return false;
+            }
+            last = x;
+            // the search for a point just next to the breakpoint lands on the arcs around it
+            if (a.slot == l.size - 1) {
+                uint32_t child = a.leaf, p = l.parent;
+                while (p != NO_NODE && child_index(p, child) + 1 == inners[p].size) {
+                    child = p;
+                    p = inners[p].parent;
+                }
+                if (p == NO_NODE) {
+                    return false;
+                }
+                const Inner &n = inners[p];
+                int k = child_index(p, child);
+                Separator s = separator(arc, a.next);
+                if (n.lx[k] != s.lx || n.ly[k] != s.ly || n.rx[k] != s.rx || n.ry[k] != s.ry) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+
+    template class WideBeachlineT<float>;
+    template class WideBeachlineT<double>;
+
+}
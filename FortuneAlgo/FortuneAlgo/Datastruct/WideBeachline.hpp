@@ -0,0 +1,215 @@
+//
+//  WideBeachline.hpp
+//  FortuneAlgo
+//
+
+#ifndef WideBeachline_hpp
+#define WideBeachline_hpp
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Point2D.h"
+#include "Beachline.hpp"
+
+
+namespace beachline {
+
+    /**
+     Beachline as a B+-tree of arcs with WIDTH children per node.
+
+     Leaves hold up to WIDTH consecutive arcs with the coordinates of their sites,
+     inner nodes hold the breakpoints between their children as pairs of sites.
+     Coordinates are stored by component (structure of arrays), so a search
+     evaluates all the breakpoints of a node at once and goes to the child
+     given by the number of breakpoints to the left of x. With AVX2 enabled
+     this is one vector kernel per node, otherwise a fixed-length loop without branches.
+
+     Arcs are addressed by handles that stay valid until the arc is removed.
+     The interface is the one of AVLBeachlineT.
+     */
+    template<typename T>
+    class WideBeachlineT {
+    public:
+
+        // Maximum number of children of an inner node and of arcs in a leaf
+        static const int WIDTH = 8;
+
+        WideBeachlineT();
+
+        // Remove all the arcs, the memory is kept for the next beachline
+        void reset(const Point2DT<T> *points);
+
+        // See AVLBeachlineT
+        inline void set_points(const Point2DT<T> *points) {
+            this->points = points;
+        }
+
+        inline void set_sweepline(T y) {
+            sweepline = y;
+        }
+
+        inline bool empty() const {
+            return root == NO_NODE;
+        }
+
+        // Make the first arc
+        BLNodePtr init(int site);
+
+        // Arc above `x`, see AVLBeachlineT::find
+        BLNodePtr find(T x);
+
+        // Start searches from the leaf of the last inserted arc
+        inline void set_finger_search(bool enabled) {
+            finger_search = enabled;
+        }
+
+        inline int site(BLNodePtr arc) {
+            return arcs[arc].site;
+        }
+
+        inline BLNodePtr prev(BLNodePtr arc) {
+            return arcs[arc].prev;
+        }
+
+        inline BLNodePtr next(BLNodePtr arc) {
+            return arcs[arc].next;
+        }
+
+        inline uint32_t &circle_event(BLNodePtr arc) {
+            return arcs[arc].circle_event;
+        }
+
+        // See AVLBeachlineT
+        std::pair<BLNodePtr, BLNodePtr> split(BLNodePtr arc, int site, const std::pair<uint32_t, uint32_t> &twin_edges);
+
+        std::pair<BLNodePtr, BLNodePtr> insert_beside(BLNodePtr arc, int site, const std::pair<uint32_t, uint32_t> &twin_edges);
+
+        bool breakpoint_edges(BLNodePtr arc, uint32_t &left, uint32_t &right);
+
+        void remove(BLNodePtr arc, uint32_t edge);
+
+        // Nothing is cached, every breakpoint on the search path is evaluated
+        inline size_t value_hits() const {
+            return 0;
+        }
+
+        inline size_t value_misses() const {
+            return evaluations;
+        }
+
+        // Splits and removals of nodes, counted with FORTUNE_SWEEP_PROFILE only
+        inline size_t rebalances() const {
+            return node_changes;
+        }
+
+        // Levels of nodes from the root to the leaves
+        inline int tree_height() const {
+            return root == NO_NODE ? 0 : height + 1;
+        }
+
+        // Number of arcs, leaves and inner nodes in use
+        size_t arcs_num() const;
+        size_t leaves_num() const;
+        size_t inner_num() const;
+
+        // Bytes held by the nodes
+        size_t memory() const;
+
+        // Check the links, separators and the order of breakpoints at the sweepline
+        bool _validate();
+
+    private:
+
+        struct Arc {
+            int site;
+            BLNodePtr prev, next;
+            // position in the leaves
+            uint32_t leaf;
+            int slot;
+            uint32_t circle_event;
+            // halfedge of the breakpoint with the next arc
+            uint32_t edge;
+        };
+
+        struct Leaf {
+            // sites of the arcs, the extra element keeps loads of the right sites in bounds
+            T x[WIDTH + 1], y[WIDTH + 1];
+            BLNodePtr arc[WIDTH];
+            uint32_t parent;
+            int size;
+        };
+
+        struct Inner {
+            // sites (lx, ly) and (rx, ry) of the breakpoint between children k and k + 1
+            T lx[WIDTH], ly[WIDTH], rx[WIDTH], ry[WIDTH];
+            uint32_t child[WIDTH];
+            uint32_t parent;
+            int size;
+        };
+
+        // Sites of a breakpoint
+        struct Separator {
+            T lx, ly, rx, ry;
+        };
+
+        const Point2DT<T> *points;
+        T sweepline;
+
+        // Root node and the number of inner levels above the leaves
+        uint32_t root;
+        int height;
+
+        std::vector<Arc> arcs;
+        std::vector<Leaf> leaves;
+        std::vector<Inner> inners;
+        std::vector<uint32_t> free_arcs, free_leaves, free_inners;
+
+        size_t evaluations, node_changes;
+
+        // Last inserted arc
+        bool finger_search;
+        BLNodePtr finger;
+
+        BLNodePtr new_arc(int site);
+        uint32_t new_leaf();
+        uint32_t new_inner();
+
+        // Put the arc into a slot of the leaf
+        void place(uint32_t leaf, int slot, BLNodePtr arc);
+
+        Separator separator(BLNodePtr left, BLNodePtr right);
+        void set_separator(Inner &node, int k, const Separator &s);
+
+        // Breakpoint of two neighbouring arcs and of separator k of the node
+        T breakpoint(BLNodePtr left, BLNodePtr right);
+        T breakpoint(const Inner &node, int k);
+
+        // Search the subtree of `node`, which has `level` inner levels
+        BLNodePtr descend(uint32_t node, int level, T x);
+
+        uint32_t &parent(uint32_t node, bool is_leaf);
+        int child_index(uint32_t parent, uint32_t node);
+
+        // Insert `count` arcs at the position `pos` of the leaf, splitting it if needed
+        void insert_arcs(uint32_t leaf, int pos, const BLNodePtr *items, int count);
+
+        // Put `sibling` right after `node` separated by `s`, splitting the parents if needed
+        void add_sibling(uint32_t node, uint32_t sibling, bool is_leaf, const Separator &s);
+
+        // Remove an empty node from its parent, removing the parent if it becomes empty
+        void remove_node(uint32_t node, bool is_leaf);
+
+        // Update the separator between `arc` and the next arc
+        void fix_separator_after(BLNodePtr arc);
+
+    };
+
+
+    typedef WideBeachlineT<double> WideBeachline;
+
+}
+
+
+#endif /* WideBeachline_hpp */
@@ -7,34 +7,44 @@
 //
 
 #include "Circle.hpp"
+#include "Predicates.hpp"
 #include <iostream>
 
 
-bool findCircleCenter(const Point2D &p1, const Point2D &p2, const Point2D &p3, Point2D &center) {
+template<typename T>
+bool findCircleCenter(const Point2DT<T> &p1, const Point2DT<T> &p2, const Point2DT<T> &p3, Point2DT<T> &center) {
     
-    // get normalized vectors
-    Point2D u1 = (p1 - p2).normalized(), u2 = (p3 - p2).normalized();
+    double orientation = orient2d(p1, p2, p3);
     
-    double cross = crossProduct(u1, u2);
-    
-    // check if vectors are collinear
-    if (fabs(cross) < CIRCLE_CENTER_EPSILON) {
+    // check if points are collinear
+    if (orientation == 0.0) {
         return false;
     }
     
-    // get cental points
-    Point2D pc1 = 0.5 * (p1 + p2), pc2 = 0.5 * (p2 + p3);
-    
-    // get free components
-    double b1 = dotProduct(u1, pc1), b2 = dotProduct(u2, pc2);
+    center = circleCenter(p1, p2, p3, orientation);
+    return true;
+}
+
+
+template<typename T>
+Point2DT<T> circleCenter(const Point2DT<T> &p1, const Point2DT<T> &p2, const Point2DT<T> &p3, double orientation) {
     
-    // calculate the center of a circle
-    center.x = (b1 * u2.y - b2 * u1.y) / cross;
-    center.y = (u1.x * b2 - u2.x * b1) / cross;
+    // vectors from p3, their cross product is the orientation
+    double ux = double(p1.x) - p3.x, uy = double(p1.y) - p3.y;
+    double vx = double(p2.x) - p3.x, vy = double(p2.y) - p3.y;
+    double u2 = ux * ux + uy * uy, v2 = vx * vx + vy * vy;
     
-    return true;
+    // the center solves 2 (c - p3) . u = |u|^2 and 2 (c - p3) . v = |v|^2
+    double d = 2.0 * orientation;
+    return Point2DT<T>(T(p3.x + (vy * u2 - uy * v2) / d), T(p3.y + (ux * v2 - vx * u2) / d));
 }
 
+
+template bool findCircleCenter(const Point2DT<float> &, const Point2DT<float> &, const Point2DT<float> &, Point2DT<float> &);
+template bool findCircleCenter(const Point2DT<double> &, const Point2DT<double> &, const Point2DT<double> &, Point2DT<double> &);
+template Point2DT<float> circleCenter(const Point2DT<float> &, const Point2DT<float> &, const Point2DT<float> &, double);
+template Point2DT<double> circleCenter(const Point2DT<double> &, const Point2DT<double> &, const Point2DT<double> &, double);
+
 /*
 int main(int argc, char *argv[]) {
     
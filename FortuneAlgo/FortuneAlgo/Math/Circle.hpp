@@ -12,7 +12,6 @@
 
 #include "Point2D.h"
 
-#define CIRCLE_CENTER_EPSILON 1.0e-7
 
 /**
  
@@ -21,7 +20,18 @@
  Otherwise returns true and updates x- and y-coordinates of the `center` of circle.
  
  */
-bool findCircleCenter(const Point2D &p1, const Point2D &p2, const Point2D &p3, Point2D &center);
+template<typename T>
+bool findCircleCenter(const Point2DT<T> &p1, const Point2DT<T> &p2, const Point2DT<T> &p3, Point2DT<T> &center);
+
+
+/**
+ 
+ Center of the circle through three points that are not collinear,
+ `orientation` is orient2d(p1, p2, p3) and must not be zero.
+ 
+ */
+template<typename T>
+Point2DT<T> circleCenter(const Point2DT<T> &p1, const Point2DT<T> &p2, const Point2DT<T> &p3, double orientation);
 
 
 #endif /* Circle_hpp */
@@ -0,0 +1,44 @@
+//
+//  ConvexHull.cpp
+//  FortuneAlgo
+//
+
+#include "ConvexHull.hpp"
+
+
+/**
+ 
+ Andrew's monotone chain: lower hull from left to right, then upper hull back.
+ 
+ */
+std::vector<int> findConvexHull(const std::vector<Point2D> &points, const std::vector<int> &order, double tolerance) {
+    // keep the middle point if the chain turns left, or goes on almost straight
+    auto keep = [&](int i1, int i2, int i3) {
+        Point2D u = points[i2] - points[i1], v = points[i3] - points[i2];
+        double cross = crossProduct(u, v);
+        return cross > 0.0 || (tolerance > 0.0 && dotProduct(u, v) > 0.0 && cross >= -tolerance * u.norm() * v.norm());
+    };
+    
+    std::vector<int> hull;
+    if (order.size() < 3) {
+        hull = order;
+        return hull;
+    }
+    hull.reserve(2 * order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        while (hull.size() >= 2 && !keep(hull[hull.size() - 2], hull.back(), order[i])) {
+            hull.pop_back();
+        }
+        hull.push_back(order[i]);
+    }
+    size_t lower_size = hull.size();
+    for (size_t i = order.size() - 1; i-- > 0;) {
+        while (hull.size() > lower_size && !keep(hull[hull.size() - 2], hull.back(), order[i])) {
+            hull.pop_back();
+        }
+        hull.push_back(order[i]);
+    }
+    // the first point closes the upper hull
+    hull.pop_back();
+    return hull;
+}
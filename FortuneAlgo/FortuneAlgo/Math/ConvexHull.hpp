@@ -0,0 +1,28 @@
+//
+//  ConvexHull.hpp
+//  FortuneAlgo
+//
+
+#ifndef ConvexHull_hpp
+#define ConvexHull_hpp
+
+#include "Point2D.h"
+
+#include <vector>
+
+
+/**
+ 
+ Find vertices of the convex hull of `points` in counterclockwise order.
+ `order` lists indices of the points sorted by x-coordinate (ties broken by y).
+ Points sorted by y (ties broken by x) work the same way, as the mirror image
+ of sorting by x, and give the vertices in clockwise order. Points lying on hull edges are not included. With a positive `tolerance` the points
+ where the boundary turns right by less than `tolerance` (sine of the angle) are kept,
+ so every point on the boundary is included even if rounding bends it a little inward.
+ 
+ */
+std::vector<int> findConvexHull(const std::vector<Point2D> &points, const std::vector<int> &order,
+                                double tolerance = 0.0);
+
+
+#endif /* ConvexHull_hpp */
@@ -10,14 +10,16 @@
 
 /**
  
- Calculate number of intersection points between two parabolas with foci `f1` and `f2` and with given `directrix`
+ Calculate number of intersection points between two parabolas with foci `f1` and `f2` and with
+ the directrix below them, -1 if the foci are the same point
  
  */
-int intersectionPointsNum(const Point2D &f1, const Point2D &f2, double directrix) {
-    if (fabs(f1.x - f2.x) < POINT_EPSILON && fabs(f1.y - f2.y) < POINT_EPSILON) {
+template<typename T>
+int intersectionPointsNum(const Point2DT<T> &f1, const Point2DT<T> &f2) {
+    if (f1.x == f2.x && f1.y == f2.y) {
         return -1;
     }
-    if (fabs(f1.y - f2.y) < POINT_EPSILON)
+    if (f1.y == f2.y)
         return 1;
     return 2;
 }
@@ -29,36 +31,75 @@ int intersectionPointsNum(const Point2D &f1, const Point2D &f2, double directrix
  Returns  intersection points ordered by x-coordinate
  
  */
-std::vector<Point2D> findIntersectionPoints(const Point2D &f1, const Point2D &f2, double d) {
-    std::vector<Point2D> result;
-    if (fabs(f1.x - f2.x) < POINT_EPSILON) {
-        double y = 0.5 * (f1.y + f2.y), D = sqrt(d * d - d * (f1.y + f2.y) + f1.y * f2.y);
-        result.push_back(Point2D(f1.x - D, y));
-        result.push_back(Point2D(f1.x + D, y));
-    } else if (fabs(f1.y - f2.y) < POINT_EPSILON) { 
-        double x = 0.5 * (f1.x + f2.x);
-        result.push_back(Point2D(x, 0.5 * ((x - f1.x) * (x - f1.x) + f1.y * f1.y  - d * d) / (f1.y - d)));
+template<typename T>
+std::vector<Point2DT<T>> findIntersectionPoints(const Point2DT<T> &f1, const Point2DT<T> &f2, T d) {
+    std::vector<Point2DT<T>> result;
+    const T half = T(0.5);
+    if (std::abs(f1.x - f2.x) < Tolerance<T>::point()) {
+        T y = half * (f1.y + f2.y), D = std::sqrt(d * d - d * (f1.y + f2.y) + f1.y * f2.y);
+        result.push_back(Point2DT<T>(f1.x - D, y));
+        result.push_back(Point2DT<T>(f1.x + D, y));
+    } else if (std::abs(f1.y - f2.y) < Tolerance<T>::point()) {
+        T x = half * (f1.x + f2.x);
+        result.push_back(Point2DT<T>(x, half * ((x - f1.x) * (x - f1.x) + f1.y * f1.y  - d * d) / (f1.y - d)));
     } else {
         
-        double D = 2. * sqrt(pow(f1.x - f2.x, 2) * (d - f1.y) * (d - f2.y) * (pow(f1.x - f2.x, 2) + pow(f1.y - f2.y, 2)));
-        double T = -2. * d * pow(f1.x - f2.x, 2) + (f1.y + f2.y) * (pow(f2.x - f1.x, 2) + pow(f2.y - f1.y, 2));
-        double Q = 2. * pow(f1.y - f2.y, 2);
+        T dx2 = (f1.x - f2.x) * (f1.x - f2.x), dy2 = (f1.y - f2.y) * (f1.y - f2.y);
+        T D = 2 * std::sqrt(dx2 * (d - f1.y) * (d - f2.y) * (dx2 + dy2));
+        T S = -2 * d * dx2 + (f1.y + f2.y) * (dx2 + dy2);
+        T Q = 2 * dy2;
         
-        double y1 = (T - D) / Q, y2 = (T + D) / Q;
-        double x1 = 0.5 * (f1.x * f1.x - f2.x * f2.x + (2 * y1 - f2.y - f1.y) * (f2.y - f1.y)) / (f1.x - f2.x);
-        double x2 = 0.5 * (f1.x * f1.x - f2.x * f2.x + (2 * y2 - f2.y - f1.y) * (f2.y - f1.y)) / (f1.x - f2.x);
+        T y1 = (S - D) / Q, y2 = (S + D) / Q;
+        T x1 = half * (f1.x * f1.x - f2.x * f2.x + (2 * y1 - f2.y - f1.y) * (f2.y - f1.y)) / (f1.x - f2.x);
+        T x2 = half * (f1.x * f1.x - f2.x * f2.x + (2 * y2 - f2.y - f1.y) * (f2.y - f1.y)) / (f1.x - f2.x);
         
         if (x1 > x2) {
             std::swap(x1, x2);
             std::swap(y1, y2);
         }
-        result.push_back(Point2D(x1, y1));
-        result.push_back(Point2D(x2, y2));
+        result.push_back(Point2DT<T>(x1, y1));
+        result.push_back(Point2DT<T>(x2, y2));
     }
     return result;
 }
 
 
+/**
+ 
+ Find x-coordinate of the breakpoint between the arc of `f1` (on the left) and the arc of `f2` (on the right)
+ for the given directrix `d`. Returns the same root the beachline used to pick from findIntersectionPoints:
+ the left one if `f1` is higher than `f2` and the right one otherwise.
+ 
+ */
+template<typename T>
+T findBreakpoint(const Point2DT<T> &f1, const Point2DT<T> &f2, T d) {
+    if (f1.y == f2.y) {
+        return T(0.5) * (f1.x + f2.x);
+    }
+    
+    // With t = x - f1.x the breakpoint solves A t^2 - 2 B t + C = 0, where
+    //   u1 = f1.y - d, u2 = f2.y - d, e = f1.x - f2.x, dy = f1.y - f2.y,
+    //   A = -dy, B = u1 e, C = u1 (u2 dy - e^2) and B^2 - A C = u1 u2 (e^2 + dy^2).
+    // Both orderings of the foci need the root (B - s) / A, it is rewritten
+    // as C / (B + s) when B > 0 to avoid cancellation.
+    T u1 = f1.y - d, u2 = f2.y - d;
+    T e = f1.x - f2.x, dy = f1.y - f2.y;
+    T B = u1 * e;
+    T s = std::sqrt(u1 * u2 * (e * e + dy * dy));
+    T t = B > 0 ? u1 * (u2 * dy - e * e) / (B + s) : (B - s) / -dy;
+    return f1.x + t;
+}
+
+
+#define INSTANTIATE_PARABOLA(T) \
+    template int intersectionPointsNum(const Point2DT<T> &, const Point2DT<T> &); \
+    template std::vector<Point2DT<T>> findIntersectionPoints(const Point2DT<T> &, const Point2DT<T> &, T); \
+    template T findBreakpoint(const Point2DT<T> &, const Point2DT<T> &, T);
+
+INSTANTIATE_PARABOLA(float)
+INSTANTIATE_PARABOLA(double)
+
+
 /**
  Code for testing :)
  */
@@ -14,10 +14,12 @@
 
 /**
  
- Calculate number of intersection points between two parabolas with foci `f1` and `f2` and with given `directrix`
+ Calculate number of intersection points between two parabolas with foci `f1` and `f2` and with
+ the directrix below them, -1 if the foci are the same point
  
  */
-int intersectionPointsNum(const Point2D &f1, const Point2D &f2, double directrix);
+template<typename T>
+int intersectionPointsNum(const Point2DT<T> &f1, const Point2DT<T> &f2);
 
 
 /**
@@ -25,7 +27,18 @@ int intersectionPointsNum(const Point2D &f1, const Point2D &f2, double directrix
  Find intersection points of two parabolas with foci `f1` and `f2` and with given `directrix`
  
  */
-std::vector<Point2D> findIntersectionPoints(const Point2D &f1, const Point2D &f2, double directrix);
+template<typename T>
+std::vector<Point2DT<T>> findIntersectionPoints(const Point2DT<T> &f1, const Point2DT<T> &f2, T directrix);
+
+
+/**
+ 
+ Find x-coordinate of the breakpoint between the arc of `f1` (on the left) and the arc of `f2` (on the right)
+ for the given `directrix`. Computes only the root the beachline needs and does not allocate.
+ 
+ */
+template<typename T>
+T findBreakpoint(const Point2DT<T> &f1, const Point2DT<T> &f2, T directrix);
 
 
 #endif /* Parabola_hpp */
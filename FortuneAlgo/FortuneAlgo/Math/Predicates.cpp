@@ -0,0 +1,298 @@
+//
+//  Predicates.cpp
+//  FortuneAlgo
+//
+//  Floating-point filters and exact fallbacks follow J. R. Shewchuk,
+//  "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+//  An expansion is a sum of nonoverlapping doubles stored in increasing order of
+//  magnitude, its sign is the sign of the last term.
+//
+
+#include "Predicates.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+// Half of the machine epsilon: relative error of one rounding
+const double ROUNDOFF = std::numeric_limits<double>::epsilon() / 2.0;
+
+// 2^27 + 1, splits a double into two halves of 26 bits
+const double SPLITTER = 134217729.0;
+
+// Relative error bounds of the plain floating-point determinants
+const double ORIENT_ERROR_BOUND = (3.0 + 16.0 * ROUNDOFF) * ROUNDOFF;
+const double INCIRCLE_ERROR_BOUND = (10.0 + 96.0 * ROUNDOFF) * ROUNDOFF;
+
+
+/**
+ x + y == a + b exactly, |a| >= |b|
+ */
+static inline void fastTwoSum(double a, double b, double &x, double &y) {
+    x = a + b;
+    y = b - (x - a);
+}
+
+
+/**
+ x + y == a + b exactly
+ */
+static inline void twoSum(double a, double b, double &x, double &y) {
+    x = a + b;
+    double b_virtual = x - a, a_virtual = x - b_virtual;
+    y = (a - a_virtual) + (b - b_virtual);
+}
+
+
+/**
+ x + y == a - b exactly
+ */
+static inline void twoDiff(double a, double b, double &x, double &y) {
+    x = a - b;
+    double b_virtual = a - x, a_virtual = x + b_virtual;
+    y = (a - a_virtual) + (b_virtual - b);
+}
+
+
+static inline void split(double a, double &hi, double &lo) {
+    double c = SPLITTER * a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+
+/**
+ x + y == a * b exactly, `b` is given by its halves
+ */
+static inline void twoProduct(double a, double b, double b_hi, double b_lo, double &x, double &y) {
+    x = a * b;
+    double a_hi, a_lo;
+    split(a, a_hi, a_lo);
+    double err = x - a_hi * b_hi;
+    err -= a_lo * b_hi;
+    err -= a_hi * b_lo;
+    y = a_lo * b_lo - err;
+}
+
+
+/**
+ h = e + f, zero terms are dropped. Returns the number of terms of h,
+ which must have room for elen + flen terms.
+ */
+static int sumExpansions(int elen, const double *e, int flen, const double *f, double *h) {
+    int ei = 0, fi = 0, hlen = 0;
+    double q, q_new, hh;
+    // terms of e and f are merged by increasing magnitude
+    auto take = [&]() {
+        return fi == flen || (ei < elen && (f[fi] > e[ei]) == (f[fi] > -e[ei])) ? e[ei++] : f[fi++];
+    };
+    q = take();
+    if (ei + fi < elen + flen) {
+        fastTwoSum(take(), q, q_new, hh);
+        q = q_new;
+        if (hh != 0.0) {
+            h[hlen++] = hh;
+        }
+    }
+    while (ei + fi < elen + flen) {
+        twoSum(q, take(), q_new, hh);
+        q = q_new;
+        if (hh != 0.0) {
+            h[hlen++] = hh;
+        }
+    }
+    if (q != 0.0 || hlen == 0) {
+        h[hlen++] = q;
+    }
+    return hlen;
+}
+
+
+/**
+ h = e * b, zero terms are dropped. h must have room for 2 * elen terms.
+ */
+static int scaleExpansion(int elen, const double *e, double b, double *h) {
+    double b_hi, b_lo;
+    split(b, b_hi, b_lo);
+    int hlen = 0;
+    double q, hh, product1, product0, sum;
+    twoProduct(e[0], b, b_hi, b_lo, q, hh);
+    if (hh != 0.0) {
+        h[hlen++] = hh;
+    }
+    for (int i = 1; i < elen; ++i) {
+        twoProduct(e[i], b, b_hi, b_lo, product1, product0);
+        twoSum(q, product0, sum, hh);
+        if (hh != 0.0) {
+            h[hlen++] = hh;
+        }
+        fastTwoSum(product1, sum, q, hh);
+        if (hh != 0.0) {
+            h[hlen++] = hh;
+        }
+    }
+    if (q != 0.0 || hlen == 0) {
+        h[hlen++] = q;
+    }
+    return hlen;
+}
+
+
+/**
+ h = e * f for e of at most N and f of at most M terms.
+ h must have room for 2 * N * M terms.
+ */
+template<int N, int M>
+static int multiplyExpansions(int elen, const double *e, int flen, const double *f, double *h) {
+    double scaled[2 * N], sum[2 * N * M];
+    int hlen = scaleExpansion(elen, e, f[0], h);
+    for (int i = 1; i < flen; ++i) {
+        int slen = scaleExpansion(elen, e, f[i], scaled);
+        hlen = sumExpansions(hlen, h, slen, scaled, sum);
+        std::copy(sum, sum + hlen, h);
+    }
+    return hlen;
+}
+
+
+/**
+ h = e^2 + f^2 for differences of two doubles.
+ */
+static int liftExpansion(const double *e, const double *f, double *h) {
+    double e2[8], f2[8];
+    int e2len = multiplyExpansions<2, 2>(2, e, 2, e, e2);
+    int f2len = multiplyExpansions<2, 2>(2, f, 2, f, f2);
+    return sumExpansions(e2len, e2, f2len, f2, h);
+}
+
+
+/**
+ h = a * b - c * d for differences of two doubles.
+ */
+static int crossExpansion(const double *a, const double *b, const double *c, const double *d, double *h) {
+    double ab[8], cd[8];
+    int ablen = multiplyExpansions<2, 2>(2, a, 2, b, ab);
+    int cdlen = multiplyExpansions<2, 2>(2, c, 2, d, cd);
+    for (int i = 0; i < cdlen; ++i) {
+        cd[i] = -cd[i];
+    }
+    return sumExpansions(ablen, ab, cdlen, cd, h);
+}
+
+
+static double orient2dExact(double ax, double ay, double bx, double by, double cx, double cy) {
+    double acx[2], acy[2], bcx[2], bcy[2];
+    twoDiff(ax, cx, acx[1], acx[0]);
+    twoDiff(ay, cy, acy[1], acy[0]);
+    twoDiff(bx, cx, bcx[1], bcx[0]);
+    twoDiff(by, cy, bcy[1], bcy[0]);
+
+    double det[16];
+    int len = crossExpansion(acx, bcy, acy, bcx, det);
+    return det[len - 1];
+}
+
+
+static double orient2d(double ax, double ay, double bx, double by, double cx, double cy) {
+    double left = (ax - cx) * (by - cy);
+    double right = (ay - cy) * (bx - cx);
+    double det = left - right;
+
+    // terms of different signs cannot cancel
+    double sum;
+    if (left > 0.0) {
+        if (right <= 0.0) {
+            return det;
+        }
+        sum = left + right;
+    } else if (left < 0.0) {
+        if (right >= 0.0) {
+            return det;
+        }
+        sum = -left - right;
+    } else {
+        return det;
+    }
+
+    double bound = ORIENT_ERROR_BOUND * sum;
+    if (det >= bound || -det >= bound) {
+        return det;
+    }
+    return orient2dExact(ax, ay, bx, by, cx, cy);
+}
+
+
+static double incircleExact(double ax, double ay, double bx, double by,
+                            double cx, double cy, double dx, double dy) {
+    double adx[2], ady[2], bdx[2], bdy[2], cdx[2], cdy[2];
+    twoDiff(ax, dx, adx[1], adx[0]);
+    twoDiff(ay, dy, ady[1], ady[0]);
+    twoDiff(bx, dx, bdx[1], bdx[0]);
+    twoDiff(by, dy, bdy[1], bdy[0]);
+    twoDiff(cx, dx, cdx[1], cdx[0]);
+    twoDiff(cy, dy, cdy[1], cdy[0]);
+
+    double alift[16], blift[16], clift[16], bc[16], ca[16], ab[16];
+    int alen = liftExpansion(adx, ady, alift);
+    int blen = liftExpansion(bdx, bdy, blift);
+    int clen = liftExpansion(cdx, cdy, clift);
+    int bclen = crossExpansion(bdx, cdy, cdx, bdy, bc);
+    int calen = crossExpansion(cdx, ady, adx, cdy, ca);
+    int ablen = crossExpansion(adx, bdy, bdx, ady, ab);
+
+    double aterm[512], bterm[512], cterm[512], abterm[1024], det[1536];
+    int alen2 = multiplyExpansions<16, 16>(alen, alift, bclen, bc, aterm);
+    int blen2 = multiplyExpansions<16, 16>(blen, blift, calen, ca, bterm);
+    int clen2 = multiplyExpansions<16, 16>(clen, clift, ablen, ab, cterm);
+    int ablen2 = sumExpansions(alen2, aterm, blen2, bterm, abterm);
+    int len = sumExpansions(ablen2, abterm, clen2, cterm, det);
+    return det[len - 1];
+}
+
+
+static double incircle(double ax, double ay, double bx, double by,
+                       double cx, double cy, double dx, double dy) {
+    double adx = ax - dx, ady = ay - dy;
+    double bdx = bx - dx, bdy = by - dy;
+    double cdx = cx - dx, cdy = cy - dy;
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+    double alift = adx * adx + ady * ady;
+    double blift = bdx * bdx + bdy * bdy;
+    double clift = cdx * cdx + cdy * cdy;
+
+    double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift +
+                       (std::abs(cdxady) + std::abs(adxcdy)) * blift +
+                       (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+
+    double bound = INCIRCLE_ERROR_BOUND * permanent;
+    if (det > bound || -det > bound) {
+        return det;
+    }
+    return incircleExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+
+template<typename T>
+double orient2d(const Point2DT<T> &a, const Point2DT<T> &b, const Point2DT<T> &c) {
+    return orient2d(double(a.x), double(a.y), double(b.x), double(b.y), double(c.x), double(c.y));
+}
+
+
+template<typename T>
+double incircle(const Point2DT<T> &a, const Point2DT<T> &b, const Point2DT<T> &c, const Point2DT<T> &d) {
+    return incircle(double(a.x), double(a.y), double(b.x), double(b.y),
+                    double(c.x), double(c.y), double(d.x), double(d.y));
+}
+
+
+#define INSTANTIATE_PREDICATES(T) \
+    template double orient2d(const Point2DT<T> &, const Point2DT<T> &, const Point2DT<T> &); \
+    template double incircle(const Point2DT<T> &, const Point2DT<T> &, const Point2DT<T> &, const Point2DT<T> &);
+
+INSTANTIATE_PREDICATES(float)
+INSTANTIATE_PREDICATES(double)
@@ -0,0 +1,38 @@
+//
+//  Predicates.hpp
+//  FortuneAlgo
+//
+
+#ifndef Predicates_hpp
+#define Predicates_hpp
+
+#include "Point2D.h"
+
+
+/**
+
+ Orientation of the triangle `a`, `b`, `c`: positive if the points go counterclockwise,
+ negative if clockwise and zero if they are collinear. The sign is always exact.
+ The value is twice the signed area of the triangle, correctly rounded in most cases.
+
+ The determinant is evaluated in floating point first; only if its error bound does not
+ rule out the opposite sign it is recomputed exactly with floating-point expansions.
+ Float points are evaluated in double, which represents them exactly.
+
+ */
+template<typename T>
+double orient2d(const Point2DT<T> &a, const Point2DT<T> &b, const Point2DT<T> &c);
+
+
+/**
+
+ Position of `d` relative to the circle through `a`, `b`, `c` given counterclockwise:
+ positive if `d` is inside the circle, negative if outside and zero if on it.
+ The sign is always exact, the evaluation is filtered the same way as in orient2d.
+
+ */
+template<typename T>
+double incircle(const Point2DT<T> &a, const Point2DT<T> &b, const Point2DT<T> &c, const Point2DT<T> &d);
+
+
+#endif /* Predicates_hpp */
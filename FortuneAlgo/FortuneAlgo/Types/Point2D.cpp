@@ -15,153 +15,208 @@
 
 using namespace std;
 
-const double Point2D::Inf = std::numeric_limits<double>::infinity();
+template<typename T>
+const T Point2DT<T>::Inf = std::numeric_limits<T>::infinity();
 
-Point2D::Point2D_XY_Compare Point2D::xy_compare = Point2D::Point2D_XY_Compare();
+template<typename T>
+typename Point2DT<T>::Point2D_XY_Compare Point2DT<T>::xy_compare = typename Point2DT<T>::Point2D_XY_Compare();
 
-Point2D::Point2D(double _x, double _y) : x(_x), y(_y) {
+template<typename T>
+Point2DT<T>::Point2DT(T _x, T _y) : x(_x), y(_y) {
 }
 
-Point2D::Point2D(const Point2D &point) : x(point.x), y(point.y) {
+template<typename T>
+Point2DT<T>::Point2DT(const Point2DT &point) : x(point.x), y(point.y) {
 }
 
-double dotProduct(const Point2D &p1, const Point2D &p2) {
+template<typename T>
+T dotProduct(const Point2DT<T> &p1, const Point2DT<T> &p2) {
     return p1.x * p2.x + p1.y * p2.y;
 }
 
-double crossProduct(const Point2D &p1, const Point2D &p2) {
+template<typename T>
+T crossProduct(const Point2DT<T> &p1, const Point2DT<T> &p2) {
     return p1.x * p2.y - p1.y * p2.x;
 }
 
-Point2D operator+(const Point2D &p1, const Point2D &p2) {
-    return Point2D(p1.x + p2.x, p1.y + p2.y);
+template<typename T>
+Point2DT<T> operator+(const Point2DT<T> &p1, const Point2DT<T> &p2) {
+    return Point2DT<T>(p1.x + p2.x, p1.y + p2.y);
 }
 
-Point2D operator-(const Point2D &p1, const Point2D &p2) {
-    return Point2D(p1.x - p2.x, p1.y - p2.y);
+template<typename T>
+Point2DT<T> operator-(const Point2DT<T> &p1, const Point2DT<T> &p2) {
+    return Point2DT<T>(p1.x - p2.x, p1.y - p2.y);
 }
 
-Point2D operator/(const Point2D &p1, const Point2D &p2) {
-    return Point2D(p1.x / p2.x, p1.y / p2.y);
+template<typename T>
+Point2DT<T> operator/(const Point2DT<T> &p1, const Point2DT<T> &p2) {
+    return Point2DT<T>(p1.x / p2.x, p1.y / p2.y);
 }
 
-Point2D operator*(const Point2D &p, double value) {
-    return Point2D(p.x * value, p.y * value);
+template<typename T>
+Point2DT<T> operator*(const Point2DT<T> &p, T value) {
+    return Point2DT<T>(p.x * value, p.y * value);
 }
 
-Point2D operator*(double value, const Point2D &p) {
-    return Point2D(p.x * value, p.y * value);
+template<typename T>
+Point2DT<T> operator*(T value, const Point2DT<T> &p) {
+    return Point2DT<T>(p.x * value, p.y * value);
 }
 
-Point2D operator/(const Point2D &p, double value) {
-    return Point2D(p.x / value, p.y / value);
+template<typename T>
+Point2DT<T> operator/(const Point2DT<T> &p, T value) {
+    return Point2DT<T>(p.x / value, p.y / value);
 }
 
-Point2D operator-(const Point2D &p) {
-	return Point2D(-p.x, -p.y);
+template<typename T>
+Point2DT<T> operator-(const Point2DT<T> &p) {
+	return Point2DT<T>(-p.x, -p.y);
 }
 
-std::ostream &operator<<(std::ostream &stream, const Point2D &p) {
+template<typename T>
+std::ostream &operator<<(std::ostream &stream, const Point2DT<T> &p) {
     stream << "(" << p.x << "," << p.y << ")";
     return stream;
 }
 
-std::vector<Point2D> &operator<<(std::vector<Point2D> &v, const Point2D &p) {
+template<typename T>
+std::vector<Point2DT<T>> &operator<<(std::vector<Point2DT<T>> &v, const Point2DT<T> &p) {
     v.push_back(p);
     return v;
 }
 
-Point2D &Point2D::operator-=(const Point2D &p) {
+template<typename T>
+Point2DT<T> &Point2DT<T>::operator-=(const Point2DT &p) {
     x -= p.x;
     y -= p.y;
     return *this;
 }
 
-Point2D &Point2D::operator+=(const Point2D &p) {
+template<typename T>
+Point2DT<T> &Point2DT<T>::operator+=(const Point2DT &p) {
     x += p.x;
     y += p.y;
     return *this;
 }
 
-Point2D &Point2D::operator*=(double value) {
+template<typename T>
+Point2DT<T> &Point2DT<T>::operator*=(T value) {
     x *= value;
     y *= value;
     return *this;
 }
 
-Point2D &Point2D::operator/=(double value) {
+template<typename T>
+Point2DT<T> &Point2DT<T>::operator/=(T value) {
     x /= value;
     y /= value;
     return *this;
 }
 
-double Point2D::operator[](int i) {
+template<typename T>
+T Point2DT<T>::operator[](int i) {
     if (i==0) return x;
     else return y;
 }
 
-void Point2D::setX(double x) {
+template<typename T>
+void Point2DT<T>::setX(T x) {
     this->x = x;
 }
 
-void Point2D::setY(double y) {
+template<typename T>
+void Point2DT<T>::setY(T y) {
     this->y = y;
 }
 
-bool Point2D::isVertical() {
+template<typename T>
+bool Point2DT<T>::isVertical() {
     return (y == Inf && !isnan(x) && x != Inf);
 }
 
-bool Point2D::isHorizontal() {
+template<typename T>
+bool Point2DT<T>::isHorizontal() {
     return (x == Inf && !isnan(y) && y != Inf);
 }
 
-bool Point2D::isValid() {
+template<typename T>
+bool Point2DT<T>::isValid() {
     if (x == Inf && y == Inf)
         return false;
     return (!isnan(x) && !isnan(y));
 }
 
-Point2D Point2D::normalized() {
+template<typename T>
+Point2DT<T> Point2DT<T>::normalized() {
     return (*this) / this->norm();
 }
 
-void Point2D::normalize() {
-    double n = norm();
+template<typename T>
+void Point2DT<T>::normalize() {
+    T n = norm();
     x /= n;
     y /= n;
 }
 
-double Point2D::norm() {
+template<typename T>
+T Point2DT<T>::norm() {
     return sqrt(x * x + y * y);
 }
 
-double Point2D::norm2() {
+template<typename T>
+T Point2DT<T>::norm2() {
     return x *x + y * y;
 }
 
-Point2D Point2D::getRotated90CW() {
-    return Point2D(y, -x);
+template<typename T>
+Point2DT<T> Point2DT<T>::getRotated90CW() {
+    return Point2DT(y, -x);
 }
 
-Point2D Point2D::getRotated90CCW() {
-    return Point2D(-y, x);
+template<typename T>
+Point2DT<T> Point2DT<T>::getRotated90CCW() {
+    return Point2DT(-y, x);
 }
 
-bool Point2D::isLeftTurn(const Point2D &p1, const Point2D &p2, 
-						 const Point2D &p3) {
-	return (crossProduct(p2 - p1, p3 - p2) > 0.0);
+template<typename T>
+bool Point2DT<T>::isLeftTurn(const Point2DT &p1, const Point2DT &p2, 
+						 const Point2DT &p3) {
+	return (crossProduct(p2 - p1, p3 - p2) > 0);
 }
 
-bool Point2D::isRightTurn(const Point2D &p1, const Point2D &p2, 
-						  const Point2D &p3) {
-	return (crossProduct(p2 - p1, p3 - p2) < 0.0);
+template<typename T>
+bool Point2DT<T>::isRightTurn(const Point2DT &p1, const Point2DT &p2, 
+						  const Point2DT &p3) {
+	return (crossProduct(p2 - p1, p3 - p2) < 0);
 }
 
-bool equal(const Point2D &p1, const Point2D &p2, double EPSILON) {
+template<typename T>
+bool equal(const Point2DT<T> &p1, const Point2DT<T> &p2, T EPSILON) {
     return (fabs(p1.x - p2.x) < EPSILON && fabs(p1.y - p2.y) < EPSILON);
 }
 
-bool equal(double v1, double v2, double EPSILON) {
+template<typename T>
+bool equal(T v1, T v2, T EPSILON) {
     return fabs(v1 - v2) < EPSILON;
 }
+
+
+#define INSTANTIATE_POINT2D(T) \
+    template class Point2DT<T>; \
+    template T dotProduct(const Point2DT<T> &, const Point2DT<T> &); \
+    template T crossProduct(const Point2DT<T> &, const Point2DT<T> &); \
+    template Point2DT<T> operator+(const Point2DT<T> &, const Point2DT<T> &); \
+    template Point2DT<T> operator-(const Point2DT<T> &, const Point2DT<T> &); \
+    template Point2DT<T> operator/(const Point2DT<T> &, const Point2DT<T> &); \
+    template Point2DT<T> operator*(const Point2DT<T> &, T); \
+    template Point2DT<T> operator*(T, const Point2DT<T> &); \
+    template Point2DT<T> operator/(const Point2DT<T> &, T); \
+    template Point2DT<T> operator-(const Point2DT<T> &); \
+    template std::ostream &operator<<(std::ostream &, const Point2DT<T> &); \
+    template std::vector<Point2DT<T>> &operator<<(std::vector<Point2DT<T>> &, const Point2DT<T> &); \
+    template bool equal(const Point2DT<T> &, const Point2DT<T> &, T); \
+    template bool equal(T, T, T);
+
+INSTANTIATE_POINT2D(float)
+INSTANTIATE_POINT2D(double)
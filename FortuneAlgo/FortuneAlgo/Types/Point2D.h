@@ -1,84 +1,107 @@
-//
-//  Point2D.h
-//  KCGLib
-//
-//  Created by Kotsur on 12.03.14.
-//  Copyright (c) 2014 Dmytro Kotsur. All rights reserved.
-//
-
-#ifndef KCGLib_Point2D_h
-#define KCGLib_Point2D_h
-
-#include <iostream>
-#include <vector>
-#include <limits>
-#include <cmath>
-
-#define POINT_EPSILON 1.0e-6
-
-class Point2D {
-
-	struct Point2D_XY_Compare {
-		bool operator()(const Point2D &p1, const Point2D &p2) {
-			return (p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y));
-		}
-	};
-
-public:
-    double x, y;
-    
-    const static double Inf;
-	static Point2D_XY_Compare xy_compare;
-    
-    Point2D(double x = 0.0, double y = 0.0);
-    Point2D(const Point2D &point);
-    
-    friend double dotProduct(const Point2D &p1, const Point2D &p2);
-    friend double crossProduct(const Point2D &p1, const Point2D &p2);
-    
-    friend Point2D operator+(const Point2D &p1, const Point2D &p2);
-    friend Point2D operator-(const Point2D &p1, const Point2D &p2);
-    friend Point2D operator/(const Point2D &p1, const Point2D &p2);
-    friend Point2D operator*(const Point2D &p, double value);
-    friend Point2D operator*(double value, const Point2D &p);
-    friend Point2D operator/(const Point2D &p, double value);
-	friend Point2D operator-(const Point2D &p);
-
-    friend std::ostream &operator<<(std::ostream &stream, const Point2D &p);
-    friend std::vector<Point2D> &operator<<(std::vector<Point2D> &v, const Point2D &p);
-    
-    Point2D &operator-=(const Point2D &p);
-    Point2D &operator+=(const Point2D &p);
-    Point2D &operator*=(double value);
-    Point2D &operator/=(double value);
-    
-    Point2D normalized();
-    void normalize();
-    double norm();
-    double norm2();
-    
-    Point2D getRotated90CW();
-    Point2D getRotated90CCW();
-
-	static bool isLeftTurn(const Point2D &p1, const Point2D &p2, const Point2D &p3);
-	static bool isRightTurn(const Point2D &p1, const Point2D &p2, const Point2D &p3);
-    
-    double operator[](int i);
-    
-    void setX(double x);
-    void setY(double y);
-    
-    bool isVertical();
-    bool isHorizontal();
-    bool isValid();
-    
-};
-
-double dotProduct(const Point2D &p1, const Point2D &p2);
-double crossProduct(const Point2D &p1, const Point2D &p2);
-
-bool equal(const Point2D &p1, const Point2D &p2, double EPSILON = POINT_EPSILON);
-bool equal(double v1, double v2, double EPSILON = POINT_EPSILON);
-
-
-#endif
+//
+//  Point2D.h
+//  KCGLib
+//
+//  Created by Kotsur on 12.03.14.
+//  Copyright (c) 2014 Dmytro Kotsur. All rights reserved.
+//
+
+#ifndef KCGLib_Point2D_h
+#define KCGLib_Point2D_h
+
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+
+/**
+ Tolerances of geometric tests for the scalar type `T`.
+ Only float and double are supported.
+ */
+template<typename T>
+struct Tolerance;
+
+template<>
+struct Tolerance<double> {
+    // Points closer than this are equal, see `equal`
+    static constexpr double point() { return 1.0e-6; }
+};
+
+template<>
+struct Tolerance<float> {
+    static constexpr float point() { return 1.0e-5f; }
+};
+
+
+template<typename T>
+class Point2DT {
+
+	struct Point2D_XY_Compare {
+		bool operator()(const Point2DT &p1, const Point2DT &p2) {
+			return (p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y));
+		}
+	};
+
+public:
+    typedef T Scalar;
+
+    T x, y;
+
+    const static T Inf;
+	static Point2D_XY_Compare xy_compare;
+
+    Point2DT(T x = 0, T y = 0);
+    Point2DT(const Point2DT &point);
+
+    Point2DT &operator-=(const Point2DT &p);
+    Point2DT &operator+=(const Point2DT &p);
+    Point2DT &operator*=(T value);
+    Point2DT &operator/=(T value);
+
+    Point2DT normalized();
+    void normalize();
+    T norm();
+    T norm2();
+
+    Point2DT getRotated90CW();
+    Point2DT getRotated90CCW();
+
+	static bool isLeftTurn(const Point2DT &p1, const Point2DT &p2, const Point2DT &p3);
+	static bool isRightTurn(const Point2DT &p1, const Point2DT &p2, const Point2DT &p3);
+
+    T operator[](int i);
+
+    void setX(T x);
+    void setY(T y);
+
+    bool isVertical();
+    bool isHorizontal();
+    bool isValid();
+
+};
+
+
+typedef Point2DT<double> Point2D;
+typedef Point2DT<float> Point2Df;
+
+
+template<typename T> T dotProduct(const Point2DT<T> &p1, const Point2DT<T> &p2);
+template<typename T> T crossProduct(const Point2DT<T> &p1, const Point2DT<T> &p2);
+
+template<typename T> Point2DT<T> operator+(const Point2DT<T> &p1, const Point2DT<T> &p2);
+template<typename T> Point2DT<T> operator-(const Point2DT<T> &p1, const Point2DT<T> &p2);
+template<typename T> Point2DT<T> operator/(const Point2DT<T> &p1, const Point2DT<T> &p2);
+template<typename T> Point2DT<T> operator*(const Point2DT<T> &p, T value);
+template<typename T> Point2DT<T> operator*(T value, const Point2DT<T> &p);
+template<typename T> Point2DT<T> operator/(const Point2DT<T> &p, T value);
+template<typename T> Point2DT<T> operator-(const Point2DT<T> &p);
+
+template<typename T> std::ostream &operator<<(std::ostream &stream, const Point2DT<T> &p);
+template<typename T> std::vector<Point2DT<T>> &operator<<(std::vector<Point2DT<T>> &v, const Point2DT<T> &p);
+
+template<typename T> bool equal(const Point2DT<T> &p1, const Point2DT<T> &p2, T EPSILON = Tolerance<T>::point());
+template<typename T> bool equal(T v1, T v2, T EPSILON = Tolerance<T>::point());
+
+
+#endif
@@ -0,0 +1,220 @@
+//
+//  DiagramIO.cpp
+//  FortuneAlgo
+//
+
+#include "DiagramIO.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+
+// Arrays of the file in their order
+enum DiagramArray {
+    ARRAY_VX, ARRAY_VY,
+    ARRAY_TWIN, ARRAY_NEXT, ARRAY_PREV, ARRAY_ORIGIN, ARRAY_L_SITE, ARRAY_R_SITE,
+    ARRAY_FACES,
+    ARRAYS_NUM
+};
+
+
+struct DiagramHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t scalar_size;
+    uint64_t vertices_n;
+    uint64_t halfedges_n;
+    uint64_t faces_n;
+    char reserved[24];
+};
+
+static_assert(sizeof(DiagramHeader) == DIAGRAM_FILE_HEADER, "diagram header must take 64 bytes");
+
+
+static inline uint64_t alignUp(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+
+/**
+ Offsets of the arrays in the file, returns the size of the file.
+ The counts are not larger than the file, so nothing overflows.
+ */
+static uint64_t arrayOffsets(const DiagramHeader &header, uint64_t offsets[ARRAYS_NUM]) {
+    uint64_t offset = DIAGRAM_FILE_HEADER;
+    for (int a = 0; a < ARRAYS_NUM; ++a) {
+        offset = alignUp(offset);
+        offsets[a] = offset;
+        if (a <= ARRAY_VY) {
+            offset += header.vertices_n * header.scalar_size;
+        } else if (a < ARRAY_FACES) {
+            offset += header.halfedges_n * sizeof(uint32_t);
+        } else {
+            offset += header.faces_n * sizeof(uint32_t);
+        }
+    }
+    return offset;
+}
+
+
+static bool writeArray(FILE *file, uint64_t &position, uint64_t offset, const void *data, size_t bytes) {
+    static const char zeros[8] = {0};
+    if (fwrite(zeros, 1, offset - position, file) != offset - position) {
+        return false;
+    }
+    position = offset + bytes;
+    return bytes == 0 || fwrite(data, 1, bytes, file) == bytes;
+}
+
+
+template<typename T>
+bool write_diagram(const std::string &file_name, const DCEL::FlatDiagramT<T> &diagram) {
+    if (!is_little_endian()) {
+        return false;
+    }
+
+    DiagramHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DIAGRAM_FILE_MAGIC, sizeof(header.magic));
+    header.version = DIAGRAM_FILE_VERSION;
+    header.scalar_size = sizeof(T);
+    header.vertices_n = diagram.vertices_num();
+    header.halfedges_n = diagram.halfedges_num();
+    header.faces_n = diagram.faces.size();
+
+    uint64_t offsets[ARRAYS_NUM];
+    uint64_t size = arrayOffsets(header, offsets);
+
+    FILE *file = fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    const std::vector<uint32_t> *halfedge_arrays[] = {
+        &diagram.twin, &diagram.next, &diagram.prev, &diagram.origin, &diagram.l_site, &diagram.r_site
+    };
+    uint64_t position = sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writeArray(file, position, offsets[ARRAY_VX], diagram.vx.data(), diagram.vx.size() * sizeof(T)) &&
+              writeArray(file, position, offsets[ARRAY_VY], diagram.vy.data(), diagram.vy.size() * sizeof(T));
+    for (int a = ARRAY_TWIN; a < ARRAY_FACES && ok; ++a) {
+        const std::vector<uint32_t> &array = *halfedge_arrays[a - ARRAY_TWIN];
+        ok = writeArray(file, position, offsets[a], array.data(), array.size() * sizeof(uint32_t));
+    }
+    ok = ok && writeArray(file, position, offsets[ARRAY_FACES], diagram.faces.data(),
+                          diagram.faces.size() * sizeof(uint32_t)) &&
+         writeArray(file, position, size, nullptr, 0);
+    return fclose(file) == 0 && ok;
+}
+
+
+template<typename T>
+MappedDiagramT<T>::MappedDiagramT() {
+    reset_arrays();
+}
+
+
+template<typename T>
+MappedDiagramT<T>::MappedDiagramT(MappedDiagramT &&other) {
+    *this = std::move(other);
+}
+
+
+template<typename T>
+MappedDiagramT<T> &MappedDiagramT<T>::operator=(MappedDiagramT &&other) {
+    if (this != &other) {
+        file = std::move(other.file);
+        vx = other.vx; vy = other.vy;
+        twin = other.twin; next = other.next; prev = other.prev; origin = other.origin;
+        l_site = other.l_site; r_site = other.r_site;
+        faces = other.faces;
+        vertices_n = other.vertices_n;
+        halfedges_n = other.halfedges_n;
+        faces_n = other.faces_n;
+        other.close();
+    }
+    return *this;
+}
+
+
+template<typename T>
+bool MappedDiagramT<T>::open(const std::string &file_name) {
+    close();
+    if (!is_little_endian() || !file.open(file_name)) {
+        return false;
+    }
+
+    DiagramHeader header;
+    if (file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, DIAGRAM_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DIAGRAM_FILE_VERSION || header.scalar_size != sizeof(T) ||
+        header.vertices_n > file.size() || header.halfedges_n > file.size() || header.faces_n > file.size()) {
+        close();
+        return false;
+    }
+    uint64_t offsets[ARRAYS_NUM];
+    if (arrayOffsets(header, offsets) > file.size()) {
+        close();
+        return false;
+    }
+
+    // the file starts at a page boundary, so every array is aligned
+    const char *data = file.data();
+    vx = reinterpret_cast<const T *>(data + offsets[ARRAY_VX]);
+    vy = reinterpret_cast<const T *>(data + offsets[ARRAY_VY]);
+    twin = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_TWIN]);
+    next = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_NEXT]);
+    prev = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_PREV]);
+    origin = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_ORIGIN]);
+    l_site = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_L_SITE]);
+    r_site = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_R_SITE]);
+    faces = reinterpret_cast<const uint32_t *>(data + offsets[ARRAY_FACES]);
+    vertices_n = static_cast<size_t>(header.vertices_n);
+    halfedges_n = static_cast<size_t>(header.halfedges_n);
+    faces_n = static_cast<size_t>(header.faces_n);
+    return true;
+}
+
+
+template<typename T>
+void MappedDiagramT<T>::close() {
+    file.close();
+    reset_arrays();
+}
+
+
+template<typename T>
+void MappedDiagramT<T>::copy_to(DCEL::FlatDiagramT<T> &diagram) const {
+    diagram.vx.assign(vx, vx + vertices_n);
+    diagram.vy.assign(vy, vy + vertices_n);
+    diagram.twin.assign(twin, twin + halfedges_n);
+    diagram.next.assign(next, next + halfedges_n);
+    diagram.prev.assign(prev, prev + halfedges_n);
+    diagram.origin.assign(origin, origin + halfedges_n);
+    diagram.l_site.assign(l_site, l_site + halfedges_n);
+    diagram.r_site.assign(r_site, r_site + halfedges_n);
+    diagram.faces.assign(faces, faces + faces_n);
+}
+
+
+template<typename T>
+void MappedDiagramT<T>::reset_arrays() {
+    vx = vy = nullptr;
+    twin = next = prev = origin = nullptr;
+    l_site = r_site = nullptr;
+    faces = nullptr;
+    vertices_n = halfedges_n = faces_n = 0;
+}
+
+
+#define INSTANTIATE_DIAGRAM_IO(T) \
+    template bool write_diagram(const std::string &, const DCEL::FlatDiagramT<T> &); \
+    template class MappedDiagramT<T>;
+
+INSTANTIATE_DIAGRAM_IO(float)
+INSTANTIATE_DIAGRAM_IO(double)
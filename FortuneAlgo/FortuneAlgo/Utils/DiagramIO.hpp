@@ -0,0 +1,113 @@
+//
+//  DiagramIO.hpp
+//  FortuneAlgo
+//
+
+#ifndef DiagramIO_hpp
+#define DiagramIO_hpp
+
+#include "DCEL.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ Binary diagram file, a 64-byte header followed by the arrays of a flat
+ diagram in this order:
+
+   vx, vy                                      vertices_num coordinates each
+   twin, next, prev, origin, l_site, r_site    halfedges_num uint32 each
+   faces                                       faces_num uint32
+
+ The header is the magic "FAVORDGM", the format version and the size of a
+ coordinate (4 or 8 bytes) as uint32, then vertices_num, halfedges_num and
+ faces_num as uint64. Every array starts at a multiple of 8 bytes, the gaps
+ are zeros. All the numbers are little-endian, missing halfedges and vertices
+ are NO_INDEX, as in FlatDiagramT.
+ */
+const char DIAGRAM_FILE_MAGIC[8] = {'F', 'A', 'V', 'O', 'R', 'D', 'G', 'M'};
+const uint32_t DIAGRAM_FILE_VERSION = 1;
+const size_t DIAGRAM_FILE_HEADER = 64;
+
+
+/**
+ Write the diagram into a binary diagram file, e.g. right after build_voronoi.
+ Returns false if the file cannot be written.
+ */
+template<typename T>
+bool write_diagram(const std::string &file_name, const DCEL::FlatDiagramT<T> &diagram);
+
+
+/**
+ Binary diagram file mapped into memory read-only. The arrays are used in
+ place, so opening the file costs the same for any size, and processes
+ mapping the same file share its pages. Accessors follow FlatDiagramT.
+
+ Only the header and the file size are checked, indices are trusted to be
+ within the arrays as write_diagram leaves them.
+ */
+template<typename T>
+class MappedDiagramT {
+public:
+
+    const T *vx, *vy;
+    const uint32_t *twin, *next, *prev, *origin;
+    const uint32_t *l_site, *r_site;
+    const uint32_t *faces;
+
+    MappedDiagramT();
+
+    MappedDiagramT(MappedDiagramT &&other);
+    MappedDiagramT &operator=(MappedDiagramT &&other);
+
+    /**
+     Map the file, closing the previous one. Returns false if it cannot be
+     mapped, is not a diagram file of this version and coordinate type or is
+     shorter than its header says. Big-endian machines get false as well.
+     */
+    bool open(const std::string &file_name);
+
+    void close();
+
+    inline bool is_open() const { return file.is_open(); }
+
+    inline size_t vertices_num() const { return vertices_n; }
+    inline size_t halfedges_num() const { return halfedges_n; }
+    inline size_t faces_num() const { return faces_n; }
+
+    inline Point2DT<T> vertex(uint32_t v) const { return Point2DT<T>(vx[v], vy[v]); }
+
+    // Vertex the halfedge points towards
+    inline uint32_t target(uint32_t h) const { return origin[twin[h]]; }
+
+    inline bool is_finite(uint32_t h) const {
+        return origin[h] != DCEL::NO_INDEX && origin[twin[h]] != DCEL::NO_INDEX;
+    }
+
+    // Iterators around vertex
+    inline uint32_t vertexNextCCW(uint32_t h) const { return prev[twin[h]]; }
+    inline uint32_t vertexNextCW(uint32_t h) const { return twin[next[h]]; }
+
+    /**
+     Copy the arrays into a diagram, which can be changed or converted with
+     make_pointer_dcel.
+     */
+    void copy_to(DCEL::FlatDiagramT<T> &diagram) const;
+
+private:
+
+    MappedFile file;
+    size_t vertices_n, halfedges_n, faces_n;
+
+    void reset_arrays();
+
+};
+
+
+typedef MappedDiagramT<double> MappedDiagram;
+
+
+#endif /* DiagramIO_hpp */
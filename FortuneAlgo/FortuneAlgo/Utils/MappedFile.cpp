@@ -0,0 +1,90 @@
+//
+//  MappedFile.cpp
+//  FortuneAlgo
+//
+
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+MappedFile::MappedFile() : mapping(nullptr), length(0) {}
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+
+MappedFile::MappedFile(MappedFile &&other) : mapping(other.mapping), length(other.length) {
+    other.mapping = nullptr;
+    other.length = 0;
+}
+
+
+MappedFile &MappedFile::operator=(MappedFile &&other) {
+    if (this != &other) {
+        close();
+        std::swap(mapping, other.mapping);
+        std::swap(length, other.length);
+    }
+    return *this;
+}
+
+
+bool MappedFile::open(const std::string &file_name) {
+    close();
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *result = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (result != MAP_FAILED) {
+            mapping = result;
+            length = static_cast<size_t>(st.st_size);
+        }
+    }
+    // the mapping keeps the file open
+    ::close(fd);
+    return mapping != nullptr;
+}
+
+
+void MappedFile::close() {
+    if (mapping != nullptr) {
+        munmap(mapping, length);
+    }
+    mapping = nullptr;
+    length = 0;
+}
+
+
+void MappedFile::will_need() const {
+    if (mapping != nullptr) {
+        madvise(mapping, length, MADV_WILLNEED);
+    }
+}
+
+
+void MappedFile::sequential() const {
+    if (mapping != nullptr) {
+        madvise(mapping, length, MADV_SEQUENTIAL);
+    }
+}
+
+
+bool is_little_endian() {
+    const uint16_t probe = 1;
+    unsigned char byte;
+    memcpy(&byte, &probe, 1);
+    return byte == 1;
+}
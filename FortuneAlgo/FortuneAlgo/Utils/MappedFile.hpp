@@ -0,0 +1,65 @@
+//
+//  MappedFile.hpp
+//  FortuneAlgo
+//
+
+#ifndef MappedFile_hpp
+#define MappedFile_hpp
+
+#include <cstddef>
+#include <string>
+
+
+/**
+ Whole file mapped into memory read-only. The pages are shared with every
+ other process mapping the same file and are read as they are accessed.
+ */
+class MappedFile {
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     Map the file, closing the previous one. Returns false if the file
+     cannot be opened or mapped, an empty file cannot be mapped either.
+     */
+    bool open(const std::string &file_name);
+
+    void close();
+
+    // Hint that the whole file is going to be read soon, or from the start to the end
+    void will_need() const;
+    void sequential() const;
+
+    inline bool is_open() const {
+        return mapping != nullptr;
+    }
+
+    inline const char *data() const {
+        return static_cast<const char *>(mapping);
+    }
+
+    inline size_t size() const {
+        return length;
+    }
+
+private:
+
+    void *mapping;
+    size_t length;
+
+};
+
+
+// Whether the binary files can be used as they are, all the formats are little-endian
+bool is_little_endian();
+
+
+#endif /* MappedFile_hpp */
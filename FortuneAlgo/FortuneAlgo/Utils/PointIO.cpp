@@ -0,0 +1,227 @@
+//
+//  PointIO.cpp
+//  FortuneAlgo
+//
+
+#include "PointIO.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+
+static_assert(sizeof(Point2D) == 2 * sizeof(double), "Point2D must be a pair of doubles to map point files");
+
+
+// Chunks of a text file parsed by one task, several per thread to even out the load
+const size_t CHUNKS_PER_THREAD = 4;
+const size_t MIN_CHUNK_SIZE = 1 << 16;
+
+
+bool write_points_binary(const std::string &file_name, const std::vector<Point2D> &points) {
+    if (!is_little_endian()) {
+        return false;
+    }
+    FILE *file = fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint64_t points_n = points.size();
+    bool ok = fwrite(POINT_FILE_MAGIC, 1, sizeof(POINT_FILE_MAGIC), file) == sizeof(POINT_FILE_MAGIC) &&
+              fwrite(&points_n, sizeof(points_n), 1, file) == 1 &&
+              fwrite(points.data(), sizeof(Point2D), points.size(), file) == points.size();
+    return fclose(file) == 0 && ok;
+}
+
+
+MappedPoints::MappedPoints() : points(nullptr), points_n(0) {}
+
+
+MappedPoints::MappedPoints(MappedPoints &&other) :
+file(std::move(other.file)), points(other.points), points_n(other.points_n) {
+    other.close();
+}
+
+
+MappedPoints &MappedPoints::operator=(MappedPoints &&other) {
+    if (this != &other) {
+        file = std::move(other.file);
+        points = other.points;
+        points_n = other.points_n;
+        other.close();
+    }
+    return *this;
+}
+
+
+bool MappedPoints::open(const std::string &file_name) {
+    close();
+    if (!is_little_endian() || !file.open(file_name)) {
+        return false;
+    }
+
+    const char *bytes = file.data();
+    uint64_t header_n = 0;
+    if (file.size() < POINT_FILE_HEADER || memcmp(bytes, POINT_FILE_MAGIC, sizeof(POINT_FILE_MAGIC)) != 0) {
+        close();
+        return false;
+    }
+    memcpy(&header_n, bytes + sizeof(POINT_FILE_MAGIC), sizeof(header_n));
+    if (header_n > (file.size() - POINT_FILE_HEADER) / sizeof(Point2D)) {
+        close();
+        return false;
+    }
+
+    points = reinterpret_cast<const Point2D *>(bytes + POINT_FILE_HEADER);
+    points_n = static_cast<size_t>(header_n);
+    // the sweep reads all the sites right away to sort them
+    file.will_need();
+    return true;
+}
+
+
+void MappedPoints::close() {
+    file.close();
+    points = nullptr;
+    points_n = 0;
+}
+
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/**
+ Parse the whole token [first, last) as a double.
+ A leading plus sign is accepted, as it is by operator>>.
+ */
+static bool parseDouble(const char *first, const char *last, double &value) {
+    if (first != last && *first == '+') {
+        ++first;
+    }
+#if defined(__cpp_lib_to_chars)
+    std::from_chars_result result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+#else
+    // strtod needs a terminated string, the mapped file is not
+    char buffer[64];
+    size_t length = static_cast<size_t>(last - first);
+    if (length == 0 || length >= sizeof(buffer)) {
+        return false;
+    }
+    memcpy(buffer, first, length);
+    buffer[length] = '\0';
+    char *end;
+    value = strtod(buffer, &end);
+    return end == buffer + length;
+#endif
+}
+
+
+// Token boundaries: chunk k is [bounds[k], bounds[k + 1]) and starts with whitespace or a new token
+static void splitText(const char *first, const char *last, size_t chunks_num, std::vector<const char *> &bounds) {
+    bounds.assign(1, first);
+    size_t length = static_cast<size_t>(last - first);
+    for (size_t k = 1; k < chunks_num; ++k) {
+        const char *p = std::max(bounds.back(), first + length / chunks_num * k);
+        while (p != last && !isSpace(*p)) {
+            ++p;
+        }
+        bounds.push_back(p);
+    }
+    bounds.push_back(last);
+}
+
+
+bool read_points_text(const std::string &file_name, std::vector<Point2D> &points, int step, size_t threads_num) {
+    points.clear();
+    step = std::max(step, 1);
+
+    MappedFile file;
+    if (!file.open(file_name)) {
+        return false;
+    }
+    file.sequential();
+    const char *p = file.data(), *last = p + file.size();
+
+    // number of points
+    while (p != last && isSpace(*p)) {
+        ++p;
+    }
+    const char *token = p;
+    while (p != last && !isSpace(*p)) {
+        ++p;
+    }
+    double header_n;
+    if (!parseDouble(token, p, header_n) || header_n < 0.0) {
+        return false;
+    }
+    size_t points_n = static_cast<size_t>(header_n);
+
+    ThreadPool pool(threads_num);
+    size_t chunks_num = std::max<size_t>(1, std::min(pool.size() * CHUNKS_PER_THREAD,
+                                                     static_cast<size_t>(last - p) / MIN_CHUNK_SIZE));
+    std::vector<const char *> bounds;
+    splitText(p, last, chunks_num, bounds);
+
+    // count the numbers of every chunk to know the index of its first one
+    std::vector<size_t> first_number(chunks_num + 1, 0);
+    pool.run(chunks_num, [&](size_t chunk, size_t) {
+        size_t count = 0;
+        bool in_token = false;
+        for (const char *c = bounds[chunk]; c != bounds[chunk + 1]; ++c) {
+            bool space = isSpace(*c);
+            count += !space && !in_token;
+            in_token = !space;
+        }
+        first_number[chunk + 1] = count;
+    });
+    for (size_t k = 0; k < chunks_num; ++k) {
+        first_number[k + 1] += first_number[k];
+    }
+
+    // numbers 2i and 2i + 1 are the coordinates of point i, point i is kept if i % step == 0
+    points_n = std::min(points_n, first_number[chunks_num] / 2);
+    points.resize((points_n + step - 1) / step);
+    std::atomic<bool> failed(false);
+    pool.run(chunks_num, [&](size_t chunk, size_t) {
+        size_t number = first_number[chunk];
+        const char *c = bounds[chunk], *end = bounds[chunk + 1];
+        while (number < 2 * points_n && !failed.load(std::memory_order_relaxed)) {
+            while (c != end && isSpace(*c)) {
+                ++c;
+            }
+            if (c == end) {
+                break;
+            }
+            const char *token_first = c;
+            while (c != end && !isSpace(*c)) {
+                ++c;
+            }
+            size_t point = number / 2;
+            if (point % step == 0) {
+                // the two coordinates of a point may be parsed by different chunks
+                Point2D &target = points[point / step];
+                if (!parseDouble(token_first, c, number % 2 == 0 ? target.x : target.y)) {
+                    failed = true;
+                }
+            }
+            ++number;
+        }
+    });
+
+    if (failed) {
+        points.clear();
+        return false;
+    }
+    return true;
+}
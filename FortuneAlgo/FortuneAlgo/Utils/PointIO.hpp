@@ -0,0 +1,100 @@
+//
+//  PointIO.hpp
+//  FortuneAlgo
+//
+
+#ifndef PointIO_hpp
+#define PointIO_hpp
+
+#include "Point2D.h"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ Binary point file, a 16-byte header followed by the points:
+
+   bytes 0-7     magic "FAPOINT1"
+   bytes 8-15    number of points n, unsigned 64-bit little-endian
+   bytes 16-     n pairs of IEEE 754 doubles x, y, little-endian
+
+ The points start 8-byte aligned, so a mapped file is used as an array
+ of Point2D as it is. Bytes after the last point are ignored.
+ */
+const char POINT_FILE_MAGIC[8] = {'F', 'A', 'P', 'O', 'I', 'N', 'T', '1'};
+const size_t POINT_FILE_HEADER = 16;
+
+
+/**
+ Write `points` into a binary point file.
+ Returns false if the file cannot be written.
+ */
+bool write_points_binary(const std::string &file_name, const std::vector<Point2D> &points);
+
+
+/**
+ Binary point file mapped into memory read-only. The points are read
+ by the page as they are accessed and are never copied, pass them to
+ build_voronoi as `data()` and `size()`. They stay valid until the file
+ is closed or the object is destroyed.
+ */
+class MappedPoints {
+public:
+
+    MappedPoints();
+
+    MappedPoints(MappedPoints &&other);
+    MappedPoints &operator=(MappedPoints &&other);
+
+    /**
+     Map the file, closing the previous one. Returns false if it cannot be
+     mapped, is not a point file or is shorter than its header says.
+     Big-endian machines cannot use the file without a copy and get false as well.
+     */
+    bool open(const std::string &file_name);
+
+    void close();
+
+    inline bool is_open() const {
+        return file.is_open();
+    }
+
+    inline const Point2D *data() const {
+        return points;
+    }
+
+    inline size_t size() const {
+        return points_n;
+    }
+
+private:
+
+    MappedFile file;
+    const Point2D *points;
+    size_t points_n;
+
+};
+
+
+/**
+ Read a text point file: the number of points followed by `x y` pairs,
+ all separated by whitespace. Every `step`-th point is kept starting from
+ the first one, the others are skipped without parsing. Numbers after
+ the given number of points are ignored, a missing last coordinate drops
+ its point.
+
+ The file is mapped and split between `threads_num` threads at whitespace,
+ 0 means one per hardware thread. Numbers are parsed with std::from_chars
+ where the standard library has it for doubles, with strtod otherwise.
+ Returns false if the file cannot be read or a number is malformed,
+ `points` is empty then.
+ */
+bool read_points_text(const std::string &file_name, std::vector<Point2D> &points,
+                      int step = 1, size_t threads_num = 0);
+
+
+#endif /* PointIO_hpp */
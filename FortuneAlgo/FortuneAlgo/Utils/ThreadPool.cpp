@@ -0,0 +1,84 @@
+//
+//  ThreadPool.cpp
+//  FortuneAlgo
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(size_t threads_num) :
+task(nullptr), tasks_num(0), next_task(0), busy_workers(0), generation(0), stop(false) {
+    if (threads_num == 0) {
+        threads_num = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < threads_num; ++i) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_cv.notify_all();
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
+
+
+void ThreadPool::run(size_t _tasks_num, const Task &_task) {
+    if (threads.empty() || _tasks_num <= 1) {
+        for (size_t i = 0; i < _tasks_num; ++i) {
+            _task(i, 0);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &_task;
+        tasks_num = _tasks_num;
+        next_task = 0;
+        busy_workers = threads.size();
+        ++generation;
+    }
+    start_cv.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this] { return busy_workers == 0; });
+    task = nullptr;
+}
+
+
+void ThreadPool::work(size_t worker) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&] { return stop || generation != seen_generation; });
+            if (stop) {
+                return;
+            }
+            seen_generation = generation;
+        }
+        runTasks(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busy_workers;
+        }
+        done_cv.notify_one();
+    }
+}
+
+
+void ThreadPool::runTasks(size_t worker) {
+    for (size_t i = next_task++; i < tasks_num; i = next_task++) {
+        (*task)(i, worker);
+    }
+}
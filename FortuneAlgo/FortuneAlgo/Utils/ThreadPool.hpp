@@ -0,0 +1,66 @@
+//
+//  ThreadPool.hpp
+//  FortuneAlgo
+//
+
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ Fixed set of worker threads running batches of indexed tasks.
+ The thread calling `run` takes part in the batch as worker 0,
+ so a pool of size 1 runs everything on the calling thread.
+ */
+class ThreadPool {
+public:
+
+    // Task receives its index and the index of the worker running it
+    typedef std::function<void(size_t task, size_t worker)> Task;
+
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(size_t threads_num = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of workers including the calling thread
+    inline size_t size() const {
+        return threads.size() + 1;
+    }
+
+    // Run `task` for indices [0, tasks_num) and wait until all of them finish
+    void run(size_t tasks_num, const Task &task);
+
+private:
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start_cv, done_cv;
+
+    // Current batch
+    const Task *task;
+    size_t tasks_num;
+    std::atomic<size_t> next_task;
+    size_t busy_workers;
+    uint64_t generation;
+    bool stop;
+
+    void work(size_t worker);
+    void runTasks(size_t worker);
+
+};
+
+
+#endif /* ThreadPool_hpp */
@@ -0,0 +1,785 @@
+//
+//  DiagramRenderer.cpp
+//  FortuneAlgo
+//
+
+#include "DiagramRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+
+// Halfedges and sites handled by one task
+const size_t HALFEDGES_PER_TASK = 1 << 16;
+const size_t SITES_PER_TASK = 1 << 16;
+
+// Tasks done before their output is written, per thread of the pool
+const size_t TASKS_PER_THREAD = 4;
+
+// Rows of the PNG drawn and compressed by one task
+const size_t BAND_ROWS = 32;
+
+// Largest side of an image in pixels
+const size_t MAX_IMAGE_SIZE = 1 << 20;
+
+// Matches of deflate are searched among the last positions with the same hash of 4 bytes
+const int MATCH_HASH_BITS = 15;
+const size_t MIN_MATCH = 4, MAX_MATCH = 258, MATCH_WINDOW = 32768;
+
+
+/**
+ Viewport mapped onto the pixels of the image, y goes down in the image.
+ */
+struct PixelMap {
+    BoundingBox box;
+    size_t width, height;
+    double sx, sy;
+
+    inline double px(double x) const { return (x - box.xmin) * sx; }
+    inline double py(double y) const { return (box.ymax - y) * sy; }
+};
+
+
+static bool pixelMap(const RenderSettings &settings, PixelMap &map) {
+    const BoundingBox &box = settings.viewport;
+    double w = box.xmax - box.xmin, h = box.ymax - box.ymin;
+    if (!(w > 0.0 && h > 0.0) || settings.width == 0) {
+        return false;
+    }
+    map.box = box;
+    map.width = settings.width;
+    map.height = settings.height > 0 ? settings.height : static_cast<size_t>(std::lround(settings.width * h / w));
+    if (map.height == 0 || map.width > MAX_IMAGE_SIZE || map.height > MAX_IMAGE_SIZE) {
+        return false;
+    }
+    map.sx = map.width / w;
+    map.sy = map.height / h;
+    return true;
+}
+
+
+/**
+ Keep the part t0 <= t <= t1 of the line p + t * d inside the box (Liang-Barsky).
+ Returns false if the line misses the box.
+ */
+static bool clipLine(const BoundingBox &box, double px, double py, double dx, double dy, double &t0, double &t1) {
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {px - box.xmin, box.xmax - px, py - box.ymin, box.ymax - py};
+    for (int k = 0; k < 4; ++k) {
+        if (p[k] == 0.0) {
+            if (q[k] < 0.0) {
+                return false;
+            }
+        } else if (p[k] < 0.0) {
+            t0 = std::max(t0, q[k] / p[k]);
+        } else {
+            t1 = std::min(t1, q[k] / p[k]);
+        }
+    }
+    return t0 <= t1;
+}
+
+
+/**
+ Part of the edge of halfedge h inside the box, false if the edge misses it.
+ Unbounded edges go along the bisector of their sites, the halfedge runs
+ with its left site on the left.
+ */
+static bool edgeSegment(const Point2D *points, const DCEL::FlatDiagram &diagram, uint32_t h,
+                        const BoundingBox &box, double &ax, double &ay, double &bx, double &by) {
+    const double inf = std::numeric_limits<double>::infinity();
+    uint32_t from = diagram.origin[h], to = diagram.origin[diagram.twin[h]];
+    double px, py, dx, dy, t0 = 0.0, t1 = 1.0;
+    if (from != DCEL::NO_INDEX && to != DCEL::NO_INDEX) {
+        px = diagram.vx[from];
+        py = diagram.vy[from];
+        dx = diagram.vx[to] - px;
+        dy = diagram.vy[to] - py;
+    } else {
+        const Point2D &l = points[diagram.l_site[h]], &r = points[diagram.r_site[h]];
+        dx = l.y - r.y;
+        dy = r.x - l.x;
+        if (dx == 0.0 && dy == 0.0) {
+            return false;
+        }
+        t1 = inf;
+        if (from != DCEL::NO_INDEX) {
+            px = diagram.vx[from];
+            py = diagram.vy[from];
+        } else if (to != DCEL::NO_INDEX) {
+            // the ray into the target, drawn from the target backwards
+            px = diagram.vx[to];
+            py = diagram.vy[to];
+            dx = -dx;
+            dy = -dy;
+        } else {
+            px = 0.5 * (l.x + r.x);
+            py = 0.5 * (l.y + r.y);
+            t0 = -inf;
+        }
+    }
+    if (!clipLine(box, px, py, dx, dy, t0, t1)) {
+        return false;
+    }
+    ax = px + dx * t0;
+    ay = py + dy * t0;
+    bx = px + dx * t1;
+    by = py + dy * t1;
+    return true;
+}
+
+
+// Whether the site is drawn, its dot may stick into the image from outside
+static inline bool siteVisible(const PixelMap &map, double x, double y, double radius) {
+    return x >= -radius && x <= map.width + radius && y >= -radius && y <= map.height + radius;
+}
+
+
+/**
+ Run `tasks_n` tasks writing their output into a string on the threads of
+ the pool and write the strings into the file in the order of the tasks,
+ a few tasks per thread at a time.
+ */
+template<class Task>
+static bool writeTasks(FILE *file, size_t tasks_n, ThreadPool &pool, const Task &task) {
+    size_t wave = pool.size() * TASKS_PER_THREAD;
+    std::vector<std::string> outputs(std::min(wave, tasks_n));
+    for (size_t first = 0; first < tasks_n; first += wave) {
+        size_t n = std::min(wave, tasks_n - first);
+        pool.run(n, [&](size_t k, size_t) {
+            outputs[k].clear();
+            task(first + k, outputs[k]);
+        });
+        for (size_t k = 0; k < n; ++k) {
+            if (fwrite(outputs[k].data(), 1, outputs[k].size(), file) != outputs[k].size()) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ Pixel coordinate with one decimal, trailing ".0" dropped.
+ */
+static char *writeCoordinate(char *out, double v) {
+    long long tenths = std::llround(v * 10.0);
+    if (tenths < 0) {
+        *out++ = '-';
+        tenths = -tenths;
+    }
+    long long whole = tenths / 10;
+    int fraction = static_cast<int>(tenths % 10);
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    if (fraction != 0) {
+        *out++ = '.';
+        *out++ = static_cast<char>('0' + fraction);
+    }
+    return out;
+}
+
+
+bool render_svg(const std::string &file_name, const Point2D *points, size_t points_n,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool) {
+    PixelMap map;
+    if (!pixelMap(settings, map)) {
+        return false;
+    }
+    FILE *file = fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    bool ok = fprintf(file, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%zu\" height=\"%zu\" viewBox=\"0 0 %zu %zu\">\n"
+                      "<rect width=\"%zu\" height=\"%zu\" fill=\"#%06x\"/>\n"
+                      "<g fill=\"none\" stroke=\"#%06x\" stroke-width=\"%g\">\n",
+                      map.width, map.height, map.width, map.height, map.width, map.height,
+                      settings.background & 0xffffff, settings.edge_color & 0xffffff, settings.edge_width) > 0;
+
+    // every edge is drawn by the halfedge with the smaller index
+    size_t halfedges_n = diagram.halfedges_num();
+    size_t edge_tasks = (halfedges_n + HALFEDGES_PER_TASK - 1) / HALFEDGES_PER_TASK;
+    ok = ok && writeTasks(file, edge_tasks, pool, [&](size_t task, std::string &text) {
+        size_t begin = task * HALFEDGES_PER_TASK, end = std::min(begin + HALFEDGES_PER_TASK, halfedges_n);
+        char buffer[128];
+        for (size_t h = begin; h < end; ++h) {
+            double ax, ay, bx, by;
+            if (diagram.twin[h] < h || !edgeSegment(points, diagram, static_cast<uint32_t>(h), map.box, ax, ay, bx, by)) {
+                continue;
+            }
+            if (text.empty()) {
+                text.append("<path d=\"");
+            }
+            char *out = buffer;
+            *out++ = 'M';
+            out = writeCoordinate(out, map.px(ax));
+            *out++ = ' ';
+            out = writeCoordinate(out, map.py(ay));
+            *out++ = ' ';
+            out = writeCoordinate(out, map.px(bx));
+            *out++ = ' ';
+            out = writeCoordinate(out, map.py(by));
+            text.append(buffer, out);
+        }
+        if (!text.empty()) {
+            text.append("\"/>\n");
+        }
+    });
+    ok = ok && fputs("</g>\n", file) >= 0;
+
+    // sites are dots of zero-length paths with round caps
+    if (settings.site_radius > 0.0) {
+        ok = ok && fprintf(file, "<g fill=\"none\" stroke=\"#%06x\" stroke-width=\"%g\" stroke-linecap=\"round\">\n",
+                           settings.site_color & 0xffffff, 2.0 * settings.site_radius) > 0;
+        size_t site_tasks = (points_n + SITES_PER_TASK - 1) / SITES_PER_TASK;
+        ok = ok && writeTasks(file, site_tasks, pool, [&](size_t task, std::string &text) {
+            size_t begin = task * SITES_PER_TASK, end = std::min(begin + SITES_PER_TASK, points_n);
+            char buffer[64];
+            for (size_t i = begin; i < end; ++i) {
+                double x = map.px(points[i].x), y = map.py(points[i].y);
+                if (!siteVisible(map, x, y, settings.site_radius)) {
+                    continue;
+                }
+                if (text.empty()) {
+                    text.append("<path d=\"");
+                }
+                char *out = buffer;
+                *out++ = 'M';
+                out = writeCoordinate(out, x);
+                *out++ = ' ';
+                out = writeCoordinate(out, y);
+                *out++ = 'h';
+                *out++ = '0';
+                text.append(buffer, out);
+            }
+            if (!text.empty()) {
+                text.append("\"/>\n");
+            }
+        });
+        ok = ok && fputs("</g>\n", file) >= 0;
+    }
+
+    ok = ok && fputs("</svg>\n", file) >= 0;
+    return fclose(file) == 0 && ok;
+}
+
+
+bool render_svg(const std::string &file_name, const std::vector<Point2D> &points,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool) {
+    return render_svg(file_name, points.data(), points.size(), diagram, settings, pool);
+}
+
+
+// Edge and site in the pixels of the image
+struct PixelSegment {
+    float x0, y0, x1, y1;
+};
+
+struct PixelDot {
+    float x, y;
+};
+
+
+/**
+ Sort the items of all the tasks into the bands of rows they cross, in
+ compressed rows: band b gets binned[offsets[b], offsets[b + 1]).
+ `bands(item, first, last)` gives the first and the last band of an item.
+ */
+template<class Item, class Bands>
+static void binItems(const std::vector<std::vector<Item>> &items, size_t bands_n, const Bands &bands,
+                     std::vector<size_t> &offsets, std::vector<const Item *> &binned, ThreadPool &pool) {
+    size_t tasks_n = items.size();
+    std::vector<size_t> starts(tasks_n * bands_n, 0);
+    pool.run(tasks_n, [&](size_t task, size_t) {
+        size_t *counts = &starts[task * bands_n];
+        for (const Item &item : items[task]) {
+            size_t first, last;
+            bands(item, first, last);
+            for (size_t b = first; b <= last; ++b) {
+                counts[b]++;
+            }
+        }
+    });
+
+    // items of a band go in the order of the tasks
+    offsets.assign(bands_n + 1, 0);
+    size_t total = 0;
+    for (size_t b = 0; b < bands_n; ++b) {
+        offsets[b] = total;
+        for (size_t task = 0; task < tasks_n; ++task) {
+            size_t count = starts[task * bands_n + b];
+            starts[task * bands_n + b] = total;
+            total += count;
+        }
+    }
+    offsets[bands_n] = total;
+
+    binned.resize(total);
+    pool.run(tasks_n, [&](size_t task, size_t) {
+        size_t *positions = &starts[task * bands_n];
+        for (const Item &item : items[task]) {
+            size_t first, last;
+            bands(item, first, last);
+            for (size_t b = first; b <= last; ++b) {
+                binned[positions[b]++] = &item;
+            }
+        }
+    });
+}
+
+
+// First and last band of the rows [y0, y1], clamped to the image
+static inline void rowBands(double y0, double y1, size_t height, size_t &first, size_t &last) {
+    double top = std::min(std::max(std::floor(y0), 0.0), double(height - 1));
+    double bottom = std::min(std::max(std::floor(y1), 0.0), double(height - 1));
+    first = static_cast<size_t>(top) / BAND_ROWS;
+    last = static_cast<size_t>(bottom) / BAND_ROWS;
+}
+
+
+/**
+ Rows [row0, row1) of the image with a filter byte before every row.
+ */
+struct RasterBand {
+    std::vector<uint8_t> data;
+    size_t width, height, stride;
+    size_t row0, row1;
+
+    inline void set(long col, long row, const uint8_t color[3]) {
+        col = std::min(std::max(col, 0L), long(width) - 1);
+        row = std::min(std::max(row, 0L), long(height) - 1);
+        if (row < long(row0) || row >= long(row1)) {
+            return;
+        }
+        uint8_t *pixel = &data[(row - row0) * stride + 1 + 3 * col];
+        pixel[0] = color[0];
+        pixel[1] = color[1];
+        pixel[2] = color[2];
+    }
+};
+
+
+/**
+ Step along the part of the segment inside the rows of the band by at most
+ a pixel along both axes.
+ */
+static void drawSegment(RasterBand &band, const PixelSegment &s, const uint8_t color[3]) {
+    double x0 = s.x0, y0 = s.y0, dx = s.x1 - s.x0, dy = s.y1 - s.y0;
+    double t0 = 0.0, t1 = 1.0;
+    if (dy != 0.0) {
+        double ta = (double(band.row0) - y0) / dy, tb = (double(band.row1) - y0) / dy;
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+        if (t0 > t1) {
+            return;
+        }
+    }
+    double ax = x0 + dx * t0, ay = y0 + dy * t0;
+    double lx = dx * (t1 - t0), ly = dy * (t1 - t0);
+    long steps = static_cast<long>(std::ceil(std::max(std::fabs(lx), std::fabs(ly))));
+    for (long i = 0; i <= steps; ++i) {
+        double t = steps > 0 ? double(i) / steps : 0.0;
+        band.set(static_cast<long>(std::floor(ax + lx * t)), static_cast<long>(std::floor(ay + ly * t)), color);
+    }
+}
+
+
+// Pixels whose centres are within the radius, and the pixel of the centre itself
+static void drawDot(RasterBand &band, const PixelDot &d, double radius, const uint8_t color[3]) {
+    band.set(static_cast<long>(std::floor(d.x)), static_cast<long>(std::floor(d.y)), color);
+    long row_first = std::max(static_cast<long>(std::floor(d.y - radius)), long(band.row0));
+    long row_last = std::min(static_cast<long>(std::floor(d.y + radius)), long(band.row1) - 1);
+    long col_first = std::max(static_cast<long>(std::floor(d.x - radius)), 0L);
+    long col_last = std::min(static_cast<long>(std::floor(d.x + radius)), long(band.width) - 1);
+    for (long row = row_first; row <= row_last; ++row) {
+        double cy = row + 0.5 - d.y;
+        for (long col = col_first; col <= col_last; ++col) {
+            double cx = col + 0.5 - d.x;
+            if (cx * cx + cy * cy <= radius * radius) {
+                band.set(col, row, color);
+            }
+        }
+    }
+}
+
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t n) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+
+const uint32_t ADLER_BASE = 65521;
+
+static uint32_t adler32(const uint8_t *data, size_t n) {
+    uint32_t a = 1, b = 0;
+    while (n > 0) {
+        // the largest block whose sums cannot overflow
+        size_t block = std::min<size_t>(n, 5552);
+        n -= block;
+        for (size_t i = 0; i < block; ++i) {
+            a += data[i];
+            b += a;
+        }
+        data += block;
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+    }
+    return a | (b << 16);
+}
+
+
+// Checksum of two pieces of data from the checksums of both, as zlib does it
+static uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t length2) {
+    uint32_t rem = static_cast<uint32_t>(length2 % ADLER_BASE);
+    uint32_t sum1 = adler1 & 0xffff;
+    uint32_t sum2 = static_cast<uint32_t>((uint64_t(rem) * sum1) % ADLER_BASE);
+    sum1 += (adler2 & 0xffff) + ADLER_BASE - 1;
+    sum2 += (adler1 >> 16) + (adler2 >> 16) + ADLER_BASE - rem;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum2 >= 2 * ADLER_BASE) sum2 -= 2 * ADLER_BASE;
+    if (sum2 >= ADLER_BASE) sum2 -= ADLER_BASE;
+    return sum1 | (sum2 << 16);
+}
+
+
+/**
+ Codes of the fixed Huffman block of deflate (RFC 1951), bit-reversed for
+ the stream which is filled from the least significant bit. A match of
+ length 3-258 at distance 1 is one code with its extra bits and distance,
+ other distances replace the last five bits.
+ */
+struct FixedCodes {
+    uint32_t literal[286];
+    uint8_t literal_bits[286];
+    uint32_t match[259];
+    uint8_t match_bits[259];
+    uint32_t distance[30];
+};
+
+
+static uint32_t reverseBits(uint32_t code, int bits) {
+    uint32_t reversed = 0;
+    for (int k = 0; k < bits; ++k) {
+        reversed = (reversed << 1) | ((code >> k) & 1);
+    }
+    return reversed;
+}
+
+
+static const FixedCodes &fixedCodes() {
+    static const FixedCodes codes = [] {
+        FixedCodes c;
+        for (int symbol = 0; symbol < 286; ++symbol) {
+            uint32_t code;
+            int bits;
+            if (symbol < 144) {
+                code = 0x30 + symbol;
+                bits = 8;
+            } else if (symbol < 256) {
+                code = 0x190 + symbol - 144;
+                bits = 9;
+            } else if (symbol < 280) {
+                code = symbol - 256;
+                bits = 7;
+            } else {
+                code = 0xc0 + symbol - 280;
+                bits = 8;
+            }
+            c.literal[symbol] = reverseBits(code, bits);
+            c.literal_bits[symbol] = static_cast<uint8_t>(bits);
+        }
+        const int base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                              35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        const int extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                               3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        for (int length = 3; length <= 258; ++length) {
+            int k = 28;
+            while (base[k] > length) {
+                --k;
+            }
+            int symbol = 257 + k, bits = c.literal_bits[symbol];
+            // the code, the extra bits of the length and distance code 0 of five zero bits
+            c.match[length] = c.literal[symbol] | uint32_t(length - base[k]) << bits;
+            c.match_bits[length] = static_cast<uint8_t>(bits + extra[k] + 5);
+        }
+        for (int code = 0; code < 30; ++code) {
+            c.distance[code] = reverseBits(code, 5);
+        }
+        return c;
+    }();
+    return codes;
+}
+
+
+struct BitWriter {
+    std::string &out;
+    uint64_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::string &_out) : out(_out) {}
+
+    inline void put(uint32_t value, int n) {
+        bits |= uint64_t(value) << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(static_cast<char>(bits & 0xff));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    void align() {
+        if (count > 0) {
+            out.push_back(static_cast<char>(bits & 0xff));
+            bits = 0;
+            count = 0;
+        }
+    }
+};
+
+
+// Match at any distance within the window
+static inline void putMatch(BitWriter &writer, const FixedCodes &codes, size_t length, size_t distance) {
+    writer.put(codes.match[length], codes.match_bits[length] - 5);
+    uint32_t v = static_cast<uint32_t>(distance - 1);
+    if (v < 4) {
+        writer.put(codes.distance[v], 5);
+        return;
+    }
+    // codes go in pairs for every power of two, the rest are extra bits
+    int e = 2;
+    while ((v >> (e + 1)) != 0) {
+        ++e;
+    }
+    uint32_t code = 2 * e + ((v >> (e - 1)) & 1);
+    writer.put(codes.distance[code] | (v & ((1u << (e - 1)) - 1)) << 5, 5 + e - 1);
+}
+
+
+static inline uint32_t hash4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return (v * 2654435761u) >> (32 - MATCH_HASH_BITS);
+}
+
+
+/**
+ Deflate the data into one fixed Huffman block followed by an empty stored
+ block, which ends the piece on a byte boundary, so pieces compressed apart
+ can be put one after another. Runs of a repeated byte become matches at
+ distance 1, other matches are found by a single probe of a hash of the next
+ 4 bytes, which catches the pixels of the edges repeating along the rows.
+ */
+static void deflatePiece(const uint8_t *data, size_t n, std::string &out) {
+    const FixedCodes &codes = fixedCodes();
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> last(size_t(1) << MATCH_HASH_BITS, none);
+    BitWriter writer(out);
+    writer.put(0, 1);   // not the last block
+    writer.put(1, 2);   // fixed Huffman codes
+    size_t i = 0;
+    while (i < n) {
+        if (i > 0 && data[i] == data[i - 1]) {
+            size_t run = 1, limit = std::min(MAX_MATCH, n - i);
+            while (run < limit && data[i + run] == data[i - 1]) {
+                run++;
+            }
+            if (run >= 3) {
+                writer.put(codes.match[run], codes.match_bits[run]);
+                i += run;
+                continue;
+            }
+        }
+        if (i + MIN_MATCH <= n) {
+            uint32_t h = hash4(data + i), candidate = last[h];
+            last[h] = static_cast<uint32_t>(i);
+            if (candidate != none && i - candidate <= MATCH_WINDOW) {
+                size_t length = 0, limit = std::min(MAX_MATCH, n - i);
+                while (length < limit && data[candidate + length] == data[i + length]) {
+                    length++;
+                }
+                if (length >= MIN_MATCH) {
+                    putMatch(writer, codes, length, i - candidate);
+                    i += length;
+                    continue;
+                }
+            }
+        }
+        writer.put(codes.literal[data[i]], codes.literal_bits[data[i]]);
+        i++;
+    }
+    writer.put(codes.literal[256], codes.literal_bits[256]);
+    writer.put(0, 3);   // empty stored block, not the last one
+    writer.align();
+    out.append("\x00\x00\xff\xff", 4);
+}
+
+
+static void appendUint32(std::string &out, uint32_t value) {
+    char bytes[4] = {char(value >> 24), char(value >> 16), char(value >> 8), char(value)};
+    out.append(bytes, 4);
+}
+
+
+// Chunk of a PNG file: length, type, data and the CRC of the type and the data
+static void appendChunk(std::string &out, const char type[4], const std::string &data) {
+    appendUint32(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.append(type, 4);
+    out.append(data);
+    appendUint32(out, crc32(0, reinterpret_cast<const uint8_t *>(out.data()) + start, out.size() - start));
+}
+
+
+bool render_png(const std::string &file_name, const Point2D *points, size_t points_n,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool) {
+    PixelMap map;
+    if (!pixelMap(settings, map)) {
+        return false;
+    }
+    size_t width = map.width, height = map.height;
+    double radius = settings.site_radius;
+
+    // edges and sites in pixels, the tasks of the sites follow those of the edges
+    size_t halfedges_n = diagram.halfedges_num();
+    size_t edge_tasks = (halfedges_n + HALFEDGES_PER_TASK - 1) / HALFEDGES_PER_TASK;
+    size_t site_tasks = radius > 0.0 ? (points_n + SITES_PER_TASK - 1) / SITES_PER_TASK : 0;
+    std::vector<std::vector<PixelSegment>> segments(edge_tasks);
+    std::vector<std::vector<PixelDot>> dots(site_tasks);
+    pool.run(edge_tasks + site_tasks, [&](size_t task, size_t) {
+        if (task < edge_tasks) {
+            size_t begin = task * HALFEDGES_PER_TASK, end = std::min(begin + HALFEDGES_PER_TASK, halfedges_n);
+            for (size_t h = begin; h < end; ++h) {
+                double ax, ay, bx, by;
+                if (diagram.twin[h] > h && edgeSegment(points, diagram, static_cast<uint32_t>(h), map.box, ax, ay, bx, by)) {
+                    segments[task].push_back({float(map.px(ax)), float(map.py(ay)), float(map.px(bx)), float(map.py(by))});
+                }
+            }
+        } else {
+            size_t begin = (task - edge_tasks) * SITES_PER_TASK, end = std::min(begin + SITES_PER_TASK, points_n);
+            for (size_t i = begin; i < end; ++i) {
+                double x = map.px(points[i].x), y = map.py(points[i].y);
+                if (siteVisible(map, x, y, radius)) {
+                    dots[task - edge_tasks].push_back({float(x), float(y)});
+                }
+            }
+        }
+    });
+
+    size_t bands_n = (height + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<size_t> segment_offsets, dot_offsets;
+    std::vector<const PixelSegment *> band_segments;
+    std::vector<const PixelDot *> band_dots;
+    binItems(segments, bands_n, [&](const PixelSegment &s, size_t &first, size_t &last) {
+        rowBands(std::min(s.y0, s.y1), std::max(s.y0, s.y1), height, first, last);
+    }, segment_offsets, band_segments, pool);
+    binItems(dots, bands_n, [&](const PixelDot &d, size_t &first, size_t &last) {
+        rowBands(d.y - radius, d.y + radius, height, first, last);
+    }, dot_offsets, band_dots, pool);
+
+    FILE *file = fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::string header("\x89PNG\r\n\x1a\n", 8), ihdr;
+    appendUint32(ihdr, static_cast<uint32_t>(width));
+    appendUint32(ihdr, static_cast<uint32_t>(height));
+    ihdr.append("\x08\x02\x00\x00\x00", 5);   // 8-bit RGB, deflate, adaptive filters, no interlace
+    appendChunk(header, "IHDR", ihdr);
+    bool ok = fwrite(header.data(), 1, header.size(), file) == header.size();
+
+    const uint8_t background[3] = {uint8_t(settings.background >> 16), uint8_t(settings.background >> 8), uint8_t(settings.background)};
+    const uint8_t edge_color[3] = {uint8_t(settings.edge_color >> 16), uint8_t(settings.edge_color >> 8), uint8_t(settings.edge_color)};
+    const uint8_t site_color[3] = {uint8_t(settings.site_color >> 16), uint8_t(settings.site_color >> 8), uint8_t(settings.site_color)};
+    size_t stride = 1 + 3 * width;
+
+    // every band is a piece of the zlib stream in its own IDAT chunk
+    std::vector<uint32_t> adlers(bands_n);
+    std::vector<size_t> raw_sizes(bands_n);
+    ok = ok && writeTasks(file, bands_n, pool, [&](size_t b, std::string &chunk) {
+        RasterBand band;
+        band.width = width;
+        band.height = height;
+        band.stride = stride;
+        band.row0 = b * BAND_ROWS;
+        band.row1 = std::min(band.row0 + BAND_ROWS, height);
+        band.data.resize((band.row1 - band.row0) * stride);
+        for (size_t row = 0; row < band.row1 - band.row0; ++row) {
+            uint8_t *line = &band.data[row * stride];
+            line[0] = 1;   // filter Sub
+            for (size_t col = 0; col < width; ++col) {
+                memcpy(line + 1 + 3 * col, background, 3);
+            }
+        }
+        for (size_t k = segment_offsets[b]; k < segment_offsets[b + 1]; ++k) {
+            drawSegment(band, *band_segments[k], edge_color);
+        }
+        for (size_t k = dot_offsets[b]; k < dot_offsets[b + 1]; ++k) {
+            drawDot(band, *band_dots[k], radius, site_color);
+        }
+
+        // each byte minus the same byte of the pixel to the left, the background turns into zeros
+        for (size_t row = 0; row < band.row1 - band.row0; ++row) {
+            uint8_t *line = &band.data[row * stride] + 1;
+            for (size_t i = 3 * width - 1; i >= 3; --i) {
+                line[i] = static_cast<uint8_t>(line[i] - line[i - 3]);
+            }
+        }
+
+        raw_sizes[b] = band.data.size();
+        adlers[b] = adler32(band.data.data(), band.data.size());
+        std::string data;
+        if (b == 0) {
+            data.append("\x78\x01", 2);   // zlib header: deflate, 32K window
+        }
+        deflatePiece(band.data.data(), band.data.size(), data);
+        appendChunk(chunk, "IDAT", data);
+    });
+
+    // the last block of the stream is empty, then the checksum of all the bands
+    uint32_t adler = bands_n > 0 ? adlers[0] : 1;
+    for (size_t b = 1; b < bands_n; ++b) {
+        adler = adler32Combine(adler, adlers[b], raw_sizes[b]);
+    }
+    std::string tail, data("\x03\x00", 2);
+    appendUint32(data, adler);
+    appendChunk(tail, "IDAT", data);
+    appendChunk(tail, "IEND", std::string());
+    ok = ok && fwrite(tail.data(), 1, tail.size(), file) == tail.size();
+    return fclose(file) == 0 && ok;
+}
+
+
+bool render_png(const std::string &file_name, const std::vector<Point2D> &points,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool) {
+    return render_png(file_name, points.data(), points.size(), diagram, settings, pool);
+}
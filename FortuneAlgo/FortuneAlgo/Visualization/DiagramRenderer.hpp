@@ -0,0 +1,74 @@
+//
+//  DiagramRenderer.hpp
+//  FortuneAlgo
+//
+
+#ifndef DiagramRenderer_hpp
+#define DiagramRenderer_hpp
+
+#include "Point2D.h"
+#include "DCEL.hpp"
+#include "ClippedCells.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ What to draw and how. `viewport` is the part of the plane mapped onto the
+ image of `width` pixels, with y up; `height` 0 keeps the aspect ratio of the
+ viewport. Colours are 0xRRGGBB. Sites are dots of `site_radius` pixels, 0
+ draws no sites. Edges are `edge_width` pixels wide in SVG and one pixel in PNG.
+ */
+struct RenderSettings {
+    BoundingBox viewport = BoundingBox(0.0, 0.0, 1.0, 1.0);
+    size_t width = 1024;
+    size_t height = 0;
+    uint32_t background = 0xffffff;
+    uint32_t edge_color = 0x000000;
+    uint32_t site_color = 0x1f77b4;
+    double edge_width = 1.0;
+    double site_radius = 1.0;
+};
+
+
+/**
+ Draw the edges of the diagram of `points` and the sites into an SVG file.
+ Edges are taken straight from the halfedge arrays, unbounded ones are rays
+ along the bisector of their sites, and everything is clipped to the viewport.
+ Chunks of edges are formatted on the threads of `pool` and written in their
+ order as they are done, so the text of the whole image is never in memory.
+
+ Returns false if the file cannot be written or the viewport or the size of
+ the image is empty.
+ */
+bool render_svg(const std::string &file_name, const Point2D *points, size_t points_n,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool);
+
+bool render_svg(const std::string &file_name, const std::vector<Point2D> &points,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool);
+
+
+/**
+ Rasterize the same picture into an 8-bit RGB PNG file, without antialiasing.
+ The image is split into bands of rows. Edges and sites are sorted into the
+ bands they cross, then every band is drawn, filtered and deflated on its own
+ thread and written in order, so only the compressed image is kept. The
+ encoder is built in: runs of equal bytes and repeats found by a hash go to
+ fixed Huffman blocks, which is coarse but fast, as the background takes
+ most of a diagram.
+
+ Returns false if the file cannot be written or the viewport or the size of
+ the image is empty.
+ */
+bool render_png(const std::string &file_name, const Point2D *points, size_t points_n,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool);
+
+bool render_png(const std::string &file_name, const std::vector<Point2D> &points,
+                const DCEL::FlatDiagram &diagram, const RenderSettings &settings, ThreadPool &pool);
+
+
+#endif /* DiagramRenderer_hpp */
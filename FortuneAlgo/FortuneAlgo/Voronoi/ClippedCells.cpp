@@ -0,0 +1,325 @@
+//
+//  ClippedCells.cpp
+//  FortuneAlgo
+//
+
+#include "ClippedCells.hpp"
+
+#include <algorithm>
+
+
+// Halfedges whose cells are handled by one task of `cell_centroids`
+const size_t HALFEDGES_PER_TASK = 8192;
+
+
+/**
+ Vertex of a cell being clipped, `site` is on the other side
+ of the edge starting at the vertex.
+ */
+struct CellVertex {
+    Point2D point;
+    int site;
+};
+
+
+void ClippedCells::clear() {
+    offsets.clear();
+    x.clear();
+    y.clear();
+    neighbour.clear();
+}
+
+
+/**
+ Keep the part of a convex polygon where `side` is not positive.
+ The edge along the clipping line gets `site` as its neighbour,
+ new vertices are put exactly on the line by `snap`.
+ */
+template<class Side, class Snap>
+static void clipPolygon(const std::vector<CellVertex> &polygon, const Side &side, const Snap &snap,
+                        int site, std::vector<CellVertex> &clipped) {
+    clipped.clear();
+    size_t size = polygon.size();
+    for (size_t i = 0; i < size; ++i) {
+        const CellVertex &cur = polygon[i], &next = polygon[i + 1 < size ? i + 1 : 0];
+        double sc = side(cur.point), sn = side(next.point);
+        if (sc <= 0.0) {
+            clipped.push_back(cur);
+        }
+        if ((sc <= 0.0) != (sn <= 0.0)) {
+            Point2D p = cur.point + (next.point - cur.point) * (sc / (sc - sn));
+            snap(p);
+            // leaving the half-plane starts the edge along the line
+            clipped.push_back({p, sc <= 0.0 ? site : cur.site});
+        }
+    }
+}
+
+
+static void clipByBox(std::vector<CellVertex> &polygon, const BoundingBox &box, std::vector<CellVertex> &clipped) {
+    clipPolygon(polygon, [&](const Point2D &p) { return box.xmin - p.x; },
+                [&](Point2D &p) { p.x = box.xmin; }, BOX_EDGE, clipped);
+    clipPolygon(clipped, [&](const Point2D &p) { return p.x - box.xmax; },
+                [&](Point2D &p) { p.x = box.xmax; }, BOX_EDGE, polygon);
+    clipPolygon(polygon, [&](const Point2D &p) { return box.ymin - p.y; },
+                [&](Point2D &p) { p.y = box.ymin; }, BOX_EDGE, clipped);
+    clipPolygon(clipped, [&](const Point2D &p) { return p.y - box.ymax; },
+                [&](Point2D &p) { p.y = box.ymax; }, BOX_EDGE, polygon);
+}
+
+
+/**
+ Keep the part of the polygon closer to `site` than to `other`.
+ */
+static void clipByBisector(const Point2D &site, const Point2D &other, int other_site,
+                           std::vector<CellVertex> &polygon, std::vector<CellVertex> &clipped) {
+    Point2D mid = (site + other) * 0.5, dir = other - site;
+    clipPolygon(polygon, [&](const Point2D &p) { return (p.x - mid.x) * dir.x + (p.y - mid.y) * dir.y; },
+                [](Point2D &) {}, other_site, clipped);
+    polygon.swap(clipped);
+}
+
+
+/**
+ Close the unbounded cell of `site` given by a chain of halfedges by a segment
+ between the two rays, far enough for the box to stay on its inner side.
+ */
+static void closeUnboundedCell(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                               const BoundingBox &box, const Point2D &site,
+                               const std::vector<uint32_t> &chain, std::vector<CellVertex> &polygon) {
+    polygon.clear();
+    for (size_t k = 1; k < chain.size(); ++k) {
+        uint32_t v = diagram.origin[chain[k]];
+        polygon.push_back({Point2D(diagram.vx[v], diagram.vy[v]), static_cast<int>(diagram.r_site[chain[k]])});
+    }
+
+    // halfedges go with their own site on the left
+    auto ray = [&](uint32_t h) {
+        Point2D dir = points[diagram.r_site[h]] - site;
+        return Point2D(-dir.y, dir.x) / dir.norm();
+    };
+    Point2D first = polygon.front().point, last = polygon.back().point;
+    Point2D in_dir = ray(chain.front()), out_dir = ray(chain.back());
+    const Point2D corners[4] = {
+        Point2D(box.xmin, box.ymin), Point2D(box.xmax, box.ymin),
+        Point2D(box.xmax, box.ymax), Point2D(box.xmin, box.ymax)
+    };
+
+    double far = 1.0;
+    for (const Point2D &c : corners) {
+        far = std::max(far, 2.0 * std::max((c - first).norm(), (c - last).norm()));
+    }
+    Point2D far_in, far_out;
+    for (int attempt = 0; attempt < 64; ++attempt, far *= 2.0) {
+        far_in = first - in_dir * far;
+        far_out = last + out_dir * far;
+        bool inside = true;
+        for (const Point2D &c : corners) {
+            inside = inside && crossProduct(far_in - far_out, c - far_out) > 0.0;
+        }
+        if (inside) {
+            break;
+        }
+    }
+
+    polygon.insert(polygon.begin(), {far_in, static_cast<int>(diagram.r_site[chain.front()])});
+    polygon.push_back({far_out, BOX_EDGE});
+}
+
+
+/**
+ Polygon of the cell of site i clipped to the box, empty if the site has no cell.
+ */
+static void clipCell(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                     const BoundingBox &box, const std::vector<uint32_t> &strip_edges, uint32_t i,
+                     std::vector<uint32_t> &chain, std::vector<CellVertex> &polygon,
+                     std::vector<CellVertex> &clipped) {
+    const CellVertex box_polygon[4] = {
+        {Point2D(box.xmin, box.ymin), BOX_EDGE}, {Point2D(box.xmax, box.ymin), BOX_EDGE},
+        {Point2D(box.xmax, box.ymax), BOX_EDGE}, {Point2D(box.xmin, box.ymax), BOX_EDGE}
+    };
+    polygon.clear();
+
+    // sites coinciding with other sites have no cell,
+    // unless all the sites are the same
+    uint32_t start = diagram.faces[i];
+    if (start == DCEL::NO_INDEX) {
+        if (i == 0 && diagram.halfedges_num() == 0) {
+            polygon.assign(box_polygon, box_polygon + 4);
+        }
+        return;
+    }
+
+    const Point2D &site = points[i];
+    if (diagram.vertices_num() == 0) {
+        polygon.assign(box_polygon, box_polygon + 4);
+        for (int k = 0; k < 2; ++k) {
+            uint32_t h = strip_edges[2 * i + k];
+            if (h != DCEL::NO_INDEX) {
+                clipByBisector(site, points[diagram.r_site[h]], diagram.r_site[h], polygon, clipped);
+            }
+        }
+        return;
+    }
+
+    // faces[i] is the first halfedge of the chain if the cell is unbounded
+    chain.clear();
+    uint32_t h = start;
+    do {
+        chain.push_back(h);
+        h = diagram.next[h];
+    } while (h != DCEL::NO_INDEX && h != start);
+
+    if (h == start) {
+        bool inside = true;
+        for (uint32_t e : chain) {
+            uint32_t v = diagram.origin[e];
+            double x = diagram.vx[v], y = diagram.vy[v];
+            inside = inside && x >= box.xmin && x <= box.xmax && y >= box.ymin && y <= box.ymax;
+            polygon.push_back({Point2D(x, y), static_cast<int>(diagram.r_site[e])});
+        }
+        // most of the cells need no clipping
+        if (inside) {
+            return;
+        }
+    } else {
+        closeUnboundedCell(points, diagram, box, site, chain, polygon);
+    }
+    clipByBox(polygon, box, clipped);
+
+    // vertices made by clipping stay within the box despite rounding
+    for (CellVertex &vertex : polygon) {
+        vertex.point.x = std::min(std::max(vertex.point.x, box.xmin), box.xmax);
+        vertex.point.y = std::min(std::max(vertex.point.y, box.ymin), box.ymax);
+    }
+}
+
+
+/**
+ Without vertices all the sites are on a line and cells are strips
+ between the bisectors of neighbouring sites, one or two per site.
+ */
+static void stripEdges(size_t n, const DCEL::FlatDiagram &diagram, std::vector<uint32_t> &strip_edges) {
+    strip_edges.clear();
+    if (diagram.vertices_num() == 0) {
+        strip_edges.assign(2 * n, DCEL::NO_INDEX);
+        for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+            uint32_t s = diagram.l_site[h];
+            strip_edges[2 * s + (strip_edges[2 * s] == DCEL::NO_INDEX ? 0 : 1)] = h;
+        }
+    }
+}
+
+
+void clip_cells(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                const BoundingBox &box, ClippedCells &cells) {
+
+    size_t n = points.size();
+    std::vector<uint32_t> strip_edges;
+    stripEdges(n, diagram, strip_edges);
+
+    // Cells are visited in the order the sweep created their halfedges, which keeps
+    // the walks local in memory, and staged before going to their place by site.
+    // Clipping adds at most one vertex per cell and side of the box.
+    std::vector<CellVertex> staged, polygon, clipped;
+    std::vector<uint32_t> chain, first(n, DCEL::NO_INDEX), size(n, 0);
+    staged.reserve(diagram.halfedges_num() + 4 * n);
+
+    auto stage = [&](uint32_t s) {
+        clipCell(points, diagram, box, strip_edges, s, chain, polygon, clipped);
+        first[s] = static_cast<uint32_t>(staged.size());
+        size[s] = static_cast<uint32_t>(polygon.size());
+        staged.insert(staged.end(), polygon.begin(), polygon.end());
+    };
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        uint32_t s = diagram.l_site[h];
+        if (first[s] == DCEL::NO_INDEX) {
+            stage(s);
+        }
+    }
+    for (uint32_t s = 0; s < n; ++s) {
+        if (first[s] == DCEL::NO_INDEX) {
+            stage(s);
+        }
+    }
+
+    cells.clear();
+    cells.offsets.resize(n + 1);
+    cells.x.resize(staged.size());
+    cells.y.resize(staged.size());
+    cells.neighbour.resize(staged.size());
+    uint32_t offset = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        cells.offsets[s] = offset;
+        for (uint32_t k = first[s]; k < first[s] + size[s]; ++k, ++offset) {
+            cells.x[offset] = staged[k].point.x;
+            cells.y[offset] = staged[k].point.y;
+            cells.neighbour[offset] = staged[k].site;
+        }
+    }
+    cells.offsets[n] = offset;
+}
+
+
+/**
+ Centroid of a polygon, taking the coordinates relative to `origin`
+ inside it, or `origin` itself if the polygon has no area.
+ */
+static Point2D polygonCentroid(const std::vector<CellVertex> &polygon, const Point2D &origin) {
+    double area2 = 0.0, cx = 0.0, cy = 0.0;
+    for (size_t k = 0; k < polygon.size(); ++k) {
+        Point2D a = polygon[k].point - origin;
+        Point2D b = polygon[k + 1 < polygon.size() ? k + 1 : 0].point - origin;
+        double cross = crossProduct(a, b);
+        area2 += cross;
+        cx += (a.x + b.x) * cross;
+        cy += (a.y + b.y) * cross;
+    }
+    if (area2 <= 0.0) {
+        return origin;
+    }
+    return Point2D(origin.x + cx / (3.0 * area2), origin.y + cy / (3.0 * area2));
+}
+
+
+void cell_centroids(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                    const BoundingBox &box, std::vector<Point2D> &centroids, ThreadPool &pool) {
+
+    size_t n = points.size();
+    std::vector<uint32_t> strip_edges;
+    stripEdges(n, diagram, strip_edges);
+
+    struct Scratch {
+        std::vector<CellVertex> polygon, clipped;
+        std::vector<uint32_t> chain;
+    };
+    std::vector<Scratch> scratch(pool.size());
+
+    // as in clip_cells cells are visited in the order of their halfedges, a cell
+    // goes with its face halfedge and cells without one are left to the last task
+    size_t halfedges_n = diagram.halfedges_num();
+    centroids.resize(n);
+    size_t tasks_n = (halfedges_n + HALFEDGES_PER_TASK - 1) / HALFEDGES_PER_TASK + 1;
+    pool.run(tasks_n, [&](size_t task, size_t worker) {
+        Scratch &s = scratch[worker];
+        auto centroid = [&](uint32_t i) {
+            clipCell(points, diagram, box, strip_edges, i, s.chain, s.polygon, s.clipped);
+            centroids[i] = polygonCentroid(s.polygon, points[i]);
+        };
+        if (task + 1 == tasks_n) {
+            for (uint32_t i = 0; i < n; ++i) {
+                if (diagram.faces[i] == DCEL::NO_INDEX) {
+                    centroid(i);
+                }
+            }
+            return;
+        }
+        size_t end = std::min(halfedges_n, (task + 1) * HALFEDGES_PER_TASK);
+        for (size_t h = task * HALFEDGES_PER_TASK; h < end; ++h) {
+            uint32_t i = diagram.l_site[h];
+            if (diagram.faces[i] == h) {
+                centroid(i);
+            }
+        }
+    });
+}
@@ -0,0 +1,73 @@
+//
+//  ClippedCells.hpp
+//  FortuneAlgo
+//
+
+#ifndef ClippedCells_hpp
+#define ClippedCells_hpp
+
+#include "Point2D.h"
+#include "DCEL.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ Axis-aligned rectangle.
+ */
+struct BoundingBox {
+    double xmin, ymin, xmax, ymax;
+
+    BoundingBox(double _xmin = 0.0, double _ymin = 0.0, double _xmax = 0.0, double _ymax = 0.0) :
+    xmin(_xmin), ymin(_ymin), xmax(_xmax), ymax(_ymax) {}
+};
+
+
+// Neighbour of a cell edge lying on the side of the box
+const int BOX_EDGE = -1;
+
+
+/**
+ Cells of a Voronoi diagram clipped to a box, as closed polygons in
+ compressed rows: the polygon of site i has vertices [offsets[i], offsets[i + 1])
+ in counterclockwise order. The edge starting at vertex k separates the cell
+ from site `neighbour[k]`, or runs along the box if it is BOX_EDGE.
+ Cells lying outside the box are empty, and so are the cells of the repeats
+ of a site, whose first copy keeps the cell.
+ */
+struct ClippedCells {
+    std::vector<uint32_t> offsets;
+    std::vector<double> x, y;
+    std::vector<int> neighbour;
+
+    inline size_t cells_num() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    inline size_t cell_size(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    void clear();
+};
+
+
+/**
+ Clip every cell of `diagram` built for `points` to `box` in a single pass
+ over its halfedges, in time linear in the size of the diagram.
+ Unbounded cells are closed along the box.
+ The previous content of `cells` is discarded.
+ */
+void clip_cells(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                const BoundingBox &box, ClippedCells &cells);
+
+
+
+/**
+ Centroid of every cell of `diagram` clipped to `box`, computed on the threads
+ of `pool` in a single pass without keeping the polygons. Sites whose clipped
+ cells are empty, e.g. lying outside the box or repeating an earlier site, get
+ their own position.
+ */
+void cell_centroids(const std::vector<Point2D> &points, const DCEL::FlatDiagram &diagram,
+                    const BoundingBox &box, std::vector<Point2D> &centroids, ThreadPool &pool);
+
+
+#endif /* ClippedCells_hpp */
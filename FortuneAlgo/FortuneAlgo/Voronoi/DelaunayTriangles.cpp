@@ -0,0 +1,68 @@
+//
+//  DelaunayTriangles.cpp
+//  FortuneAlgo
+//
+
+#include "DelaunayTriangles.hpp"
+
+
+uint32_t DelaunayTriangles::add_triangle() {
+    uint32_t t = static_cast<uint32_t>(triangles_num());
+    triangles.insert(triangles.end(), 3, DCEL::NO_INDEX);
+    neighbours.insert(neighbours.end(), 3, DCEL::NO_INDEX);
+    return t;
+}
+
+
+uint32_t DelaunayTriangles::add_edge(uint32_t t, uint32_t l, uint32_t r) {
+    uint32_t *corners = &triangles[3 * t];
+    if (corners[0] == DCEL::NO_INDEX) {
+        corners[0] = l;
+        corners[1] = r;
+        return 2;
+    }
+    if (corners[2] == DCEL::NO_INDEX) {
+        // the edge follows the first one or goes before it
+        if (l == corners[1]) {
+            corners[2] = r;
+            return 0;
+        }
+        corners[2] = l;
+        return 1;
+    }
+    return corners[0] != l && corners[0] != r ? 0 : (corners[1] != l && corners[1] != r ? 1 : 2);
+}
+
+
+void DelaunayTriangles::clear() {
+    triangles.clear();
+    neighbours.clear();
+}
+
+
+template<typename T>
+void make_triangles(const DCEL::FlatDiagramT<T> &diagram, DelaunayTriangles &triangles) {
+    triangles.clear();
+    triangles.triangles.assign(3 * diagram.vertices_num(), DCEL::NO_INDEX);
+    triangles.neighbours.assign(3 * diagram.vertices_num(), DCEL::NO_INDEX);
+
+    // every halfedge going into a vertex is an edge of its triangle,
+    // the triangle across it is the vertex the halfedge starts from
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        uint32_t t = diagram.target(h);
+        if (t != DCEL::NO_INDEX) {
+            triangles.add_edge(t, diagram.l_site[h], diagram.r_site[h]);
+        }
+    }
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        uint32_t t = diagram.target(h);
+        if (t != DCEL::NO_INDEX) {
+            uint32_t corner = triangles.add_edge(t, diagram.l_site[h], diagram.r_site[h]);
+            triangles.neighbours[3 * t + corner] = diagram.origin[h];
+        }
+    }
+}
+
+
+template void make_triangles(const DCEL::FlatDiagramT<float> &, DelaunayTriangles &);
+template void make_triangles(const DCEL::FlatDiagramT<double> &, DelaunayTriangles &);
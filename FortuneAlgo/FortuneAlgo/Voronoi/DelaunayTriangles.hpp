@@ -0,0 +1,50 @@
+//
+//  DelaunayTriangles.hpp
+//  FortuneAlgo
+//
+
+#ifndef DelaunayTriangles_hpp
+#define DelaunayTriangles_hpp
+
+#include "DCEL.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ Delaunay triangulation as an index buffer: triangle t has the sites
+ triangles[3t], triangles[3t + 1], triangles[3t + 2] in counterclockwise order.
+ neighbours[3t + k] is the triangle across the edge opposite to the corner k,
+ NO_INDEX on the convex hull. Triangle t is the dual of the Voronoi vertex t,
+ so four or more cocircular sites give several triangles with the same circumcircle.
+ */
+struct DelaunayTriangles {
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> neighbours;
+
+    inline size_t triangles_num() const { return triangles.size() / 3; }
+
+    // Append a triangle without corners and neighbours, returns its index
+    uint32_t add_triangle();
+
+    /**
+     Put the edge from site `l` to site `r`, counterclockwise around triangle `t`,
+     into its corners. Returns the corner opposite to the edge. Any two edges
+     of a triangle give all its corners.
+     */
+    uint32_t add_edge(uint32_t t, uint32_t l, uint32_t r);
+
+    void clear();
+};
+
+
+/**
+ Collect the triangles of a diagram built before, one per vertex, by walking
+ the halfedges around it. Triangle t is the vertex t of `diagram`.
+ */
+template<typename T>
+void make_triangles(const DCEL::FlatDiagramT<T> &diagram, DelaunayTriangles &triangles);
+
+
+#endif /* DelaunayTriangles_hpp */
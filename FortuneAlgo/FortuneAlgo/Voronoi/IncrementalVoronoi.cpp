@@ -0,0 +1,580 @@
+//
+//  IncrementalVoronoi.cpp
+//  FortuneAlgo
+//
+
+#include "IncrementalVoronoi.hpp"
+#include "Predicates.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Diagrams of fewer sites, or without vertices (collinear sites), are always built from scratch
+const size_t MIN_LOCAL_SITES = 8;
+
+// Average number of sites in a bucket of the search grid
+const double SITES_PER_BUCKET = 2.0;
+
+// Rings of cells added to the rebuilt ones before giving up on a local repair
+const int MAX_EXTRA_RINGS = 2;
+
+
+enum SiteRole : uint8_t {
+    NOT_CHANGED,
+    REBUILT,
+    BOUNDARY,
+    REMOVED
+};
+
+
+/**
+ Call `f` for every halfedge of the cell of `site`. The face halfedge of an
+ unbounded cell starts its chain, so the chain from it covers the cell.
+ */
+template<class Function>
+static void forCell(const bl::FlatDiagram &diagram, uint32_t site, Function f) {
+    uint32_t first = diagram.faces[site];
+    for (uint32_t h = first; h != bl::NO_INDEX; ) {
+        f(h);
+        h = diagram.next[h];
+        if (h == first) {
+            break;
+        }
+    }
+}
+
+
+static inline double distance2(const Point2D &a, const Point2D &b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+
+// Whether `point` is not outside the circle through the three sites of a vertex
+static bool circleConflict(Point2D a, Point2D b, Point2D c, const Point2D &point) {
+    double orientation = orient2d(a, b, c);
+    if (orientation == 0.0) {
+        return true;
+    }
+    if (orientation < 0.0) {
+        std::swap(b, c);
+    }
+    return incircle(a, b, c, point) >= 0.0;
+}
+
+
+/**
+ Whether a site at `point` takes some part of the halfedge `h` from the cell of `site`.
+ Such part is a ray along the edge, so it contains one of its ends: a vertex closer
+ to the new site than to its own sites, or an infinite end on the outer side of
+ the line through the two sites. Ties count as conflicts, the cells are rebuilt then.
+ */
+static bool edgeInConflict(const bl::FlatDiagram &diagram, const std::vector<Point2D> &points,
+                           uint32_t site, uint32_t h, const Point2D &point) {
+    const Point2D &a = points[site], &b = points[diagram.r_site[h]];
+    uint32_t next = diagram.next[h], prev = diagram.prev[h];
+    bool target_conflict, origin_conflict;
+    if (diagram.target(h) == bl::NO_INDEX) {
+        target_conflict = orient2d(a, b, point) >= 0.0;
+    } else {
+        target_conflict = next == bl::NO_INDEX ||
+                          circleConflict(a, b, points[diagram.r_site[next]], point);
+    }
+    if (diagram.origin[h] == bl::NO_INDEX) {
+        origin_conflict = orient2d(b, a, point) >= 0.0;
+    } else {
+        origin_conflict = prev == bl::NO_INDEX ||
+                          circleConflict(a, b, points[diagram.r_site[prev]], point);
+    }
+    return target_conflict || origin_conflict;
+}
+
+
+/**
+ Give every empty bucket of the grid a site of the closest non-empty bucket
+ in its row, or in the closest row with sites, so searches start near the point.
+ */
+static void fillBuckets(std::vector<uint32_t> &buckets, size_t side) {
+    auto fill = [&](size_t first, size_t step) {
+        uint32_t last = bl::NO_INDEX;
+        for (size_t i = 0, k = first; i < side; ++i, k += step) {
+            if (buckets[k] == bl::NO_INDEX) {
+                buckets[k] = last;
+            } else {
+                last = buckets[k];
+            }
+        }
+    };
+    for (size_t row = 0; row < side; ++row) {
+        fill(row * side, 1);
+        fill(row * side + side - 1, size_t(-1));
+    }
+    for (size_t column = 0; column < side; ++column) {
+        fill(column, side);
+        fill((side - 1) * side + column, size_t(-side));
+    }
+}
+
+
+IncrementalVoronoi::IncrementalVoronoi() :
+live_sites_n(0), live_vertices_n(0), hint(0), grid_scale(0.0), grid_side(0), rebuilds(0) {}
+
+
+void IncrementalVoronoi::build(const std::vector<Point2D> &_points) {
+    points = _points;
+    live.assign(points.size(), true);
+    free_sites.clear();
+    role.assign(points.size(), NOT_CHANGED);
+    local_index.assign(points.size(), bl::NO_INDEX);
+
+    // repeats of a point are not added, as by `insert`, and their indices are free
+    std::vector<uint32_t> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+        const Point2D &p1 = points[i], &p2 = points[j];
+        return p1.y < p2.y || (p1.y == p2.y && (p1.x < p2.x || (p1.x == p2.x && i < j)));
+    });
+    for (size_t k = order.size(); k-- > 1; ) {
+        const Point2D &p = points[order[k]], &q = points[order[k - 1]];
+        if (p.x == q.x && p.y == q.y) {
+            live[order[k]] = false;
+            free_sites.push_back(order[k]);
+        }
+    }
+    live_sites_n = points.size() - free_sites.size();
+    rebuild();
+}
+
+
+uint32_t IncrementalVoronoi::insert(const Point2D &point) {
+    changed.clear();
+
+    if (live_sites_n < MIN_LOCAL_SITES || live_vertices_n == 0) {
+        for (size_t s = 0; s < points.size(); ++s) {
+            if (live[s] && points[s].x == point.x && points[s].y == point.y) {
+                return bl::NO_INDEX;
+            }
+        }
+        uint32_t site = new_site(point);
+        rebuild();
+        return site;
+    }
+
+    uint32_t nearest = nearest_site(point);
+    if (points[nearest].x == point.x && points[nearest].y == point.y) {
+        return bl::NO_INDEX;
+    }
+
+    // cells the new one takes a part of, they are connected through the edges it crosses
+    role[nearest] = REBUILT;
+    rebuilt.push_back(nearest);
+    for (size_t i = 0; i < rebuilt.size(); ++i) {
+        uint32_t site = rebuilt[i];
+        forCell(result, site, [&](uint32_t h) {
+            uint32_t neighbour = result.r_site[h];
+            if (role[neighbour] == NOT_CHANGED && edgeInConflict(result, points, site, h, point)) {
+                role[neighbour] = REBUILT;
+                rebuilt.push_back(neighbour);
+            }
+        });
+    }
+
+    uint32_t site = new_site(point);
+    role[site] = REBUILT;
+    rebuilt.push_back(site);
+    if (!repair(bl::NO_INDEX)) {
+        rebuild();
+    }
+    hint = site;
+    if (grid_side > 0) {
+        buckets[bucket(point)] = site;
+    }
+    return site;
+}
+
+
+bool IncrementalVoronoi::remove(uint32_t site) {
+    if (!is_site(site)) {
+        return false;
+    }
+    changed.clear();
+
+    bool repaired = false;
+    if (live_sites_n > MIN_LOCAL_SITES && live_vertices_n > 0) {
+        // the neighbours share the cell of the removed site
+        role[site] = REMOVED;
+        forCell(result, site, [&](uint32_t h) {
+            uint32_t neighbour = result.r_site[h];
+            if (role[neighbour] == NOT_CHANGED) {
+                role[neighbour] = REBUILT;
+                rebuilt.push_back(neighbour);
+            }
+        });
+        if (!rebuilt.empty()) {
+            hint = rebuilt.front();
+            if (grid_side > 0 && buckets[bucket(points[site])] == site) {
+                buckets[bucket(points[site])] = hint;
+            }
+        }
+        repaired = repair(site);
+        role[site] = NOT_CHANGED;
+    }
+
+    live[site] = false;
+    free_sites.push_back(site);
+    live_sites_n--;
+    result.faces[site] = bl::NO_INDEX;
+    if (!repaired) {
+        rebuild();
+    }
+    return true;
+}
+
+
+uint32_t IncrementalVoronoi::new_site(const Point2D &point) {
+    uint32_t site;
+    if (free_sites.empty()) {
+        site = static_cast<uint32_t>(points.size());
+        points.push_back(point);
+        live.push_back(true);
+        role.push_back(NOT_CHANGED);
+        local_index.push_back(bl::NO_INDEX);
+        result.faces.push_back(bl::NO_INDEX);
+    } else {
+        site = free_sites.back();
+        free_sites.pop_back();
+        points[site] = point;
+        live[site] = true;
+        result.faces[site] = bl::NO_INDEX;
+    }
+    live_sites_n++;
+    return site;
+}
+
+
+size_t IncrementalVoronoi::bucket(const Point2D &point) const {
+    double column = (point.x - grid_min.x) * grid_scale, row = (point.y - grid_min.y) * grid_scale;
+    size_t max_index = grid_side - 1;
+    size_t i = column <= 0.0 ? 0 : std::min(static_cast<size_t>(column), max_index);
+    size_t j = row <= 0.0 ? 0 : std::min(static_cast<size_t>(row), max_index);
+    return j * grid_side + i;
+}
+
+
+/**
+ Walk towards the point over the neighbours, each step to the closest one.
+ The walk can only stop at the nearest site, as Delaunay graph is greedy.
+ */
+uint32_t IncrementalVoronoi::nearest_site(const Point2D &point) {
+    uint32_t site = hint;
+    if (grid_side > 0 && is_site(buckets[bucket(point)])) {
+        site = buckets[bucket(point)];
+    }
+    if (!is_site(site)) {
+        site = 0;
+        while (!live[site]) {
+            ++site;
+        }
+    }
+    double best = distance2(points[site], point);
+    for (uint32_t current = bl::NO_INDEX; current != site; ) {
+        current = site;
+        forCell(result, current, [&](uint32_t h) {
+            uint32_t neighbour = result.r_site[h];
+            double d = distance2(points[neighbour], point);
+            if (d < best) {
+                best = d;
+                site = neighbour;
+            }
+        });
+    }
+    return site;
+}
+
+
+void IncrementalVoronoi::rebuild() {
+    clear_roles();
+    rebuilds++;
+
+    local_points.clear();
+    local_sites.clear();
+    for (size_t s = 0; s < points.size(); ++s) {
+        if (live[s]) {
+            local_sites.push_back(static_cast<uint32_t>(s));
+            local_points.push_back(points[s]);
+        }
+    }
+    build_voronoi(local_points, result, buffers);
+
+    for (uint32_t h = 0; h < result.halfedges_num(); ++h) {
+        result.l_site[h] = local_sites[result.l_site[h]];
+        result.r_site[h] = local_sites[result.r_site[h]];
+    }
+    std::vector<uint32_t> faces(points.size(), bl::NO_INDEX);
+    for (size_t i = 0; i < local_sites.size(); ++i) {
+        faces[local_sites[i]] = result.faces[i];
+    }
+    result.faces.swap(faces);
+
+    live_vertex.assign(result.vertices_num(), true);
+    live_vertices_n = result.vertices_num();
+    free_vertices.clear();
+    free_halfedges.clear();
+
+    changed = local_sites;
+    hint = local_sites.empty() ? 0 : local_sites.front();
+
+    // square grid over the bounding box of the sites
+    grid_side = 0;
+    buckets.clear();
+    if (local_points.size() >= MIN_LOCAL_SITES) {
+        Point2D grid_max = grid_min = local_points.front();
+        for (const Point2D &p : local_points) {
+            grid_min.x = std::min(grid_min.x, p.x);
+            grid_min.y = std::min(grid_min.y, p.y);
+            grid_max.x = std::max(grid_max.x, p.x);
+            grid_max.y = std::max(grid_max.y, p.y);
+        }
+        double extent = std::max(grid_max.x - grid_min.x, grid_max.y - grid_min.y);
+        if (extent > 0.0) {
+            grid_side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(local_points.size() / SITES_PER_BUCKET)));
+            grid_scale = grid_side / extent;
+            buckets.assign(grid_side * grid_side, bl::NO_INDEX);
+            for (size_t i = 0; i < local_points.size(); ++i) {
+                buckets[bucket(local_points[i])] = local_sites[i];
+            }
+            fillBuckets(buckets, grid_side);
+        }
+    }
+}
+
+
+/**
+ Rebuild the cells of `rebuilt`, adding a ring of their neighbours to them
+ each time the new cells do not fit the unchanged ones.
+ */
+bool IncrementalVoronoi::repair(uint32_t removed_site) {
+    for (int ring = 0; ring <= MAX_EXTRA_RINGS; ++ring) {
+        for (size_t i = 0; i < rebuilt.size(); ++i) {
+            forCell(result, rebuilt[i], [&](uint32_t h) {
+                uint32_t neighbour = result.r_site[h];
+                if (role[neighbour] == NOT_CHANGED) {
+                    role[neighbour] = BOUNDARY;
+                    boundary.push_back(neighbour);
+                }
+            });
+        }
+
+        if (splice_local(removed_site)) {
+            changed = rebuilt;
+            clear_roles();
+            return true;
+        }
+
+        for (uint32_t site : boundary) {
+            role[site] = REBUILT;
+            rebuilt.push_back(site);
+        }
+        boundary.clear();
+    }
+    clear_roles();
+    return false;
+}
+
+
+/**
+ Sweep over the rebuilt sites and their neighbours and put the cells of
+ the rebuilt sites into the diagram. All the sites which can bound these
+ cells take part in the sweep, so the cells are exact. Returns false and
+ leaves the diagram as it is if an edge towards an unchanged cell differs
+ from the existing one, which happens to degenerate input only.
+ */
+bool IncrementalVoronoi::splice_local(uint32_t removed_site) {
+    local_points.clear();
+    local_sites.clear();
+    for (const std::vector<uint32_t> *sites : {&rebuilt, &boundary}) {
+        for (uint32_t site : *sites) {
+            local_index[site] = static_cast<uint32_t>(local_sites.size());
+            local_sites.push_back(site);
+            local_points.push_back(points[site]);
+        }
+    }
+    build_voronoi(local_points.data(), local_points.size(), local, buffers);
+
+    local_halfedge.assign(local.halfedges_num(), bl::NO_INDEX);
+    local_vertex.assign(local.vertices_num(), bl::NO_INDEX);
+    auto mapVertex = [&](uint32_t local_v, uint32_t v) {
+        if (local_v == bl::NO_INDEX || v == bl::NO_INDEX) {
+            return local_v == v;
+        }
+        if (local_vertex[local_v] == bl::NO_INDEX) {
+            local_vertex[local_v] = v;
+        }
+        return local_vertex[local_v] == v;
+    };
+
+    // every edge between a rebuilt and an unchanged cell must be found in the diagram,
+    // its halfedge on the rebuilt side is reused and keeps its vertices
+    old_halfedges.clear();
+    for (uint32_t lh = 0; lh < local.halfedges_num(); ++lh) {
+        uint32_t site = local_sites[local.l_site[lh]];
+        uint32_t neighbour = local_sites[local.r_site[lh]];
+        if (role[site] != REBUILT || role[neighbour] != BOUNDARY) {
+            continue;
+        }
+        uint32_t kept = bl::NO_INDEX;
+        int found = 0;
+        forCell(result, site, [&](uint32_t h) {
+            if (result.r_site[h] == neighbour) {
+                kept = h;
+                found++;
+            }
+        });
+        if (found != 1 || !mapVertex(local.origin[lh], result.origin[kept]) ||
+            !mapVertex(local.target(lh), result.target(kept))) {
+            return false;
+        }
+        local_halfedge[lh] = kept;
+        old_halfedges.push_back(kept);
+    }
+    size_t kept_num = old_halfedges.size();
+    std::sort(old_halfedges.begin(), old_halfedges.end());
+    if (std::unique(old_halfedges.begin(), old_halfedges.end()) != old_halfedges.end()) {
+        return false;
+    }
+    size_t boundary_num = 0;
+    for (uint32_t site : rebuilt) {
+        forCell(result, site, [&](uint32_t h) {
+            boundary_num += role[result.r_site[h]] == BOUNDARY;
+        });
+    }
+    if (boundary_num != kept_num) {
+        return false;
+    }
+
+    // release the old halfedges of the rebuilt and removed cells and the vertices
+    // inside them, the kept halfedges are at the start of `old_halfedges`
+    kept_vertex.resize(result.vertices_num(), false);
+    for (size_t i = 0; i < kept_num; ++i) {
+        uint32_t h = old_halfedges[i];
+        for (uint32_t v : {result.origin[h], result.target(h)}) {
+            if (v != bl::NO_INDEX) {
+                kept_vertex[v] = true;
+            }
+        }
+    }
+    for (uint32_t site : rebuilt) {
+        forCell(result, site, [&](uint32_t h) {
+            old_halfedges.push_back(h);
+        });
+    }
+    if (removed_site != bl::NO_INDEX) {
+        forCell(result, removed_site, [&](uint32_t h) {
+            old_halfedges.push_back(h);
+        });
+    }
+    for (size_t i = kept_num; i < old_halfedges.size(); ++i) {
+        uint32_t h = old_halfedges[i];
+        if (std::binary_search(old_halfedges.begin(), old_halfedges.begin() + kept_num, h)) {
+            continue;
+        }
+        uint32_t v = result.origin[h];
+        if (v != bl::NO_INDEX && !kept_vertex[v] && live_vertex[v]) {
+            live_vertex[v] = false;
+            free_vertices.push_back(v);
+            live_vertices_n--;
+        }
+        result.twin[h] = result.next[h] = result.prev[h] = bl::NO_INDEX;
+        result.origin[h] = result.l_site[h] = result.r_site[h] = bl::NO_INDEX;
+        free_halfedges.push_back(h);
+    }
+    for (size_t i = 0; i < kept_num; ++i) {
+        uint32_t h = old_halfedges[i];
+        for (uint32_t v : {result.origin[h], result.target(h)}) {
+            if (v != bl::NO_INDEX) {
+                kept_vertex[v] = false;
+            }
+        }
+    }
+
+    // halfedges and vertices of the new cells
+    for (uint32_t lh = 0; lh < local.halfedges_num(); ++lh) {
+        if (role[local_sites[local.l_site[lh]]] != REBUILT) {
+            continue;
+        }
+        if (local_halfedge[lh] == bl::NO_INDEX) {
+            uint32_t h;
+            if (free_halfedges.empty()) {
+                h = static_cast<uint32_t>(result.halfedges_num());
+                result.twin.push_back(bl::NO_INDEX);
+                result.next.push_back(bl::NO_INDEX);
+                result.prev.push_back(bl::NO_INDEX);
+                result.origin.push_back(bl::NO_INDEX);
+                result.l_site.push_back(bl::NO_INDEX);
+                result.r_site.push_back(bl::NO_INDEX);
+            } else {
+                h = free_halfedges.back();
+                free_halfedges.pop_back();
+            }
+            local_halfedge[lh] = h;
+        }
+        uint32_t local_v = local.origin[lh];
+        if (local_v != bl::NO_INDEX && local_vertex[local_v] == bl::NO_INDEX) {
+            uint32_t v;
+            if (free_vertices.empty()) {
+                v = static_cast<uint32_t>(result.vertices_num());
+                result.vx.push_back(0.0);
+                result.vy.push_back(0.0);
+                live_vertex.push_back(true);
+            } else {
+                v = free_vertices.back();
+                free_vertices.pop_back();
+                live_vertex[v] = true;
+            }
+            result.vx[v] = local.vx[local_v];
+            result.vy[v] = local.vy[local_v];
+            local_vertex[local_v] = v;
+            live_vertices_n++;
+        }
+    }
+
+    // links of the new halfedges, the kept ones keep their twins in the unchanged cells
+    auto global = [&](uint32_t lh) {
+        return lh == bl::NO_INDEX ? bl::NO_INDEX : local_halfedge[lh];
+    };
+    for (uint32_t lh = 0; lh < local.halfedges_num(); ++lh) {
+        uint32_t site = local_sites[local.l_site[lh]];
+        if (role[site] != REBUILT) {
+            continue;
+        }
+        uint32_t h = local_halfedge[lh];
+        uint32_t neighbour = local_sites[local.r_site[lh]];
+        result.l_site[h] = site;
+        result.r_site[h] = neighbour;
+        result.origin[h] = local.origin[lh] == bl::NO_INDEX ? bl::NO_INDEX : local_vertex[local.origin[lh]];
+        if (role[neighbour] == REBUILT) {
+            result.twin[h] = local_halfedge[local.twin[lh]];
+        }
+        result.next[h] = global(local.next[lh]);
+        result.prev[h] = global(local.prev[lh]);
+    }
+    for (uint32_t site : rebuilt) {
+        result.faces[site] = global(local.faces[local_index[site]]);
+    }
+    return true;
+}
+
+
+void IncrementalVoronoi::clear_roles() {
+    for (const std::vector<uint32_t> *sites : {&rebuilt, &boundary}) {
+        for (uint32_t site : *sites) {
+            role[site] = NOT_CHANGED;
+            local_index[site] = bl::NO_INDEX;
+        }
+    }
+    rebuilt.clear();
+    boundary.clear();
+}
@@ -0,0 +1,146 @@
+//
+//  IncrementalVoronoi.hpp
+//  FortuneAlgo
+//
+
+#ifndef IncrementalVoronoi_hpp
+#define IncrementalVoronoi_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ Voronoi diagram kept up to date while sites are inserted and removed.
+
+ Only the cells which change are rebuilt: the sites whose cells meet the
+ cell of an inserted site, or the neighbours of a removed one. Their cells
+ are taken from the sweep over them and their neighbours, the only sites
+ which can bound them, and spliced into the diagram in place of the old
+ halfedges. The edges towards the unchanged cells are kept together with
+ their vertices, so the cost follows the number of neighbours, not the
+ number of sites. Degenerate neighbourhoods, e.g. cocircular sites, which
+ the local sweep splits differently, are retried with one more ring of
+ cells and finally by the sweep over all the sites.
+
+ Sites keep their indices, indices of removed sites are reused by later
+ insertions. Halfedges and vertices of the removed parts stay in the arrays
+ of `diagram` until they are reused: a removed halfedge has no twin, see
+ `is_halfedge` and `is_vertex`, and a removed site has no face.
+ */
+class IncrementalVoronoi {
+public:
+
+    IncrementalVoronoi();
+
+    /**
+     Build the diagram of `points` from scratch, site i is points[i].
+     A point repeating an earlier one is not added, as by `insert`: its index
+     is not a site and is free for later insertions.
+     */
+    void build(const std::vector<Point2D> &points);
+
+    /**
+     Add a site and return its index.
+     A site at the point of another one is not added, NO_INDEX is returned then.
+     */
+    uint32_t insert(const Point2D &point);
+
+    // Remove the site, returns false if there is no such site
+    bool remove(uint32_t site);
+
+    /**
+     Sites whose cells were changed or created by the last `insert` or `remove`,
+     a removed site is not among them. A rebuild of the whole diagram lists all the sites.
+     */
+    inline const std::vector<uint32_t> &changed_faces() const {
+        return changed;
+    }
+
+    inline const bl::FlatDiagram &diagram() const {
+        return result;
+    }
+
+    inline const Point2D &point(uint32_t site) const {
+        return points[site];
+    }
+
+    inline bool is_site(uint32_t site) const {
+        return site < live.size() && live[site];
+    }
+
+    inline bool is_halfedge(uint32_t h) const {
+        return result.twin[h] != bl::NO_INDEX;
+    }
+
+    inline bool is_vertex(uint32_t v) const {
+        return live_vertex[v];
+    }
+
+    inline size_t sites_num() const {
+        return live_sites_n;
+    }
+
+    // Number of times the whole diagram was built, e.g. by `build` or for degenerate input
+    inline size_t rebuilds_num() const {
+        return rebuilds;
+    }
+
+private:
+
+    // sites, removed ones are not live and their slots are free
+    std::vector<Point2D> points;
+    std::vector<bool> live;
+    std::vector<uint32_t> free_sites;
+    size_t live_sites_n;
+
+    bl::FlatDiagram result;
+    std::vector<bool> live_vertex;
+    std::vector<uint32_t> free_vertices, free_halfedges;
+    size_t live_vertices_n;
+
+    // the site a search starts from: a site of the bucket of the point in a grid over
+    // the sites of the last full build, or the last changed site if the bucket is empty
+    uint32_t hint;
+    std::vector<uint32_t> buckets;
+    Point2D grid_min;
+    double grid_scale;
+    size_t grid_side;
+    std::vector<uint32_t> changed;
+    size_t rebuilds;
+
+    // role of every site in the current change and the local sweep over the rebuilt cells
+    std::vector<uint8_t> role;
+    std::vector<uint32_t> local_index;
+    std::vector<uint32_t> rebuilt, boundary;
+    std::vector<Point2D> local_points;
+    std::vector<uint32_t> local_sites;
+    bl::FlatDiagram local;
+    SweepBuffers buffers;
+
+    // halfedge and vertex of the diagram for every halfedge and vertex of `local`
+    std::vector<uint32_t> local_halfedge, local_vertex;
+    std::vector<uint32_t> old_halfedges;
+    std::vector<bool> kept_vertex;
+
+    uint32_t new_site(const Point2D &point);
+
+    size_t bucket(const Point2D &point) const;
+
+    uint32_t nearest_site(const Point2D &point);
+
+    void rebuild();
+
+    bool repair(uint32_t removed_site);
+
+    bool splice_local(uint32_t removed_site);
+
+    void clear_roles();
+
+};
+
+
+#endif /* IncrementalVoronoi_hpp */
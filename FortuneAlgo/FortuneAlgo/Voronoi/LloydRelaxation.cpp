@@ -0,0 +1,64 @@
+//
+//  LloydRelaxation.cpp
+//  FortuneAlgo
+//
+
+#include "LloydRelaxation.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+size_t relax_lloyd(std::vector<Point2D> &points, const BoundingBox &box, ThreadPool &pool,
+                   const LloydSettings &settings, std::vector<LloydIteration> *report) {
+    bl::FlatDiagram diagram;
+    SweepBuffers buffers;
+    return relax_lloyd(points, box, pool, diagram, buffers, settings, report);
+}
+
+
+size_t relax_lloyd(std::vector<Point2D> &points, const BoundingBox &box, ThreadPool &pool,
+                   bl::FlatDiagram &diagram, SweepBuffers &buffers,
+                   const LloydSettings &settings, std::vector<LloydIteration> *report) {
+    bool reuse_order = buffers.reuse_order;
+    std::vector<Point2D> centroids;
+
+    size_t iteration = 0;
+    while (iteration < settings.max_iterations && !points.empty()) {
+        LloydIteration stats;
+
+        auto start = std::chrono::steady_clock::now();
+        // the first sweep sorts the sites, the next ones start from its order
+        buffers.reuse_order = reuse_order || iteration > 0;
+        build_voronoi(points, diagram, buffers);
+        stats.sweep_time = since(start);
+
+        start = std::chrono::steady_clock::now();
+        cell_centroids(points, diagram, box, centroids, pool);
+        double shift_sum = 0.0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            double shift = (centroids[i] - points[i]).norm();
+            stats.max_shift = std::max(stats.max_shift, shift);
+            shift_sum += shift;
+        }
+        points.swap(centroids);
+        stats.mean_shift = shift_sum / points.size();
+        stats.centroid_time = since(start);
+
+        iteration++;
+        if (report != nullptr) {
+            report->push_back(stats);
+        }
+        if (stats.max_shift <= settings.max_shift || stats.mean_shift < settings.mean_shift) {
+            break;
+        }
+    }
+
+    buffers.reuse_order = reuse_order;
+    return iteration;
+}
@@ -0,0 +1,71 @@
+//
+//  LloydRelaxation.hpp
+//  FortuneAlgo
+//
+
+#ifndef LloydRelaxation_hpp
+#define LloydRelaxation_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+#include "ClippedCells.hpp"
+#include "ThreadPool.hpp"
+
+#include <vector>
+
+
+/**
+ When to stop the relaxation: after `max_iterations`, or once the sites of an
+ iteration moved no farther than `max_shift` or less than `mean_shift` on average.
+ Zero thresholds are only reached by sites which do not move at all.
+ */
+struct LloydSettings {
+    size_t max_iterations = 100;
+    double max_shift = 0.0;
+    double mean_shift = 0.0;
+};
+
+
+/**
+ Times, in seconds, and shifts of the sites of one iteration.
+ */
+struct LloydIteration {
+    double sweep_time = 0.0;       // building the diagram
+    double centroid_time = 0.0;    // clipping the cells, their centroids and moving the sites
+    double max_shift = 0.0;
+    double mean_shift = 0.0;
+};
+
+
+/**
+ Lloyd relaxation towards a centroidal Voronoi tessellation of `box`.
+
+ Every iteration builds the diagram of the sites and moves each site to the
+ centroid of its cell clipped to the box, computed on the threads of `pool`.
+ The diagram and the scratch memory of the sweep are kept between iterations,
+ and as the sites move a little, the sweep order of the previous iteration is
+ sorted again instead of sorting the sites from scratch (see `reuse_order`).
+ Sites outside the box whose cells miss it stay where they are, and so do
+ repeats of a site in the first iteration, as the first copy moves away and
+ leaves them a cell of their own.
+
+ Returns the number of iterations done. With `report` a LloydIteration is
+ appended for each of them.
+ */
+size_t relax_lloyd(std::vector<Point2D> &points, const BoundingBox &box, ThreadPool &pool,
+                   const LloydSettings &settings = LloydSettings(),
+                   std::vector<LloydIteration> *report = nullptr);
+
+
+/**
+ Same as above, but takes scratch memory from `buffers` and leaves the diagram
+ of the last iteration in `diagram`, which is the diagram of the sites before
+ their last move.
+ */
+size_t relax_lloyd(std::vector<Point2D> &points, const BoundingBox &box, ThreadPool &pool,
+                   bl::FlatDiagram &diagram, SweepBuffers &buffers,
+                   const LloydSettings &settings = LloydSettings(),
+                   std::vector<LloydIteration> *report = nullptr);
+
+
+#endif /* LloydRelaxation_hpp */
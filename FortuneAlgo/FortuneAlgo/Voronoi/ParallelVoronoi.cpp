@@ -0,0 +1,881 @@
+//
+//  ParallelVoronoi.cpp
+//  FortuneAlgo
+//
+
+#include "ParallelVoronoi.hpp"
+#include "ConvexHull.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+
+namespace bl = beachline;
+
+
+// Below this number of sites a single sweep is used
+const size_t PARALLEL_MIN_SITES = 20000;
+
+// Initial margin of ghost sites, in average distances between sites
+const double GHOST_MARGIN = 4.0;
+
+// Sites where the boundary of the convex hull bends inward by less than this are guards too
+const double HULL_TOLERANCE = 1.0e-9;
+
+// Skeleton sites swept with every strip, per square root of the number of sites
+const double SKELETON_DENSITY = 4.0;
+
+// Longer orbits around a vertex mean the stitched halfedges are inconsistent
+const int MAX_VERTEX_DEGREE = 64;
+
+// Relative tolerance of in-circle tests for sites left out of a sweep
+const double INCIRCLE_TOLERANCE = 1.0e-9;
+
+// Grid cells a strip may search for sites left out of its sweep, per owned site
+const size_t SEARCH_BUDGET = 64;
+
+// Sets of a batch are grouped into tasks of at least this many sites
+const size_t BATCH_TASK_SITES = 4096;
+
+
+/**
+ Sites sorted along one of the axes.
+ */
+struct AxisOrder {
+
+    int axis; // 0 - x, 1 - y
+
+    std::vector<int> order;       // indices of the sites in sorted order
+    std::vector<double> coords;   // their coordinates along the axis
+    std::vector<uint32_t> rank;   // position of each site in `order`
+
+    // sorts chunks of the sites on the threads of `pool`, then merges them pairwise
+    void build(const std::vector<Point2D> &points, int _axis, ThreadPool &pool) {
+        axis = _axis;
+        size_t n = points.size(), chunks = pool.size();
+        std::vector<size_t> bounds(chunks + 1);
+        for (size_t k = 0; k <= chunks; ++k) {
+            bounds[k] = k * n / chunks;
+        }
+        auto less = [&](int i, int j) {
+            double ci = coord(points[i]), cj = coord(points[j]);
+            double oi = other(points[i]), oj = other(points[j]);
+            return ci < cj || (ci == cj && (oi < oj || (oi == oj && i < j)));
+        };
+
+        order.resize(n);
+        pool.run(chunks, [&](size_t k, size_t) {
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                order[i] = static_cast<int>(i);
+            }
+            std::sort(order.begin() + bounds[k], order.begin() + bounds[k + 1], less);
+        });
+        for (size_t width = 1; width < chunks; width *= 2) {
+            pool.run((chunks + 2 * width - 1) / (2 * width), [&](size_t m, size_t) {
+                size_t first = 2 * m * width;
+                size_t mid = bounds[std::min(chunks, first + width)], last = bounds[std::min(chunks, first + 2 * width)];
+                std::inplace_merge(order.begin() + bounds[first], order.begin() + mid, order.begin() + last, less);
+            });
+        }
+
+        coords.resize(n);
+        rank.resize(n);
+        pool.run(chunks, [&](size_t k, size_t) {
+            for (size_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+                coords[i] = coord(points[order[i]]);
+                rank[order[i]] = static_cast<uint32_t>(i);
+            }
+        });
+    }
+
+    inline double coord(const Point2D &p) const { return axis == 0 ? p.x : p.y; }
+    inline double other(const Point2D &p) const { return axis == 0 ? p.y : p.x; }
+
+};
+
+
+/**
+ Uniform grid of buckets over the bounding box of the sites.
+ */
+struct SiteGrid {
+
+    double xmin, ymin, cell_w, cell_h;
+    size_t nx, ny;
+
+    // sites of cell (ix, iy) are sites[cell_start[c] .. cell_start[c + 1]), c = iy * nx + ix
+    std::vector<uint32_t> cell_start, sites;
+
+    void build(const std::vector<Point2D> &points, double _xmin, double _ymin, double xmax, double ymax) {
+        xmin = _xmin;
+        ymin = _ymin;
+        double w = std::max(xmax - xmin, Tolerance<double>::point()), h = std::max(ymax - ymin, Tolerance<double>::point());
+        // about two sites per cell
+        double cells = std::max(1.0, 0.5 * points.size());
+        nx = std::max<size_t>(1, static_cast<size_t>(std::sqrt(cells * w / h)));
+        ny = std::max<size_t>(1, static_cast<size_t>(cells / nx));
+        cell_w = w / nx;
+        cell_h = h / ny;
+
+        cell_start.assign(nx * ny + 1, 0);
+        for (const Point2D &p : points) {
+            cell_start[cell(p) + 1]++;
+        }
+        for (size_t c = 0; c < nx * ny; ++c) {
+            cell_start[c + 1] += cell_start[c];
+        }
+        std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+        sites.resize(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            sites[fill[cell(points[i])]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    inline size_t column(double x) const {
+        double c = std::floor((x - xmin) / cell_w);
+        return c < 0.0 ? 0 : std::min(nx - 1, static_cast<size_t>(c));
+    }
+
+    inline size_t row(double y) const {
+        double r = std::floor((y - ymin) / cell_h);
+        return r < 0.0 ? 0 : std::min(ny - 1, static_cast<size_t>(r));
+    }
+
+    inline size_t cell(const Point2D &p) const {
+        return row(p.y) * nx + column(p.x);
+    }
+
+};
+
+
+/**
+ Part of the sites swept on its own.
+ */
+struct Region {
+
+    // sites [owned_begin, owned_end) of the axis order belong to the region,
+    // sites [lo, hi) and the guard sites are swept together with them
+    size_t owned_begin, owned_end, lo, hi;
+
+    // swept sites, owned ones first
+    std::vector<Point2D> local_points;
+    std::vector<int> local_to_global;
+
+    bl::FlatDiagram diagram;
+
+    // owned cells in cycle order, starting from the unbounded edge:
+    // cell i has edges [cell_first[i], cell_first[i] + cell_size[i]), each one
+    // given by the site on its other side and its origin, which is unused for
+    // the first edge of an unbounded cell
+    std::vector<uint32_t> cell_first, cell_size, edge_site;
+    std::vector<double> edge_x, edge_y;
+    std::vector<char> cell_bounded;
+
+    bool broken;
+    size_t failed_cells, foreign_sites, search_budget;
+
+    inline size_t owned_num() const { return owned_end - owned_begin; }
+
+};
+
+
+/**
+ Shared read-only data of one parallel build.
+ */
+struct ParallelContext {
+    const std::vector<Point2D> *points;
+    AxisOrder order;
+    SiteGrid grid;
+    double margin;
+
+    // vertices of the convex hull and a sparse skeleton of all the sites,
+    // swept with every region
+    std::vector<int> guards;
+    std::vector<char> is_guard;
+};
+
+
+/**
+ Vertex of a cell being clipped, `site` is on the other side
+ of the edge starting at the vertex.
+ */
+struct ClipVertex {
+    Point2D point;
+    int site;
+};
+
+// Edge closing an unbounded cell far away
+const int FAR_EDGE = -1;
+
+
+/**
+ Lowest index among the sites at the same point as the site at position `r` of the order.
+ Equal points are next to each other in the order, lowest index first, and the cell
+ belongs to that site in the diagram of all the sites.
+ */
+static int firstCopy(const std::vector<Point2D> &points, const AxisOrder &order, size_t r) {
+    const Point2D &p = points[order.order[r]];
+    while (r > 0 && points[order.order[r - 1]].x == p.x && points[order.order[r - 1]].y == p.y) {
+        --r;
+    }
+    return order.order[r];
+}
+
+
+static void sweepRegion(const ParallelContext &ctx, Region &region, SweepBuffers &buffers) {
+    const std::vector<Point2D> &points = *ctx.points;
+    const AxisOrder &order = ctx.order;
+
+    region.local_points.clear();
+    region.local_to_global.clear();
+
+    // repeats of a site are swept as its first copy, so when the copies are split
+    // between the owned and the ghost sites the cell still goes to the right one
+    auto add_range = [&](size_t begin, size_t end) {
+        int copy = -1;
+        for (size_t i = begin; i < end; ++i) {
+            const Point2D &p = points[order.order[i]];
+            if (copy < 0 || p.x != points[copy].x || p.y != points[copy].y) {
+                copy = firstCopy(points, order, i);
+            }
+            region.local_points.push_back(p);
+            region.local_to_global.push_back(copy);
+        }
+    };
+
+    add_range(region.owned_begin, region.owned_end);
+    add_range(region.lo, region.owned_begin);
+    add_range(region.owned_end, region.hi);
+    // with all the hull vertices the unbounded cells stay unbounded in the same directions,
+    // the skeleton keeps the cells at the sides of the strip small
+    for (int site : ctx.guards) {
+        uint32_t r = order.rank[site];
+        if (r < region.lo || r >= region.hi) {
+            region.local_points.push_back(points[site]);
+            region.local_to_global.push_back(site);
+        }
+    }
+
+    build_voronoi(region.local_points, region.diagram, buffers);
+}
+
+
+enum CircleCheck { CIRCLE_EMPTY, CIRCLE_HAS_SITES, CIRCLE_TOO_LARGE };
+
+
+/**
+ Find sites left out of the region's sweep that lie inside the circle around `center`
+ passing through `site` and append them to `found`. Every grid cell searched is taken
+ from the region's budget.
+ */
+static CircleCheck findForeignSites(const ParallelContext &ctx, Region &region, const Point2D &site,
+                                    const Point2D &center, double r2, std::vector<int> &found) {
+    const std::vector<Point2D> &points = *ctx.points;
+    const SiteGrid &grid = ctx.grid;
+    const AxisOrder &order = ctx.order;
+
+    // band along the axis where all the sites are swept
+    double band_lo = region.lo > 0 ? order.coords[region.lo - 1] : -Point2D::Inf;
+    double band_hi = region.hi < order.coords.size() ? order.coords[region.hi] : Point2D::Inf;
+
+    double r = std::sqrt(r2);
+    double fx = site.x - center.x, fy = site.y - center.y;
+    size_t found_before = found.size();
+
+    size_t ix0 = grid.column(center.x - r), ix1 = grid.column(center.x + r);
+    for (size_t ix = ix0; ix <= ix1; ++ix) {
+        double x0 = grid.xmin + ix * grid.cell_w, x1 = x0 + grid.cell_w;
+        if (order.axis == 0 && x0 > band_lo && x1 < band_hi) {
+            continue;
+        }
+        double dx = center.x < x0 ? x0 - center.x : (center.x > x1 ? center.x - x1 : 0.0);
+        if (dx * dx > r2) {
+            continue;
+        }
+        double hy = std::sqrt(r2 - dx * dx);
+        size_t iy0 = grid.row(center.y - hy), iy1 = grid.row(center.y + hy);
+        for (size_t iy = iy0; iy <= iy1; ++iy) {
+            if (order.axis == 1) {
+                double y0 = grid.ymin + iy * grid.cell_h, y1 = y0 + grid.cell_h;
+                if (y0 > band_lo && y1 < band_hi) {
+                    continue;
+                }
+            }
+            if (region.search_budget == 0) {
+                return CIRCLE_TOO_LARGE;
+            }
+            region.search_budget--;
+            size_t c = iy * grid.nx + ix;
+            for (uint32_t k = grid.cell_start[c]; k < grid.cell_start[c + 1]; ++k) {
+                uint32_t other = grid.sites[k];
+                uint32_t rank = order.rank[other];
+                if ((rank >= region.lo && rank < region.hi) || ctx.is_guard[other]) {
+                    continue;
+                }
+                // difference of squared distances to the center, computed without
+                // cancellation when the circle is much larger than the cell
+                double ex = points[other].x - site.x, ey = points[other].y - site.y;
+                double e2 = ex * ex + ey * ey;
+                double power = e2 + 2.0 * (ex * fx + ey * fy);
+                if (power < -INCIRCLE_TOLERANCE * (e2 + 2.0 * std::sqrt(e2) * r)) {
+                    // all the copies of a site cut the cell once, by the one keeping its cell
+                    found.push_back(firstCopy(points, order, rank));
+                }
+            }
+        }
+    }
+    return found.size() > found_before ? CIRCLE_HAS_SITES : CIRCLE_EMPTY;
+}
+
+
+/**
+ Cut the cell of `site` by the half-plane of points closer to it than to `other`.
+ */
+static void clipCell(const Point2D &site, const Point2D &other, int other_site,
+                     const std::vector<ClipVertex> &cell, std::vector<ClipVertex> &clipped) {
+    Point2D mid = (site + other) * 0.5, dir = other - site;
+    auto side = [&](const Point2D &p) {
+        return (p.x - mid.x) * dir.x + (p.y - mid.y) * dir.y;
+    };
+
+    clipped.clear();
+    size_t size = cell.size();
+    for (size_t i = 0; i < size; ++i) {
+        const ClipVertex &cur = cell[i], &next = cell[i + 1 < size ? i + 1 : 0];
+        double sc = side(cur.point), sn = side(next.point);
+        if (sc <= 0.0) {
+            clipped.push_back(cur);
+        }
+        if ((sc <= 0.0) != (sn <= 0.0)) {
+            Point2D p = cur.point + (next.point - cur.point) * (sc / (sc - sn));
+            // leaving the half-plane starts the edge shared with `other`
+            clipped.push_back({p, sc <= 0.0 ? other_site : cur.site});
+        }
+    }
+}
+
+
+/**
+ Walk the local cell of owned site `i`. Returns false if it is not
+ a single cycle or a single chain of halfedges starting from infinity.
+ */
+static bool walkCell(const Region &region, uint32_t i, std::vector<uint32_t> &edges, bool &bounded) {
+    const bl::FlatDiagram &d = region.diagram;
+    edges.clear();
+    bounded = true;
+
+    // sites coinciding with other sites have no cell
+    uint32_t start = d.faces[i];
+    if (start == bl::NO_INDEX) {
+        return true;
+    }
+    uint32_t h = start;
+    do {
+        if (d.l_site[h] != i || edges.size() > d.halfedges_num()) {
+            return false;
+        }
+        edges.push_back(h);
+        h = d.next[h];
+    } while (h != bl::NO_INDEX && h != start);
+
+    bounded = h != bl::NO_INDEX;
+    // faces[i] is the first halfedge of the chain if the cell is unbounded
+    return bounded || (d.prev[start] == bl::NO_INDEX && edges.size() >= 2);
+}
+
+
+/**
+ Output owned cells of the region. A cell is the same as in the diagram of all
+ the sites if the circles of its vertices have no sites left out of the sweep.
+ Otherwise the sites inside these circles are the only ones missing among its
+ neighbours, and the cell is cut by their bisectors.
+ Cells are visited in the order of the sweep, which created their halfedges.
+ */
+static void certifyRegion(const ParallelContext &ctx, Region &region, const std::vector<int> &sweep_order) {
+    const std::vector<Point2D> &points = *ctx.points;
+    const bl::FlatDiagram &d = region.diagram;
+    const AxisOrder &order = ctx.order;
+
+    double band_lo = region.lo > 0 ? order.coords[region.lo - 1] : -Point2D::Inf;
+    double band_hi = region.hi < order.coords.size() ? order.coords[region.hi] : Point2D::Inf;
+
+    size_t owned = region.owned_num();
+    region.cell_first.resize(owned);
+    region.cell_size.resize(owned);
+    region.cell_bounded.resize(owned);
+    region.edge_site.clear();
+    region.edge_x.clear();
+    region.edge_y.clear();
+    region.broken = false;
+    region.failed_cells = 0;
+    region.foreign_sites = 0;
+    region.search_budget = SEARCH_BUDGET * owned + 1024;
+
+    std::vector<uint32_t> edges;
+    std::vector<int> found;
+    std::vector<ClipVertex> cell, clipped;
+
+    auto output = [&](uint32_t site, double x, double y) {
+        region.edge_site.push_back(site);
+        region.edge_x.push_back(x);
+        region.edge_y.push_back(y);
+    };
+
+    for (int local : sweep_order) {
+        if (static_cast<size_t>(local) >= owned) {
+            continue;
+        }
+        uint32_t i = static_cast<uint32_t>(local);
+        region.cell_first[i] = static_cast<uint32_t>(region.edge_site.size());
+        // the cell of a repeated site is output by the region owning its first copy
+        if (region.local_to_global[i] != order.order[region.owned_begin + i]) {
+            region.cell_bounded[i] = true;
+            region.cell_size[i] = 0;
+            continue;
+        }
+        bool bounded;
+        if (!walkCell(region, i, edges, bounded)) {
+            region.broken = true;
+            return;
+        }
+        region.cell_bounded[i] = bounded;
+
+        const Point2D &site = region.local_points[i];
+        found.clear();
+        double reach = 0.0;
+        for (uint32_t h : edges) {
+            uint32_t v = d.origin[h];
+            if (v == bl::NO_INDEX) {
+                continue;
+            }
+            Point2D center(d.vx[v], d.vy[v]);
+            double dx = center.x - site.x, dy = center.y - site.y;
+            double r2 = dx * dx + dy * dy, r = std::sqrt(r2);
+            double c = order.coord(center);
+            reach = std::max(reach, r);
+            if (c - r > band_lo && c + r < band_hi) {
+                continue;
+            }
+            if (findForeignSites(ctx, region, site, center, r2, found) == CIRCLE_TOO_LARGE) {
+                region.broken = true;
+                return;
+            }
+        }
+
+        if (found.empty()) {
+            for (uint32_t h : edges) {
+                uint32_t v = d.origin[h];
+                uint32_t other = region.local_to_global[d.r_site[h]];
+                output(other, v == bl::NO_INDEX ? 0.0 : d.vx[v], v == bl::NO_INDEX ? 0.0 : d.vy[v]);
+            }
+            region.cell_size[i] = static_cast<uint32_t>(edges.size());
+            continue;
+        }
+
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        region.failed_cells++;
+        region.foreign_sites += found.size();
+
+        cell.clear();
+        for (uint32_t h : edges) {
+            uint32_t v = d.origin[h];
+            int other = region.local_to_global[d.r_site[h]];
+            if (v != bl::NO_INDEX) {
+                cell.push_back({Point2D(d.vx[v], d.vy[v]), other});
+            } else {
+                cell.push_back({Point2D(), other});
+            }
+        }
+        // unbounded cell is closed by an edge between the far ends of its rays,
+        // which are inside all the half-planes it is cut by
+        Point2D far_in, far_out;
+        if (!bounded) {
+            auto direction = [&](int other) {
+                // halfedges go with their own site on the left
+                Point2D dir = points[other] - site;
+                return Point2D(-dir.y, dir.x) / dir.norm();
+            };
+            const Point2D &first_vertex = cell[1].point, &last_vertex = cell.back().point;
+            Point2D ray_in = -direction(cell.front().site), ray_out = direction(cell.back().site);
+            double far_in_t = reach + 1.0, far_out_t = reach + 1.0;
+            for (int s : found) {
+                Point2D mid = (site + points[s]) * 0.5, e = points[s] - site;
+                double in_slope = ray_in.x * e.x + ray_in.y * e.y, out_slope = ray_out.x * e.x + ray_out.y * e.y;
+                if (in_slope >= 0.0 || out_slope >= 0.0) {
+                    region.broken = true;
+                    return;
+                }
+                far_in_t = std::max(far_in_t, 2.0 * ((first_vertex.x - mid.x) * e.x + (first_vertex.y - mid.y) * e.y) / -in_slope);
+                far_out_t = std::max(far_out_t, 2.0 * ((last_vertex.x - mid.x) * e.x + (last_vertex.y - mid.y) * e.y) / -out_slope);
+            }
+            far_in = first_vertex + ray_in * far_in_t;
+            far_out = last_vertex + ray_out * far_out_t;
+            cell.front().point = far_in;
+            cell.push_back({far_out, FAR_EDGE});
+        }
+
+        for (int s : found) {
+            clipCell(site, points[s], s, cell, clipped);
+            cell.swap(clipped);
+        }
+
+        size_t size = cell.size(), first = 0;
+        if (!bounded) {
+            // the far edge has to survive untouched
+            size_t far_edge = size;
+            for (size_t k = 0; k < size; ++k) {
+                if (cell[k].site == FAR_EDGE) {
+                    far_edge = k;
+                }
+            }
+            first = far_edge + 1 < size ? far_edge + 1 : 0;
+            auto same = [](const Point2D &p1, const Point2D &p2) { return p1.x == p2.x && p1.y == p2.y; };
+            if (far_edge == size || !same(cell[far_edge].point, far_out) || !same(cell[first].point, far_in)) {
+                region.broken = true;
+                return;
+            }
+            --size;
+        }
+        if (size < (bounded ? 3u : 2u)) {
+            region.broken = true;
+            return;
+        }
+        for (size_t k = 0; k < size; ++k) {
+            const ClipVertex &vertex = cell[(first + k) % cell.size()];
+            output(vertex.site, vertex.point.x, vertex.point.y);
+        }
+        region.cell_size[i] = static_cast<uint32_t>(size);
+    }
+}
+
+
+/**
+ Smallest index among the halfedges going out of the origin of `h`.
+ Returns NO_INDEX if the halfedges around the vertex do not form a cycle.
+ */
+static uint32_t orbitOwner(const bl::FlatDiagram &d, uint32_t h) {
+    uint32_t owner = h, g = h;
+    for (int steps = 0; steps < MAX_VERTEX_DEGREE; ++steps) {
+        uint32_t p = d.prev[g];
+        if (p == bl::NO_INDEX) {
+            return bl::NO_INDEX;
+        }
+        g = d.twin[p];
+        if (g == h) {
+            return owner;
+        }
+        owner = std::min(owner, g);
+    }
+    return bl::NO_INDEX;
+}
+
+
+/**
+ Join owned cells of all the regions into one diagram.
+ Returns false if the regions disagree on the shared edges or vertices.
+ */
+static bool stitchRegions(const ParallelContext &ctx, std::vector<Region> &regions,
+                          bl::FlatDiagram &diagram, ThreadPool &pool) {
+    const AxisOrder &order = ctx.order;
+    size_t n = ctx.points->size(), regions_num = regions.size();
+
+    // halfedges of region k are [offsets[k], offsets[k + 1])
+    std::vector<uint32_t> offsets(regions_num + 1, 0);
+    for (size_t k = 0; k < regions_num; ++k) {
+        size_t total = offsets[k] + regions[k].edge_site.size();
+        if (total >= bl::NO_INDEX) {
+            return false;
+        }
+        offsets[k + 1] = static_cast<uint32_t>(total);
+    }
+    size_t halfedges_num = offsets[regions_num];
+
+    // cell of site s is [first[s], first[s] + count[s])
+    std::vector<uint32_t> first(n), count(n);
+
+    diagram.clear();
+    diagram.twin.assign(halfedges_num, bl::NO_INDEX);
+    diagram.next.resize(halfedges_num);
+    diagram.prev.resize(halfedges_num);
+    diagram.origin.assign(halfedges_num, bl::NO_INDEX);
+    diagram.l_site.resize(halfedges_num);
+    diagram.r_site.resize(halfedges_num);
+    diagram.faces.resize(n);
+
+    std::atomic<bool> consistent(true);
+
+    // copy cells
+    pool.run(regions_num, [&](size_t k, size_t) {
+        const Region &region = regions[k];
+        for (size_t i = 0; i < region.owned_num(); ++i) {
+            uint32_t s = static_cast<uint32_t>(order.order[region.owned_begin + i]);
+            uint32_t b = region.cell_first[i], size = region.cell_size[i];
+            uint32_t base = offsets[k] + b;
+            bool bounded = region.cell_bounded[i];
+            first[s] = base;
+            count[s] = size;
+            diagram.faces[s] = size > 0 ? base : bl::NO_INDEX;
+            for (uint32_t j = 0; j < size; ++j) {
+                uint32_t h = base + j;
+                diagram.l_site[h] = s;
+                diagram.r_site[h] = region.edge_site[b + j];
+                diagram.next[h] = j + 1 < size ? h + 1 : (bounded ? base : bl::NO_INDEX);
+                diagram.prev[h] = j > 0 ? h - 1 : (bounded ? base + size - 1 : bl::NO_INDEX);
+            }
+        }
+    });
+
+    // find twins in the cells of neighbours
+    pool.run(regions_num, [&](size_t k, size_t) {
+        for (uint32_t h = offsets[k]; h < offsets[k + 1]; ++h) {
+            uint32_t s = diagram.l_site[h], t = diagram.r_site[h];
+            for (uint32_t g = first[t]; g < first[t] + count[t]; ++g) {
+                if (diagram.r_site[g] == s) {
+                    diagram.twin[h] = g;
+                    break;
+                }
+            }
+            if (diagram.twin[h] == bl::NO_INDEX) {
+                consistent = false;
+                return;
+            }
+        }
+    });
+    if (!consistent) {
+        return false;
+    }
+
+    // a vertex is created by the smallest halfedge going out of it
+    std::vector<uint32_t> vertex_offsets(regions_num + 1, 0);
+    pool.run(regions_num, [&](size_t k, size_t) {
+        uint32_t owners = 0;
+        for (uint32_t h = offsets[k]; h < offsets[k + 1]; ++h) {
+            if (diagram.twin[diagram.twin[h]] != h) {
+                consistent = false;
+                return;
+            }
+            if (diagram.prev[h] == bl::NO_INDEX) {
+                continue;
+            }
+            uint32_t owner = orbitOwner(diagram, h);
+            if (owner == bl::NO_INDEX) {
+                consistent = false;
+                return;
+            }
+            owners += owner == h;
+        }
+        vertex_offsets[k + 1] = owners;
+    });
+    if (!consistent) {
+        return false;
+    }
+    for (size_t k = 0; k < regions_num; ++k) {
+        vertex_offsets[k + 1] += vertex_offsets[k];
+    }
+    diagram.vx.resize(vertex_offsets[regions_num]);
+    diagram.vy.resize(vertex_offsets[regions_num]);
+
+    auto origin_of = [&](uint32_t h) {
+        size_t k = std::upper_bound(offsets.begin(), offsets.end(), h) - offsets.begin() - 1;
+        return Point2D(regions[k].edge_x[h - offsets[k]], regions[k].edge_y[h - offsets[k]]);
+    };
+
+    pool.run(regions_num, [&](size_t k, size_t) {
+        uint32_t v = vertex_offsets[k];
+        for (uint32_t h = offsets[k]; h < offsets[k + 1]; ++h) {
+            if (diagram.prev[h] == bl::NO_INDEX || orbitOwner(diagram, h) != h) {
+                continue;
+            }
+            Point2D p = origin_of(h);
+            diagram.vx[v] = p.x;
+            diagram.vy[v] = p.y;
+
+            // all the cells around the vertex must have it at the same place
+            double tolerance = Tolerance<double>::point() * (1.0 + fabs(p.x) + fabs(p.y));
+            uint32_t g = h;
+            do {
+                Point2D q = origin_of(g);
+                if (fabs(q.x - p.x) > tolerance || fabs(q.y - p.y) > tolerance) {
+                    consistent = false;
+                }
+                diagram.origin[g] = v;
+                g = diagram.twin[diagram.prev[g]];
+            } while (g != h);
+            ++v;
+        }
+    });
+
+    return consistent;
+}
+
+
+/**
+ Split the sites into `regions_num` strips along `axis`, sweep them
+ on the threads of `pool` and stitch the certified cells together.
+ */
+static void buildInStrips(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                          ThreadPool &pool, int axis, size_t regions_num, ParallelStats *stats_out) {
+
+    ParallelStats stats;
+    size_t n = points.size();
+    std::vector<SweepBuffers> buffers(pool.size());
+
+    if (regions_num < 2 || n < PARALLEL_MIN_SITES) {
+        stats.serial_fallback = true;
+        build_voronoi(points, diagram, buffers[0]);
+        if (stats_out != nullptr) {
+            *stats_out = stats;
+        }
+        return;
+    }
+
+    ParallelContext ctx;
+    ctx.points = &points;
+    ctx.order.build(points, axis, pool);
+
+    double xmin = Point2D::Inf, xmax = -Point2D::Inf;
+    double ymin = Point2D::Inf, ymax = -Point2D::Inf;
+    for (const Point2D &p : points) {
+        xmin = std::min(xmin, p.x);
+        xmax = std::max(xmax, p.x);
+        ymin = std::min(ymin, p.y);
+        ymax = std::max(ymax, p.y);
+    }
+    ctx.grid.build(points, xmin, ymin, xmax, ymax);
+    ctx.margin = GHOST_MARGIN * std::sqrt(std::max(xmax - xmin, Tolerance<double>::point()) * std::max(ymax - ymin, Tolerance<double>::point()) / n);
+
+    // guard sites: hull vertices and the first site in each block of grid cells,
+    // a repeated site is replaced by its first copy, which keeps the cell
+    ctx.is_guard.assign(n, 0);
+    auto add_guard = [&](int site) {
+        site = firstCopy(points, ctx.order, ctx.order.rank[site]);
+        if (!ctx.is_guard[site]) {
+            ctx.is_guard[site] = 1;
+            ctx.guards.push_back(site);
+        }
+    };
+    for (int site : findConvexHull(points, ctx.order.order, HULL_TOLERANCE)) {
+        add_guard(site);
+    }
+    const SiteGrid &grid = ctx.grid;
+    size_t block = std::max<size_t>(1, std::lround(std::sqrt(std::sqrt(static_cast<double>(n)) / (2.0 * SKELETON_DENSITY))));
+    for (size_t by = 0; by < grid.ny; by += block) {
+        for (size_t bx = 0; bx < grid.nx; bx += block) {
+            int site = -1;
+            for (size_t iy = by; iy < std::min(grid.ny, by + block) && site < 0; ++iy) {
+                for (size_t ix = bx; ix < std::min(grid.nx, bx + block) && site < 0; ++ix) {
+                    size_t c = iy * grid.nx + ix;
+                    if (grid.cell_start[c] < grid.cell_start[c + 1]) {
+                        site = grid.sites[grid.cell_start[c]];
+                    }
+                }
+            }
+            if (site >= 0) {
+                add_guard(site);
+            }
+        }
+    }
+
+    // strips with equal number of sites
+    const std::vector<double> &coords = ctx.order.coords;
+    std::vector<Region> regions(regions_num);
+    for (size_t k = 0; k < regions_num; ++k) {
+        Region &region = regions[k];
+        region.owned_begin = k * n / regions_num;
+        region.owned_end = (k + 1) * n / regions_num;
+        region.lo = std::lower_bound(coords.begin(), coords.end(), coords[region.owned_begin] - ctx.margin) - coords.begin();
+        region.hi = std::upper_bound(coords.begin(), coords.end(), coords[region.owned_end - 1] + ctx.margin) - coords.begin();
+    }
+    stats.regions = regions_num;
+
+    pool.run(regions_num, [&](size_t k, size_t worker) {
+        sweepRegion(ctx, regions[k], buffers[worker]);
+        certifyRegion(ctx, regions[k], buffers[worker].sites);
+    });
+
+    bool ok = true;
+    for (const Region &region : regions) {
+        stats.ghost_sites += region.local_points.size() - region.owned_num();
+        stats.failed_cells += region.failed_cells;
+        stats.foreign_sites += region.foreign_sites;
+        ok = ok && !region.broken;
+    }
+
+    if (!ok || !stitchRegions(ctx, regions, diagram, pool)) {
+        stats.serial_fallback = true;
+        build_voronoi(points, diagram, buffers[0]);
+    }
+
+    if (stats_out != nullptr) {
+        *stats_out = stats;
+    }
+}
+
+
+void build_voronoi_parallel(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                            ThreadPool &pool, ParallelStats *stats) {
+    buildInStrips(points, diagram, pool, 0, pool.size(), stats);
+}
+
+
+void build_voronoi_halves(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                          ThreadPool &pool, ParallelStats *stats) {
+    buildInStrips(points, diagram, pool, 1, 2, stats);
+}
+
+
+void build_voronoi_parallel(const std::vector<Point2D> &points,
+                            std::vector<bl::HalfEdgePtr> &halfedges,
+                            std::vector<bl::VertexPtr> &vertices,
+                            std::vector<bl::HalfEdgePtr> &faces,
+                            ThreadPool &pool, ParallelStats *stats) {
+    bl::FlatDiagram diagram;
+    build_voronoi_parallel(points, diagram, pool, stats);
+    bl::make_pointer_dcel(diagram, halfedges, vertices, faces);
+}
+
+
+void build_voronoi_batch(const PointSet *sets, size_t sets_n, bl::FlatDiagram *diagrams,
+                         ThreadPool &pool, std::vector<SweepBuffers> &buffers, SweepStats *stats) {
+    buffers.resize(pool.size());
+
+    // largest sets first, the last tasks are small and even out the workers
+    std::vector<uint32_t> order(sets_n);
+    for (size_t i = 0; i < sets_n; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [sets](uint32_t a, uint32_t b) {
+        return sets[a].size > sets[b].size;
+    });
+    std::vector<size_t> task_begin;
+    size_t task_sites = BATCH_TASK_SITES;
+    for (size_t k = 0; k < sets_n; ++k) {
+        if (task_sites >= BATCH_TASK_SITES) {
+            task_begin.push_back(k);
+            task_sites = 0;
+        }
+        task_sites += sets[order[k]].size;
+    }
+    task_begin.push_back(sets_n);
+
+    pool.run(task_begin.size() - 1, [&](size_t task, size_t worker) {
+        for (size_t k = task_begin[task]; k < task_begin[task + 1]; ++k) {
+            uint32_t i = order[k];
+            build_voronoi(sets[i].points, sets[i].size, diagrams[i], buffers[worker],
+                          stats != nullptr ? &stats[i] : nullptr);
+        }
+    });
+}
+
+
+void build_voronoi_batch(const std::vector<std::vector<Point2D>> &sets,
+                         std::vector<bl::FlatDiagram> &diagrams, ThreadPool &pool,
+                         std::vector<SweepBuffers> &buffers) {
+    std::vector<PointSet> spans(sets.size());
+    for (size_t i = 0; i < sets.size(); ++i) {
+        spans[i] = {sets[i].data(), sets[i].size()};
+    }
+    diagrams.resize(sets.size());
+    build_voronoi_batch(spans.data(), spans.size(), diagrams.data(), pool, buffers);
+}
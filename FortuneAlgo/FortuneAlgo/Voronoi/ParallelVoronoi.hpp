@@ -0,0 +1,95 @@
+//
+//  ParallelVoronoi.hpp
+//  FortuneAlgo
+//
+
+#ifndef ParallelVoronoi_hpp
+#define ParallelVoronoi_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+#include "ThreadPool.hpp"
+
+
+/**
+ Counters of a parallel build.
+ */
+struct ParallelStats {
+    size_t regions = 0;          // number of strips the sites were split into
+    size_t ghost_sites = 0;      // sites swept outside their own strip, over all strips
+    size_t failed_cells = 0;     // cells that failed certification and were cut
+    size_t foreign_sites = 0;    // sites the failed cells were cut by
+    bool serial_fallback = false;
+};
+
+
+/**
+ Build Voronoi diagram on the threads of `pool`.
+
+ Sites are split into strips of equal size along x. Each strip is swept
+ on its own together with a margin of ghost sites from the neighbouring
+ strips, the vertices of the global convex hull and a sparse skeleton of
+ all the sites. A cell of the strip is certified when no site left out of
+ the sweep lies inside the circle of any of its vertices, which means the
+ cell is the same as in the diagram of all the sites. Other cells are cut
+ by the bisectors of the sites found inside their circles, then the cells
+ of all the strips are stitched together. If the strips do not agree on
+ the shared edges, the diagram is built by a single sweep instead.
+ Repeats of a site get empty cells, as with `build_voronoi`, in every strip.
+ */
+void build_voronoi_parallel(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                            ThreadPool &pool, ParallelStats *stats = nullptr);
+
+
+/**
+ Build Voronoi diagram on two threads of `pool`, one for the sites below
+ the median y and one for the sites above it. The halves are swept, certified
+ and stitched along the middle line the same way as the strips above.
+ */
+void build_voronoi_halves(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                          ThreadPool &pool, ParallelStats *stats = nullptr);
+
+
+/**
+ Same as `build_voronoi_parallel` above, with the output converted to pointer-based records.
+ */
+void build_voronoi_parallel(const std::vector<Point2D> &points,
+                            std::vector<bl::HalfEdgePtr> &halfedges,
+                            std::vector<bl::VertexPtr> &vertices,
+                            std::vector<bl::HalfEdgePtr> &faces,
+                            ThreadPool &pool, ParallelStats *stats = nullptr);
+
+
+
+/**
+ Sites of one diagram of a batch, stored in memory the caller owns.
+ */
+struct PointSet {
+    const Point2D *points;
+    size_t size;
+};
+
+
+/**
+ Build the diagrams of `sets_n` independent sets of sites on the threads of
+ `pool`, diagrams[i] of sets[i], each by a single sweep. Sets are handed out
+ to the workers largest first, small ones a few at a time, so a worker which
+ finishes early takes the next set and the workers finish together.
+ Every worker sweeps with its own buffers[worker], `buffers` is resized to
+ the size of the pool and keeps its memory between batches.
+ With `stats`, stats[i] receives the counters of the sweep of sets[i].
+ */
+void build_voronoi_batch(const PointSet *sets, size_t sets_n, bl::FlatDiagram *diagrams,
+                         ThreadPool &pool, std::vector<SweepBuffers> &buffers,
+                         SweepStats *stats = nullptr);
+
+
+/**
+ Same as above for sets stored as vectors, `diagrams` is resized to their number.
+ */
+void build_voronoi_batch(const std::vector<std::vector<Point2D>> &sets,
+                         std::vector<bl::FlatDiagram> &diagrams, ThreadPool &pool,
+                         std::vector<SweepBuffers> &buffers);
+
+
+#endif /* ParallelVoronoi_hpp */
@@ -0,0 +1,216 @@
+//
+//  PointLocator.cpp
+//  FortuneAlgo
+//
+
+#include "PointLocator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Average number of sites in a bucket of the grid
+const double SITES_PER_BUCKET = 1.0;
+
+// Queries located by one task of a batch
+const size_t QUERIES_PER_TASK = 4096;
+
+
+static inline double distance2(const Point2D &a, const Point2D &b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+
+PointLocator::PointLocator() : grid_scale(0.0), grid_side(0) {}
+
+
+void PointLocator::build(const Point2D *input, size_t points_n, const bl::FlatDiagram &diagram) {
+    points.clear();
+    site_index.clear();
+    neighbours_begin.clear();
+    neighbours.clear();
+    seeds.clear();
+    grid_side = 0;
+
+    // sites coinciding with other sites have no cell, unless all the sites are the same
+    std::vector<bool> has_cell(points_n, false);
+    size_t sites_n = 0;
+    for (size_t s = 0; s < points_n && s < diagram.faces.size(); ++s) {
+        if (diagram.faces[s] != bl::NO_INDEX) {
+            has_cell[s] = true;
+            sites_n++;
+        }
+    }
+    if (sites_n == 0 && points_n > 0) {
+        has_cell[0] = true;
+        sites_n = 1;
+    }
+    auto isEdge = [&](uint32_t h) {
+        return diagram.twin[h] != bl::NO_INDEX && has_cell[diagram.l_site[h]] && has_cell[diagram.r_site[h]];
+    };
+    std::vector<uint32_t> degree(points_n, 0);
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        if (isEdge(h)) {
+            degree[diagram.l_site[h]]++;
+        }
+    }
+
+    Point2D grid_max;
+    bool first = true;
+    for (size_t s = 0; s < points_n; ++s) {
+        if (!has_cell[s]) {
+            continue;
+        }
+        const Point2D &p = input[s];
+        if (first) {
+            grid_min = grid_max = p;
+            first = false;
+        }
+        grid_min.x = std::min(grid_min.x, p.x);
+        grid_min.y = std::min(grid_min.y, p.y);
+        grid_max.x = std::max(grid_max.x, p.x);
+        grid_max.y = std::max(grid_max.y, p.y);
+    }
+    if (sites_n == 0) {
+        return;
+    }
+    double extent = std::max(grid_max.x - grid_min.x, grid_max.y - grid_min.y);
+    grid_side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(sites_n / SITES_PER_BUCKET)));
+    grid_scale = extent > 0.0 ? grid_side / extent : 0.0;
+
+    // positions of the sites, counting sort by bucket
+    std::vector<uint32_t> bucket_begin(grid_side * grid_side + 1, 0);
+    for (size_t s = 0; s < points_n; ++s) {
+        if (has_cell[s]) {
+            bucket_begin[bucket(input[s]) + 1]++;
+        }
+    }
+    for (size_t k = 1; k < bucket_begin.size(); ++k) {
+        bucket_begin[k] += bucket_begin[k - 1];
+    }
+    std::vector<uint32_t> position(points_n, bl::NO_INDEX);
+    points.resize(sites_n);
+    site_index.resize(sites_n);
+    for (size_t s = 0; s < points_n; ++s) {
+        if (has_cell[s]) {
+            uint32_t i = bucket_begin[bucket(input[s])]++;
+            position[s] = i;
+            points[i] = input[s];
+            site_index[i] = static_cast<uint32_t>(s);
+        }
+    }
+
+    // neighbours across the halfedges of every cell
+    neighbours_begin.assign(sites_n + 1, 0);
+    for (uint32_t i = 0; i < sites_n; ++i) {
+        neighbours_begin[i + 1] = neighbours_begin[i] + degree[site_index[i]];
+    }
+    neighbours.resize(neighbours_begin.back());
+    std::vector<uint32_t> filled(neighbours_begin.begin(), neighbours_begin.end() - 1);
+    for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+        if (isEdge(h)) {
+            neighbours[filled[position[diagram.l_site[h]]]++] = position[diagram.r_site[h]];
+        }
+    }
+
+    // seeds, walking from bucket to bucket row by row, back and forth
+    seeds.resize(grid_side * grid_side);
+    double bucket_size = grid_scale > 0.0 ? 1.0 / grid_scale : 0.0;
+    uint32_t seed = 0;
+    for (size_t j = 0; j < grid_side; ++j) {
+        for (size_t c = 0; c < grid_side; ++c) {
+            size_t i = j % 2 == 0 ? c : grid_side - 1 - c;
+            Point2D centre(grid_min.x + (i + 0.5) * bucket_size, grid_min.y + (j + 0.5) * bucket_size);
+            seed = walk(seed, centre);
+            seeds[j * grid_side + i] = seed;
+        }
+    }
+}
+
+
+size_t PointLocator::bucket(const Point2D &point) const {
+    double column = (point.x - grid_min.x) * grid_scale, row = (point.y - grid_min.y) * grid_scale;
+    size_t max_index = grid_side - 1;
+    size_t i = column <= 0.0 ? 0 : std::min(static_cast<size_t>(column), max_index);
+    size_t j = row <= 0.0 ? 0 : std::min(static_cast<size_t>(row), max_index);
+    return j * grid_side + i;
+}
+
+
+uint32_t PointLocator::walk(uint32_t from, const Point2D &point) const {
+    uint32_t site = from;
+    double best = distance2(points[site], point);
+    for (uint32_t current = bl::NO_INDEX; current != site; ) {
+        current = site;
+        for (uint32_t k = neighbours_begin[current]; k < neighbours_begin[current + 1]; ++k) {
+            uint32_t neighbour = neighbours[k];
+            double d = distance2(points[neighbour], point);
+            if (d < best) {
+                best = d;
+                site = neighbour;
+            }
+        }
+    }
+    return site;
+}
+
+
+uint32_t PointLocator::locate(const Point2D &point) const {
+    if (points.empty()) {
+        return bl::NO_INDEX;
+    }
+    return site_index[walk(seeds[bucket(point)], point)];
+}
+
+
+void PointLocator::locate(const Point2D *queries, size_t queries_n, uint32_t *sites,
+                          ThreadPool &pool, bool sorted) const {
+    if (points.empty()) {
+        std::fill(sites, sites + queries_n, bl::NO_INDEX);
+        return;
+    }
+    size_t tasks_n = (queries_n + QUERIES_PER_TASK - 1) / QUERIES_PER_TASK;
+
+    // copy of the queries in the order of their buckets, counting sort
+    std::vector<Point2D> sorted_queries;
+    std::vector<uint32_t> order;
+    if (!sorted) {
+        std::vector<uint32_t> keys(queries_n);
+        pool.run(tasks_n, [&](size_t task, size_t) {
+            size_t end = std::min(queries_n, (task + 1) * QUERIES_PER_TASK);
+            for (size_t q = task * QUERIES_PER_TASK; q < end; ++q) {
+                keys[q] = static_cast<uint32_t>(bucket(queries[q]));
+            }
+        });
+        std::vector<uint32_t> bucket_begin(seeds.size() + 1, 0);
+        for (uint32_t key : keys) {
+            bucket_begin[key + 1]++;
+        }
+        for (size_t k = 1; k < bucket_begin.size(); ++k) {
+            bucket_begin[k] += bucket_begin[k - 1];
+        }
+        sorted_queries.resize(queries_n);
+        order.resize(queries_n);
+        for (size_t q = 0; q < queries_n; ++q) {
+            uint32_t k = bucket_begin[keys[q]]++;
+            sorted_queries[k] = queries[q];
+            order[k] = static_cast<uint32_t>(q);
+        }
+        queries = sorted_queries.data();
+    }
+
+    pool.run(tasks_n, [&](size_t task, size_t) {
+        size_t end = std::min(queries_n, (task + 1) * QUERIES_PER_TASK);
+        uint32_t previous = bl::NO_INDEX;
+        for (size_t k = task * QUERIES_PER_TASK; k < end; ++k) {
+            const Point2D &point = queries[k];
+            uint32_t from = seeds[bucket(point)];
+            if (previous != bl::NO_INDEX && distance2(points[previous], point) < distance2(points[from], point)) {
+                from = previous;
+            }
+            previous = walk(from, point);
+            sites[sorted ? k : order[k]] = site_index[previous];
+        }
+    });
+}
@@ -0,0 +1,97 @@
+//
+//  PointLocator.hpp
+//  FortuneAlgo
+//
+
+#ifndef PointLocator_hpp
+#define PointLocator_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ Index answering which cell of a diagram contains a point, that is which
+ site is the nearest to it.
+
+ A query starts from the seed of its bucket in a square grid over the sites,
+ the site nearest to the centre of the bucket, and walks over the neighbours
+ of the cells, each step to the neighbour closest to the point. The walk can
+ only stop at the nearest site, as Delaunay graph of distinct sites is greedy,
+ and for sites spread over the grid it takes one or two steps, so a query
+ costs the same for any number of sites. Repeats of a site get no cells from
+ build_voronoi, so they are left out and a query at them gets the first copy.
+ Sites are stored in the order of their buckets with their neighbours next to
+ them, so queries close to each other read the same memory.
+
+ The index copies what it needs, the points and the diagram are not used
+ after `build`.
+ */
+class PointLocator {
+public:
+
+    PointLocator();
+
+    /**
+     Build the index of the cells of `diagram`, which is the diagram of `points`.
+     Sites without cells, e.g. removed by IncrementalVoronoi, are never returned.
+     */
+    void build(const Point2D *points, size_t points_n, const bl::FlatDiagram &diagram);
+
+    inline void build(const std::vector<Point2D> &points, const bl::FlatDiagram &diagram) {
+        build(points.data(), points.size(), diagram);
+    }
+
+    // Site whose cell contains the point, NO_INDEX if there are no sites
+    uint32_t locate(const Point2D &point) const;
+
+    /**
+     Locate every query on the threads of `pool`, sites[i] is the site of queries[i].
+
+     Queries are copied in the order of their buckets first, then the copy is
+     split into chunks for the tasks, and a query starts from the site of the
+     previous one when it is closer than the seed of its bucket. Queries already
+     in some spatial order, e.g. the pixels of a raster row by row, can skip the
+     copy with `sorted`.
+     */
+    void locate(const Point2D *queries, size_t queries_n, uint32_t *sites,
+                ThreadPool &pool, bool sorted = false) const;
+
+    inline void locate(const std::vector<Point2D> &queries, std::vector<uint32_t> &sites,
+                       ThreadPool &pool, bool sorted = false) const {
+        sites.resize(queries.size());
+        locate(queries.data(), queries.size(), sites.data(), pool, sorted);
+    }
+
+    inline size_t sites_num() const {
+        return site_index.size();
+    }
+
+private:
+
+    // sites with cells in the order of their buckets and their indices in the input
+    std::vector<Point2D> points;
+    std::vector<uint32_t> site_index;
+
+    // neighbours of points[i] are neighbours[neighbours_begin[i]...neighbours_begin[i + 1]), as positions in `points`
+    std::vector<uint32_t> neighbours_begin, neighbours;
+
+    // square grid over the bounding box of the sites, with a seed position for every bucket
+    std::vector<uint32_t> seeds;
+    Point2D grid_min;
+    double grid_scale;
+    size_t grid_side;
+
+    size_t bucket(const Point2D &point) const;
+
+    // position of the nearest site, walking from the position `from`
+    uint32_t walk(uint32_t from, const Point2D &point) const;
+
+};
+
+
+#endif /* PointLocator_hpp */
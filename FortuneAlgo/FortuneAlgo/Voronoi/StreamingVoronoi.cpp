@@ -0,0 +1,354 @@
+//
+//  StreamingVoronoi.cpp
+//  FortuneAlgo
+//
+
+#include "StreamingVoronoi.hpp"
+#include "Sweep.hpp"
+
+
+/**
+ Output of the sweep into halfedges of the open cells.
+
+ Sites are kept in slots, which are reused once the cell of a site is passed
+ to the sink. Every halfedge is linked into the list of its cell, so the cell
+ can be collected without a pass over all the halfedges. Only the vertex of
+ the current circle event is kept, the halfedges pointing from it keep a copy.
+ */
+class StreamOutput {
+public:
+
+    std::vector<Point2D> points;
+
+    StreamOutput(const StreamingVoronoi::CellSink &_sink) : sink(_sink) {
+        clear();
+    }
+
+    void clear() {
+        points.clear();
+        ids.clear();
+        arcs.clear();
+        cell_edges.clear();
+        free_slots.clear();
+        twins.clear();
+        next.clear();
+        prev.clear();
+        cell_next.clear();
+        neighbour.clear();
+        origin.clear();
+        origin_point.clear();
+        free_halfedges.clear();
+        vertices_num = 0;
+        halfedges_num = 0;
+    }
+
+    // Put the site into a free slot
+    int new_site(const Point2D &point, uint64_t id) {
+        int slot;
+        if (free_slots.empty()) {
+            slot = static_cast<int>(points.size());
+            points.push_back(point);
+            ids.push_back(id);
+            arcs.push_back(0);
+            cell_edges.push_back(bl::NO_INDEX);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            points[slot] = point;
+            ids[slot] = id;
+        }
+        return slot;
+    }
+
+    // Emit the cell of the site if it has got no arc, which happens to the repeats of a site
+    void check_site(int slot) {
+        if (arcs[slot] == 0) {
+            emit_cell(slot);
+        }
+    }
+
+    // Emit the cells of all the sites, which still have arcs
+    void emit_all() {
+        for (size_t slot = 0; slot < arcs.size(); ++slot) {
+            if (arcs[slot] > 0) {
+                emit_cell(static_cast<int>(slot));
+            }
+        }
+    }
+
+    size_t live_sites() const {
+        return points.size() - free_slots.size();
+    }
+
+    size_t live_halfedges() const {
+        return halfedges_num;
+    }
+
+    std::pair<uint32_t, uint32_t> make_twins(int left_index, int right_index) {
+        uint32_t h = new_halfedge(left_index, ids[right_index]);
+        uint32_t h_twin = new_halfedge(right_index, ids[left_index]);
+        twins[h] = h_twin;
+        twins[h_twin] = h;
+        return std::make_pair(h, h_twin);
+    }
+
+    uint32_t twin(uint32_t h) {
+        return twins[h];
+    }
+
+    void connect_halfedges(uint32_t h1, uint32_t h2) {
+        next[h1] = h2;
+        prev[h2] = h1;
+    }
+
+    uint32_t add_vertex(const Point2D &point) {
+        vertex_point = point;
+        vertices_num++;
+        return 0;
+    }
+
+    // halfedge `h` points into the current vertex, so it is the origin of its twin
+    void set_vertex(uint32_t h, uint32_t) {
+        origin[twins[h]] = vertices_num - 1;
+        origin_point[twins[h]] = vertex_point;
+    }
+
+    void set_vertex_edge(uint32_t, uint32_t) {}
+
+    void arc_added(int slot) {
+        arcs[slot]++;
+    }
+
+    // The last arc of a site is gone, so are the events which could change its cell
+    void arc_removed(int slot) {
+        if (--arcs[slot] == 0) {
+            emit_cell(slot);
+        }
+    }
+
+private:
+
+    const StreamingVoronoi::CellSink &sink;
+
+    // slots of the sites: position in the stream, number of arcs and the first halfedge
+    std::vector<uint64_t> ids;
+    std::vector<uint32_t> arcs;
+    std::vector<uint32_t> cell_edges;
+    std::vector<int> free_slots;
+
+    // halfedges: links, next halfedge of the same cell,
+    // the site on the right and the vertex at the beginning
+    std::vector<uint32_t> twins, next, prev;
+    std::vector<uint32_t> cell_next;
+    std::vector<uint64_t> neighbour;
+    std::vector<uint64_t> origin;
+    std::vector<Point2D> origin_point;
+    std::vector<uint32_t> free_halfedges;
+    size_t halfedges_num;
+
+    uint64_t vertices_num;
+    Point2D vertex_point;
+
+    // cell passed to the sink, its edges keep their capacity
+    StreamedCell cell;
+
+    uint32_t new_halfedge(int slot, uint64_t right_id) {
+        uint32_t h;
+        if (free_halfedges.empty()) {
+            h = static_cast<uint32_t>(twins.size());
+            twins.push_back(bl::NO_INDEX);
+            next.push_back(bl::NO_INDEX);
+            prev.push_back(bl::NO_INDEX);
+            cell_next.push_back(cell_edges[slot]);
+            neighbour.push_back(right_id);
+            origin.push_back(NO_VERTEX);
+            origin_point.push_back(Point2D());
+        } else {
+            h = free_halfedges.back();
+            free_halfedges.pop_back();
+            next[h] = prev[h] = bl::NO_INDEX;
+            cell_next[h] = cell_edges[slot];
+            neighbour[h] = right_id;
+            origin[h] = NO_VERTEX;
+        }
+        cell_edges[slot] = h;
+        halfedges_num++;
+        return h;
+    }
+
+    // Add the edges from `h` till the end of its chain or till `h` again,
+    // at most `limit` of them in case degenerate input left the links crossed
+    void add_chain(uint32_t h, size_t limit) {
+        uint32_t first = h;
+        do {
+            StreamedEdge edge;
+            edge.neighbour = neighbour[h];
+            edge.from = origin[h];
+            edge.from_point = origin_point[h];
+            edge.to = NO_VERTEX;
+            if (next[h] != bl::NO_INDEX) {
+                edge.to = origin[next[h]];
+                edge.to_point = origin_point[next[h]];
+            }
+            cell.edges.push_back(edge);
+            h = next[h];
+        } while (h != bl::NO_INDEX && h != first && --limit > 0);
+    }
+
+    // Pass the cell to the sink and release its halfedges and slot
+    void emit_cell(int slot) {
+        cell.site = ids[slot];
+        cell.point = points[slot];
+        cell.edges.clear();
+
+        size_t size = 0;
+        for (uint32_t h = cell_edges[slot]; h != bl::NO_INDEX; h = cell_next[h]) {
+            size++;
+        }
+
+        // chains start at the halfedges coming from infinity, otherwise there is a cycle
+        for (uint32_t h = cell_edges[slot]; h != bl::NO_INDEX && cell.edges.size() < size; h = cell_next[h]) {
+            if (prev[h] == bl::NO_INDEX) {
+                add_chain(h, size - cell.edges.size());
+            }
+        }
+        cell.closed = cell.edges.empty() && size > 0;
+        if (cell.closed) {
+            add_chain(cell_edges[slot], size);
+        }
+
+        sink(cell);
+
+        // twins of the released halfedges belong to the cells of the neighbours,
+        // they are never followed back since their breakpoints are gone
+        for (uint32_t h = cell_edges[slot]; h != bl::NO_INDEX; h = cell_next[h]) {
+            free_halfedges.push_back(h);
+            halfedges_num--;
+        }
+        cell_edges[slot] = bl::NO_INDEX;
+        arcs[slot] = 0;
+        free_slots.push_back(slot);
+    }
+
+};
+
+
+typedef Sweep<double, StreamOutput, bl::AVLBeachline> AVLStreamSweep;
+typedef Sweep<double, StreamOutput, bl::WideBeachline> WideStreamSweep;
+
+
+struct StreamingVoronoi::State {
+    StreamingVoronoi::CellSink sink;
+    StreamOutput output;
+    bl::CircleEventQueue queue;
+    bl::AVLBeachline avl;
+    bl::WideBeachline wide;
+    AVLStreamSweep avl_sweep;
+    WideStreamSweep wide_sweep;
+    BeachlineType beachline;
+    bool finger_search;
+
+    // the last site and the number of sites in the stream
+    Point2D last;
+    uint64_t sites_num;
+
+    State(const StreamingVoronoi::CellSink &_sink, BeachlineType _beachline) :
+    sink(_sink), output(sink), avl_sweep(output.points.data(), output, avl, queue),
+    wide_sweep(output.points.data(), output, wide, queue), beachline(_beachline),
+    finger_search(false), sites_num(0) {}
+
+    void reset() {
+        output.clear();
+        avl_sweep.reset();
+        wide_sweep.reset();
+        avl.set_finger_search(finger_search);
+        wide.set_finger_search(finger_search);
+        sites_num = 0;
+    }
+};
+
+
+StreamingVoronoi::StreamingVoronoi(const CellSink &sink, BeachlineType beachline) :
+state(new State(sink, beachline)) {}
+
+
+StreamingVoronoi::~StreamingVoronoi() {}
+
+
+void StreamingVoronoi::set_finger_search(bool enabled) {
+    state->finger_search = enabled;
+    state->avl.set_finger_search(enabled);
+    state->wide.set_finger_search(enabled);
+}
+
+
+bool StreamingVoronoi::add_site(const Point2D &point) {
+    const Point2D &last = state->last;
+    if (state->sites_num > 0 && (point.y < last.y || (point.y == last.y && point.x < last.x))) {
+        return false;
+    }
+    bool repeated = state->sites_num > 0 && point.x == last.x && point.y == last.y;
+    state->last = point;
+
+    // the sweep reads the sites from the slots, which move when their vector grows
+    const Point2D *points = state->output.points.data();
+    int slot = state->output.new_site(point, state->sites_num++);
+    if (state->output.points.data() != points) {
+        state->avl_sweep.set_points(state->output.points.data());
+        state->wide_sweep.set_points(state->output.points.data());
+    }
+    // a repeat of the previous site gets no arc and its empty cell goes out right away
+    if (state->beachline == WIDE_BEACHLINE && repeated) {
+        state->wide_sweep.drop_site(slot);
+    } else if (state->beachline == WIDE_BEACHLINE) {
+        state->wide_sweep.add_site(slot);
+    } else if (repeated) {
+        state->avl_sweep.drop_site(slot);
+    } else {
+        state->avl_sweep.add_site(slot);
+    }
+    state->output.check_site(slot);
+    return true;
+}
+
+
+void StreamingVoronoi::finish(SweepStats *stats) {
+    if (state->beachline == WIDE_BEACHLINE) {
+        state->wide_sweep.finish();
+    } else {
+        state->avl_sweep.finish();
+    }
+    state->output.emit_all();
+    if (stats != nullptr) {
+        *stats = state->beachline == WIDE_BEACHLINE ? state->wide_sweep.stats : state->avl_sweep.stats;
+    }
+    state->reset();
+}
+
+
+uint64_t StreamingVoronoi::sites_num() const {
+    return state->sites_num;
+}
+
+
+size_t StreamingVoronoi::live_sites() const {
+    return state->output.live_sites();
+}
+
+
+size_t StreamingVoronoi::live_halfedges() const {
+    return state->output.live_halfedges();
+}
+
+
+bool build_voronoi_stream(const std::function<bool(Point2D &)> &source, const StreamingVoronoi::CellSink &sink,
+                          SweepStats *stats) {
+    StreamingVoronoi voronoi(sink);
+    bool ordered = true;
+    Point2D point;
+    while (source(point)) {
+        ordered = voronoi.add_site(point) && ordered;
+    }
+    voronoi.finish(stats);
+    return ordered;
+}
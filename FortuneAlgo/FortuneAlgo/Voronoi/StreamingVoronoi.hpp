@@ -0,0 +1,127 @@
+//
+//  StreamingVoronoi.hpp
+//  FortuneAlgo
+//
+
+#ifndef StreamingVoronoi_hpp
+#define StreamingVoronoi_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+
+// Vertex of the infinite end of an edge
+const uint64_t NO_VERTEX = std::numeric_limits<uint64_t>::max();
+
+
+/**
+ Edge of a streamed cell from the vertex `from` to the vertex `to`.
+ Vertices are numbered in the order they are found by the sweep, so an edge
+ shared by two cells has the same numbers in both. An infinite end has
+ NO_VERTEX and no point.
+ */
+struct StreamedEdge {
+    uint64_t neighbour;
+    uint64_t from, to;
+    Point2D from_point, to_point;
+};
+
+
+/**
+ Cell of the site number `site` of the stream.
+ Edges of a closed cell form a counterclockwise cycle. Edges of an unbounded
+ cell form chains coming from infinity and going to infinity, usually one.
+ A repeat of the previous site gets a cell without edges, its first copy
+ keeps the cell.
+ */
+struct StreamedCell {
+    uint64_t site;
+    Point2D point;
+    bool closed;
+    std::vector<StreamedEdge> edges;
+};
+
+
+/**
+ Fortune's sweep over sites given one by one in the sweep order.
+
+ A cell is passed to the sink once the last arc of its site leaves the
+ beachline: no later event can touch its edges then. Its halfedges and the
+ slot of its site are reused for the next sites, so the memory is proportional
+ to the number of sites with arcs on the beachline and the size of the event
+ queue, not to the number of sites. Cells of the sites on the convex hull
+ keep their arcs till the end and are passed to the sink by `finish`.
+
+ Cells come in the order they are closed. The sink is called from
+ `add_site` and `finish` and must not call them itself.
+ */
+class StreamingVoronoi {
+public:
+
+    typedef std::function<void(const StreamedCell &)> CellSink;
+
+    explicit StreamingVoronoi(const CellSink &sink, BeachlineType beachline = AVL_BEACHLINE);
+    ~StreamingVoronoi();
+
+    // Start searches of the beachline from the last inserted arc, see SweepBuffersT
+    void set_finger_search(bool enabled);
+
+    /**
+     Add the next site. Sites must come by increasing y, and by increasing x
+     for equal y. A site out of this order is ignored and false is returned.
+     */
+    bool add_site(const Point2D &point);
+
+    /**
+     Process the remaining events and pass the remaining cells to the sink.
+     After that a new stream may be started with `add_site`.
+     */
+    void finish(SweepStats *stats = nullptr);
+
+    // Number of sites of the current stream
+    uint64_t sites_num() const;
+
+    // Sites with cells not passed to the sink yet and halfedges kept for them
+    size_t live_sites() const;
+    size_t live_halfedges() const;
+
+private:
+
+    struct State;
+    std::unique_ptr<State> state;
+
+};
+
+
+/**
+ Build the diagram of sites given by a pair of iterators in the sweep order
+ and pass its cells to `sink`. Returns false if some sites were out of order,
+ they are skipped.
+ */
+template<class Iterator>
+bool build_voronoi_stream(Iterator first, Iterator last, const StreamingVoronoi::CellSink &sink,
+                          SweepStats *stats = nullptr) {
+    StreamingVoronoi voronoi(sink);
+    bool ordered = true;
+    for (; first != last; ++first) {
+        ordered = voronoi.add_site(*first) && ordered;
+    }
+    voronoi.finish(stats);
+    return ordered;
+}
+
+
+/**
+ Same as above, but sites are taken from `source` until it returns false.
+ */
+bool build_voronoi_stream(const std::function<bool(Point2D &)> &source, const StreamingVoronoi::CellSink &sink,
+                          SweepStats *stats = nullptr);
+
+
+#endif /* StreamingVoronoi_hpp */
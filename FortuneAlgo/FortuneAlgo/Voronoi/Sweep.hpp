@@ -0,0 +1,430 @@
+//
+//  Sweep.hpp
+//  FortuneAlgo
+//
+//  Event loop of the Fortune's sweep shared by build_voronoi and the streaming sweep.
+//  It is a template over the output and the beachline, so the definitions are here.
+//
+
+#ifndef Sweep_hpp
+#define Sweep_hpp
+
+#include "VoronoiDiagram.hpp"
+#include "Beachline.hpp"
+#include "Parabola.hpp"
+#include "Circle.hpp"
+#include "Predicates.hpp"
+#include "SweepTrace.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+
+/**
+ Check if arcs n1, n2, n3 converge and schedule a circle event for n2.
+ Returns true if the event was added to the queue.
+ */
+template<typename T, class Beachline>
+bool checkCircleEvent(Beachline &beachline, bl::CircleEventQueueT<T> &queue,
+                      bl::BLNodePtr n1, bl::BLNodePtr n2, bl::BLNodePtr n3,
+                      const Point2DT<T> *points, T sweepline) {
+
+    if (n1 == bl::NO_NODE || n2 == bl::NO_NODE || n3 == bl::NO_NODE)
+        return false;
+
+    const Point2DT<T> &p1 = points[beachline.site(n1)];
+    const Point2DT<T> &p2 = points[beachline.site(n2)];
+    const Point2DT<T> &p3 = points[beachline.site(n3)];
+
+    // breakpoints around the middle arc converge only if the sites make a left turn
+    double orientation = orient2d(p1, p2, p3);
+    if (orientation <= 0.0)
+        return false;
+
+    Point2DT<T> center = circleCenter(p1, p2, p3, orientation), bottom = center;
+    bottom.y += (center - p2).norm();
+
+    // converging breakpoints meet at or below the sweepline,
+    // rounding may only put the bottom of the circle slightly above it
+    bottom.y = std::max(bottom.y, sweepline);
+
+    bl::CircleEventT<T> e;
+    e.point = bottom;
+    e.center = center;
+    e.arc = n2;
+    // add reference in the corresponding node
+    beachline.circle_event(n2) = queue.push(e);
+    return true;
+}
+
+
+/**
+ Check if `site` is strictly inside the circle of the circle event of the arc-node,
+ which goes through the sites of the arc and its neighbours.
+ */
+template<typename T, class Beachline>
+bool siteInsideCircle(Beachline &beachline, bl::BLNodePtr arc,
+                      const Point2DT<T> *points, const Point2DT<T> &site) {
+    const Point2DT<T> &p1 = points[beachline.site(beachline.prev(arc))];
+    const Point2DT<T> &p2 = points[beachline.site(arc)];
+    const Point2DT<T> &p3 = points[beachline.site(beachline.next(arc))];
+    // the sites make a left turn, otherwise the event would not be scheduled
+    return incircle(p1, p2, p3, site) > 0.0;
+}
+
+
+/**
+ Remove a pending circle event of the arc-node (if any) from the queue.
+ */
+template<typename T, class Beachline>
+void cancelCircleEvent(Beachline &beachline, bl::CircleEventQueueT<T> &queue,
+                       bl::BLNodePtr node, SweepStats &stats) {
+    if (node != bl::NO_NODE && beachline.circle_event(node) != bl::NO_EVENT) {
+        queue.remove(beachline.circle_event(node));
+        beachline.circle_event(node) = bl::NO_EVENT;
+        stats.circle_events_cancelled++;
+    }
+}
+
+
+/**
+ Fortune's sweep over sites given one by one in the order of `SiteComparator`.
+
+ Sites are indices into `points`, which may move between the calls, see `set_points`.
+ The diagram goes to `Output`, which also hears about every arc that appears
+ on the beachline (`arc_added`) and disappears from it (`arc_removed`).
+ With `set_trace` every processed event is also appended to a SweepTrace.
+ A site equal to the previous one must go to `drop_site` instead of `add_site`:
+ the arc of its first copy has no width yet, so the search would find a
+ neighbouring arc and split it.
+ */
+template<typename T, class Output, class Beachline>
+class Sweep {
+public:
+
+    SweepStats stats;
+
+    Sweep(const Point2DT<T> *_points, Output &_output, Beachline &_beachline,
+          bl::CircleEventQueueT<T> &_queue) :
+    points(_points), output(_output), beachline(_beachline), queue(_queue), trace(nullptr) {
+        reset();
+    }
+
+    // Drop all the events and arcs, the memory is kept
+    void reset() {
+        queue.clear();
+        beachline.reset(points);
+        sweepline = 0;
+        stats = SweepStats();
+        trace_hits = trace_misses = 0;
+#ifdef FORTUNE_SWEEP_PROFILE
+        samples = 0;
+        arcs_sum = height_sum = 0.0;
+#endif
+    }
+
+    // Take the points from a new place, the sites keep their indices
+    void set_points(const Point2DT<T> *_points) {
+        points = _points;
+        beachline.set_points(points);
+    }
+
+    // Record the events from now on into `_trace`, nullptr stops recording
+    void set_trace(SweepTrace *_trace) {
+        trace = _trace;
+        trace_clock = std::chrono::steady_clock::now();
+        trace_begin = trace_start = traceTicks();
+        trace_hits = beachline.value_hits();
+        trace_misses = beachline.value_misses();
+    }
+
+    // Process circle events before the site and the site event
+    void add_site(int site) {
+        start_lap();
+        while (circle_first(points[site])) {
+            lap(stats.queue_time);
+            circle_event();
+        }
+        lap(stats.queue_time);
+        site_event(site);
+    }
+
+    // Skip a repeat of the previous site: it gets no arc, so its cell stays empty
+    void drop_site(int site) {
+#ifdef FORTUNE_SWEEP_PROFILE
+        stats.site_events++;
+#endif
+        stats.sites_dropped++;
+        trace_event(TRACE_SITE_DROPPED, site, bl::NO_NODE, points[site].x, points[site].y);
+    }
+
+    // Process the remaining circle events
+    void finish() {
+        start_lap();
+        while (!queue.empty()) {
+            circle_event();
+        }
+        stats.breakpoint_cache_hits = beachline.value_hits();
+        stats.breakpoint_cache_misses = beachline.value_misses();
+        if (trace != nullptr) {
+            // ticks of the time stamp counter have no fixed length, measure them
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - trace_clock).count();
+            uint64_t ticks = traceTicks() - trace_begin;
+            trace->tick_ns = ticks > 0 ? ns / ticks : 1.0;
+        }
+#ifdef FORTUNE_SWEEP_PROFILE
+        stats.rebalances = beachline.rebalances();
+        if (samples > 0) {
+            stats.mean_beachline_arcs = arcs_sum / samples;
+            stats.mean_beachline_height = height_sum / samples;
+        }
+#endif
+    }
+
+private:
+
+    const Point2DT<T> *points;
+    Output &output;
+    Beachline &beachline;
+    bl::CircleEventQueueT<T> &queue;
+
+    // current position of the sweepline
+    T sweepline;
+
+    // start of the trace, end of the previous traced event and the breakpoint counters at that time
+    SweepTrace *trace;
+    std::chrono::steady_clock::time_point trace_clock;
+    uint64_t trace_begin, trace_start;
+    size_t trace_hits, trace_misses;
+
+    void trace_event(TraceEventType type, int site, bl::BLNodePtr arc, T x, T y) {
+        if (trace == nullptr)
+            return;
+        uint64_t now = traceTicks();
+        size_t hits = beachline.value_hits(), misses = beachline.value_misses();
+        size_t compared = hits + misses - trace_hits - trace_misses, evaluated = misses - trace_misses;
+
+        TraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.x = x;
+        record.y = y;
+        record.site = static_cast<uint32_t>(site);
+        record.arc = arc;
+        record.time = static_cast<uint32_t>(std::min<uint64_t>(now - trace_start, std::numeric_limits<uint32_t>::max()));
+        record.queue_size = static_cast<uint32_t>(std::min<size_t>(queue.size(), std::numeric_limits<uint32_t>::max()));
+        record.compared = static_cast<uint16_t>(std::min<size_t>(compared, std::numeric_limits<uint16_t>::max()));
+        record.evaluated = static_cast<uint16_t>(std::min<size_t>(evaluated, std::numeric_limits<uint16_t>::max()));
+        record.type = type;
+        trace->records.push_back(record);
+
+        trace_start = now;
+        trace_hits = hits;
+        trace_misses = misses;
+    }
+
+#ifdef FORTUNE_SWEEP_PROFILE
+    // sums of the beachline samples and the start of the current phase
+    size_t samples;
+    double arcs_sum, height_sum;
+    std::chrono::steady_clock::time_point lap_start;
+
+    void start_lap() {
+        lap_start = std::chrono::steady_clock::now();
+    }
+
+    // Add the time since the previous lap to `phase`
+    void lap(double &phase) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        phase += std::chrono::duration<double>(now - lap_start).count();
+        lap_start = now;
+    }
+
+    void sample() {
+        size_t arcs = beachline.arcs_num();
+        int height = beachline.tree_height();
+        stats.max_beachline_arcs = std::max(stats.max_beachline_arcs, arcs);
+        stats.max_beachline_height = std::max(stats.max_beachline_height, height);
+        arcs_sum += arcs;
+        height_sum += height;
+        samples++;
+    }
+#else
+    inline void start_lap() {}
+    inline void lap(double &) {}
+    inline void sample() {}
+#endif
+
+    // Circle event goes first if it is not above the next site
+    bool circle_first(const Point2DT<T> &site) {
+        stats.max_queue_size = std::max(stats.max_queue_size, queue.size());
+        if (queue.empty())
+            return false;
+
+        const Point2DT<T> &circle = queue.top().point;
+        bool is_circle = circle.y < site.y || (circle.y == site.y && circle.x <= site.x);
+        // the rounded bottom of the circle may be above a site inside the circle,
+        // which lies above the exact bottom and invalidates the event
+        if (is_circle && site.y - circle.y < Tolerance<T>::point()) {
+            is_circle = !siteInsideCircle(beachline, queue.top().arc, points, site);
+        }
+        return is_circle;
+    }
+
+    void site_event(int point_i) {
+        const Point2DT<T> &point = points[point_i];
+#ifdef FORTUNE_SWEEP_PROFILE
+        stats.site_events++;
+#endif
+
+        // set position of a sweepline
+        sweepline = point.y;
+        beachline.set_sweepline(sweepline);
+
+        if (beachline.empty()) { // init empty beachline
+            beachline.init(point_i);
+            lap(stats.beachline_time);
+            output.arc_added(point_i);
+            lap(stats.output_time);
+            sample();
+            trace_event(TRACE_SITE, point_i, bl::NO_NODE, point.x, point.y);
+            return;
+        }
+
+        bl::BLNodePtr arc = beachline.find(point.x);
+        int arc_site = beachline.site(arc);
+        std::pair<bl::BLNodePtr, bl::BLNodePtr> leaves;
+
+        // check number of intersection points, a site at the focus of the arc
+        // is dropped before the arc loses its circle event
+        int isp_num = intersectionPointsNum(points[arc_site], point);
+        if (isp_num != 1 && isp_num != 2) {
+            stats.sites_dropped++;
+            lap(stats.beachline_time);
+            trace_event(TRACE_SITE_DROPPED, point_i, arc, point.x, point.y);
+            return;
+        }
+        lap(stats.beachline_time);
+
+        // the arc is split, so its circle event is gone
+        cancelCircleEvent(beachline, queue, arc, stats);
+        lap(stats.queue_time);
+
+        std::pair<uint32_t, uint32_t> twins = output.make_twins(arc_site, point_i);
+        lap(stats.output_time);
+
+        // the new arc goes next to the old one or splits it in two
+        if (isp_num == 1) {
+#ifdef FORTUNE_SWEEP_PROFILE
+            stats.sites_beside++;
+#endif
+            leaves = beachline.insert_beside(arc, point_i, twins);
+            lap(stats.beachline_time);
+        } else {
+            leaves = beachline.split(arc, point_i, twins);
+            lap(stats.beachline_time);
+            output.arc_added(arc_site);
+        }
+        output.arc_added(point_i);
+        lap(stats.output_time);
+
+        bl::BLNodePtr left_leaf = leaves.first, right_leaf = leaves.second;
+
+        // Check circle events
+        if (checkCircleEvent(beachline, queue, beachline.prev(left_leaf), left_leaf, beachline.next(left_leaf), points, sweepline)) {
+            stats.circle_events_pushed++;
+        }
+        if (checkCircleEvent(beachline, queue, beachline.prev(right_leaf), right_leaf, beachline.next(right_leaf), points, sweepline)) {
+            stats.circle_events_pushed++;
+        }
+        lap(stats.queue_time);
+        sample();
+        trace_event(isp_num == 1 ? TRACE_SITE_BESIDE : TRACE_SITE, point_i, arc, point.x, point.y);
+    }
+
+    void circle_event() {
+        // extract the event from the queue
+        bl::CircleEventT<T> e = queue.top(); queue.pop();
+        lap(stats.queue_time);
+
+        // set position of a sweepline, a site taken before the event
+        // may be slightly below its rounded position
+        sweepline = std::max(sweepline, e.point.y);
+        beachline.set_sweepline(sweepline);
+
+        bl::BLNodePtr arc = e.arc, prev_leaf, next_leaf;
+        beachline.circle_event(arc) = bl::NO_EVENT;
+
+        // get halfedges of the breakpoints, recheck if it's a false alarm
+        uint32_t h_first, h_second;
+        if (!beachline.breakpoint_edges(arc, h_first, h_second)) {
+            stats.circle_events_false++;
+            lap(stats.beachline_time);
+            trace_event(TRACE_CIRCLE_FALSE, beachline.site(arc), arc, e.center.x, e.point.y);
+            return;
+        }
+
+        stats.circle_events_processed++;
+        lap(stats.beachline_time);
+
+        // create a new vertex and insert into doubly-connected edge list
+        uint32_t vertex = output.add_vertex(e.center);
+        lap(stats.output_time);
+
+        // store indices of the next and previous leaves
+        prev_leaf = beachline.prev(arc);
+        next_leaf = beachline.next(arc);
+
+        // They should not be null
+        assert(prev_leaf != bl::NO_NODE);
+        assert(next_leaf != bl::NO_NODE);
+
+        // remove circle events corresponding to prev and next leaves
+        cancelCircleEvent(beachline, queue, prev_leaf, stats);
+        cancelCircleEvent(beachline, queue, next_leaf, stats);
+        lap(stats.queue_time);
+
+        // make a new pair of halfedges and remove arc from the beachline,
+        // the breakpoint between its neighbours takes the new edge
+        int arc_site = beachline.site(arc);
+        std::pair<uint32_t, uint32_t> twin_nodes = output.make_twins(beachline.site(prev_leaf), beachline.site(next_leaf));
+        lap(stats.output_time);
+        beachline.remove(arc, twin_nodes.first);
+        lap(stats.beachline_time);
+
+        // connect halfedges
+        output.connect_halfedges(h_second, output.twin(h_first));
+        output.connect_halfedges(h_first, twin_nodes.first);
+        output.connect_halfedges(twin_nodes.second, output.twin(h_second));
+
+        // halfedges are pointing into a vertex  -----> O <-----
+        // not like this <---- O ----->
+        // counterclockwise
+        output.set_vertex(h_first, vertex);
+        output.set_vertex(h_second, vertex);
+        output.set_vertex(twin_nodes.second, vertex);
+        output.set_vertex_edge(vertex, h_second);
+
+        // the edges around the vertex are complete
+        output.arc_removed(arc_site);
+        lap(stats.output_time);
+
+        // check new circle events
+        if (checkCircleEvent(beachline, queue, beachline.prev(prev_leaf), prev_leaf, next_leaf, points, sweepline)) {
+            stats.circle_events_pushed++;
+        }
+        if (checkCircleEvent(beachline, queue, prev_leaf, next_leaf, beachline.next(next_leaf), points, sweepline)) {
+            stats.circle_events_pushed++;
+        }
+        lap(stats.queue_time);
+        sample();
+        trace_event(TRACE_CIRCLE, arc_site, arc, e.center.x, e.point.y);
+    }
+
+};
+
+
+#endif /* Sweep_hpp */
@@ -0,0 +1,73 @@
+//
+//  SweepTrace.cpp
+//  FortuneAlgo
+//
+
+#include "SweepTrace.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+
+struct TraceHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t sites_n;
+    uint64_t records_n;
+    double tick_ns;
+};
+
+static_assert(sizeof(TraceHeader) == TRACE_FILE_HEADER, "trace header must take 40 bytes");
+
+
+bool write_trace(const std::string &file_name, const SweepTrace &trace) {
+    if (!is_little_endian()) {
+        return false;
+    }
+
+    TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+    header.record_size = sizeof(TraceRecord);
+    header.sites_n = trace.sites_num;
+    header.records_n = trace.records.size();
+    header.tick_ns = trace.tick_ns;
+
+    FILE *file = fopen(file_name.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(trace.records.data(), sizeof(TraceRecord), trace.records.size(), file) == trace.records.size();
+    return fclose(file) == 0 && ok;
+}
+
+
+bool read_trace(const std::string &file_name, SweepTrace &trace) {
+    trace.clear();
+    MappedFile file;
+    if (!is_little_endian() || !file.open(file_name)) {
+        return false;
+    }
+
+    TraceHeader header;
+    if (file.size() < TRACE_FILE_HEADER) {
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(TraceRecord) ||
+        header.records_n > (file.size() - TRACE_FILE_HEADER) / sizeof(TraceRecord)) {
+        return false;
+    }
+
+    trace.sites_num = header.sites_n;
+    trace.tick_ns = header.tick_ns;
+    trace.records.resize(header.records_n);
+    if (header.records_n > 0) {
+        memcpy(trace.records.data(), file.data() + TRACE_FILE_HEADER, header.records_n * sizeof(TraceRecord));
+    }
+    return true;
+}
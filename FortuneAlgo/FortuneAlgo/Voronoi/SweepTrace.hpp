@@ -0,0 +1,131 @@
+//
+//  SweepTrace.hpp
+//  FortuneAlgo
+//
+
+#ifndef SweepTrace_hpp
+#define SweepTrace_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+
+/**
+ Kind of a traced event. A site event either splits the arc above the site,
+ goes next to it when both sites are level or is dropped when the site repeats
+ the previous one. A circle event is processed or turns out a false alarm.
+ */
+enum TraceEventType : uint8_t {
+    TRACE_SITE,
+    TRACE_SITE_BESIDE,
+    TRACE_SITE_DROPPED,
+    TRACE_CIRCLE,
+    TRACE_CIRCLE_FALSE,
+    TRACE_EVENT_TYPES
+};
+
+
+/**
+ One event of the sweep, 40 bytes.
+
+ `x` and `y` are the site, or the centre of the circle and the sweepline at its
+ bottom. `site` is the new site or the site of the disappearing arc, `arc` is
+ the beachline node found above the site (NO_NODE for the first site) or the
+ disappearing one; node ids are reused after the arc leaves the beachline.
+ `compared` counts the breakpoints compared with the site or looked up while
+ removing the arc, `evaluated` those of them computed anew rather than taken
+ from the cache, both saturate at 65535. `time` is the time in ticks since the
+ previous event ended, which includes the check of the queue before this one,
+ see `tick_ns` of SweepTrace.
+ */
+struct TraceRecord {
+    double x, y;
+    uint32_t site;
+    uint32_t arc;
+    uint32_t time;
+    uint32_t queue_size;
+    uint16_t compared;
+    uint16_t evaluated;
+    uint8_t type;
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(TraceRecord) == 40, "trace record must take 40 bytes");
+
+
+/**
+ Events of one sweep in the order they were processed. Set `trace` of
+ SweepBuffers to record the next build_voronoi calls, each of them replaces
+ the records. Recording appends a record and reads the time stamp counter
+ once per event, so it can stay on for sampled requests; reserve `records`
+ for about three times the number of sites to keep the appends from reallocating.
+
+ Ticks are those of the time stamp counter on x86 and nanoseconds elsewhere.
+ The end of the sweep sets `tick_ns`, nanoseconds per tick, from the clock.
+ */
+struct SweepTrace {
+    uint64_t sites_num = 0;
+    double tick_ns = 1.0;
+    std::vector<TraceRecord> records;
+
+    void clear() {
+        sites_num = 0;
+        tick_ns = 1.0;
+        records.clear();
+    }
+};
+
+
+// Current tick of the trace, far cheaper than the clock where there is a time stamp counter
+inline uint64_t traceTicks() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+/**
+ Binary trace file, a 40-byte header followed by the records as they are in
+ memory:
+
+   bytes 0-7     magic "FATRACE1"
+   bytes 8-11    size of a record, uint32
+   bytes 12-15   zeros
+   bytes 16-23   number of sites, uint64
+   bytes 24-31   number of records, uint64
+   bytes 32-39   nanoseconds per tick, double
+   bytes 40-     the records
+
+ All the numbers are little-endian.
+ */
+const char TRACE_FILE_MAGIC[8] = {'F', 'A', 'T', 'R', 'A', 'C', 'E', '1'};
+const size_t TRACE_FILE_HEADER = 40;
+
+
+/**
+ Write the trace into a binary trace file.
+ Returns false if the file cannot be written or the machine is big-endian.
+ */
+bool write_trace(const std::string &file_name, const SweepTrace &trace);
+
+
+/**
+ Read a binary trace file into `trace`. Returns false if the file cannot be
+ read, is not a trace file or is shorter than its header says.
+ */
+bool read_trace(const std::string &file_name, SweepTrace &trace);
+
+
+#endif /* SweepTrace_hpp */
@@ -0,0 +1,44 @@
+//
+//  VoronoiBuilder.cpp
+//  FortuneAlgo
+//
+
+#include "VoronoiBuilder.hpp"
+
+
+VoronoiBuilder::VoronoiBuilder(BeachlineType beachline) {
+    buffers.beachline = beachline;
+}
+
+
+const bl::FlatDiagram &VoronoiBuilder::build(const std::vector<Point2D> &points, SweepStats *stats) {
+    build_voronoi(points, result, buffers, stats);
+    return result;
+}
+
+
+const ClippedCells &VoronoiBuilder::build(const std::vector<Point2D> &points, const BoundingBox &box,
+                                          SweepStats *stats) {
+    build_voronoi(points, result, buffers, stats);
+    clip_cells(points, result, box, cells);
+    return cells;
+}
+
+
+void VoronoiBuilder::reserve(size_t n) {
+    // a diagram of n sites has at most 2n-5 vertices and 3n-6 edges;
+    // sizes of the beachline and the event queue depend on the input,
+    // they keep the capacity reached by the previous builds
+    buffers.sites.reserve(n);
+    result.reserve(n > 2 ? 2 * n - 5 : 0, n > 2 ? 6 * n - 12 : 2);
+    result.faces.reserve(n);
+}
+
+
+void VoronoiBuilder::shrink() {
+    BeachlineType beachline = buffers.beachline;
+    buffers = SweepBuffers();
+    buffers.beachline = beachline;
+    result = bl::FlatDiagram();
+    cells = ClippedCells();
+}
@@ -0,0 +1,56 @@
+//
+//  VoronoiBuilder.hpp
+//  FortuneAlgo
+//
+
+#ifndef VoronoiBuilder_hpp
+#define VoronoiBuilder_hpp
+
+#include "Point2D.h"
+#include "VoronoiDiagram.hpp"
+
+
+/**
+ Builds Voronoi diagrams one after another, keeping the scratch memory
+ of the sweep and the output diagram between calls. Once the capacity
+ covers the largest input, builds do not allocate.
+ */
+class VoronoiBuilder {
+public:
+
+    explicit VoronoiBuilder(BeachlineType beachline = AVL_BEACHLINE);
+
+    /**
+     Build the diagram of `points`.
+     The result stays valid until the next call of `build`.
+     */
+    const bl::FlatDiagram &build(const std::vector<Point2D> &points, SweepStats *stats = nullptr);
+
+    /**
+     Build the diagram of `points` and clip its cells to `box`.
+     The diagram itself is available from `diagram` as well.
+     */
+    const ClippedCells &build(const std::vector<Point2D> &points, const BoundingBox &box,
+                              SweepStats *stats = nullptr);
+
+    // Result of the last build
+    inline const bl::FlatDiagram &diagram() const {
+        return result;
+    }
+
+    // Pre-size all the buffers for diagrams of up to `n` sites
+    void reserve(size_t n);
+
+    // Release all the memory
+    void shrink();
+
+private:
+
+    SweepBuffers buffers;
+    bl::FlatDiagram result;
+    ClippedCells cells;
+
+};
+
+
+#endif /* VoronoiBuilder_hpp */
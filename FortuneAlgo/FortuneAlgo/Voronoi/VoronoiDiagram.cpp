@@ -7,285 +7,364 @@
 //
 
 #include "VoronoiDiagram.hpp"
+#include "Sweep.hpp"
 #include "Beachline.hpp"
-#include "Parabola.hpp"
-#include "Circle.hpp"
+#include "WideBeachline.hpp"
 #include "DCEL.hpp"
 
-#include <queue>
+#include <algorithm>
 
-#define BREAKPOINTS_EPSILON 1.0e-5
 #define _DEBUG_
 
 
 namespace bl = beachline;
 
 
-struct Event {
+// Order of site events: increasing y, ties are broken by increasing x
+template<typename T>
+struct SiteComparator {
+    const Point2DT<T> *points;
+    bool operator()(int i, int j) const {
+        const Point2DT<T> &p1 = points[i], &p2 = points[j];
+        return p1.y < p2.y || (p1.y == p2.y && (p1.x < p2.x || (p1.x == p2.x && i < j)));
+    }
+};
+
+
+/**
+ Output of the sweep into vectors of pointer-based DCEL records.
+ Halfedges and vertices are referred to by their positions in these vectors.
+ */
+template<typename T>
+class PointerOutput {
+public:
     
-    enum { SITE = 0, CIRCLE = 1, SKIP = 2, };
+    PointerOutput(std::vector<bl::HalfEdgePtrT<T>> &_halfedges,
+                  std::vector<bl::VertexPtrT<T>> &_vertices,
+                  std::vector<bl::HalfEdgePtrT<T>> &_faces) :
+    halfedges(_halfedges), vertices(_vertices), faces(_faces) {}
     
+    std::pair<uint32_t, uint32_t> make_twins(int left_index, int right_index) {
+        std::pair<bl::HalfEdgePtrT<T>, bl::HalfEdgePtrT<T>> twins = bl::make_twins<T>(left_index, right_index);
+        halfedges.push_back(twins.first);
+        halfedges.push_back(twins.second);
+        uint32_t h = static_cast<uint32_t>(halfedges.size() - 2);
+        return std::make_pair(h, h + 1);
+    }
     
-    int type;
-    Point2D point;
+    // twins are always stored next to each other
+    uint32_t twin(uint32_t h) {
+        return h ^ 1;
+    }
     
-    /*
-     Site event attributes:
-     */
-    int index;
+    void connect_halfedges(uint32_t h1, uint32_t h2) {
+        bl::connect_halfedges(halfedges[h1], halfedges[h2]);
+    }
     
-    /*
-     Circle event attributes:
-     */
-    Point2D center;
-    bl::BLNodePtr arc;
+    uint32_t add_vertex(const Point2DT<T> &point) {
+        vertices.push_back(std::make_shared<bl::VertexT<T>>(point));
+        return static_cast<uint32_t>(vertices.size() - 1);
+    }
     
+    // halfedge `h` points into the vertex `v`
+    void set_vertex(uint32_t h, uint32_t v) {
+        halfedges[h]->vertex = vertices[v];
+    }
     
-    Event(int _index = -1, int _type = Event::SKIP, const Point2D &_point = Point2D(0.0, 0.0)) :
-    index(_index), type(_type), point(_point), arc(nullptr) {}
+    void set_vertex_edge(uint32_t v, uint32_t h) {
+        vertices[v]->edge = halfedges[h];
+    }
     
-};
-
-
-typedef std::shared_ptr<Event> EventPtr;
-
-
-struct Point2DComparator {
-    bool operator()(const Point2D &p1, const Point2D &p2) {
-        return (p1.y == p2.y && p1.x > p2.x) || p1.y > p2.y;
+    void arc_added(int) {}
+    void arc_removed(int) {}
+    
+    void fill_faces(size_t sites_num) {
+        faces.resize(sites_num, nullptr);
+        for (size_t i = 0; i < halfedges.size(); ++i) {
+            bl::HalfEdgePtrT<T> he = halfedges[i];
+            if (he->prev == nullptr || faces[he->l_index] == nullptr) {
+                faces[he->l_index] = he;
+            }
+        }
     }
+    
+private:
+    
+    std::vector<bl::HalfEdgePtrT<T>> &halfedges;
+    std::vector<bl::VertexPtrT<T>> &vertices;
+    std::vector<bl::HalfEdgePtrT<T>> &faces;
+    
 };
 
 
-struct Point2DComparator2 {
-    bool operator()(const Point2D &p1, const Point2D &p2) {
-        return (p1.y == p2.y && p1.x < p2.x) || p1.y < p2.y;
+/**
+ Output of the sweep into a flat DCEL.
+ */
+template<typename T>
+class FlatOutput {
+public:
+    
+    FlatOutput(bl::FlatDiagramT<T> &_diagram) : diagram(_diagram) {}
+    
+    std::pair<uint32_t, uint32_t> make_twins(int left_index, int right_index) {
+        return diagram.make_twins(left_index, right_index);
     }
-};
-
-
-struct EventPtrComparator {
-    Point2DComparator point_cmp;
-    bool operator()(const EventPtr &e1, const EventPtr &e2) {
-        return point_cmp(e1->point, e2->point);
+    
+    uint32_t twin(uint32_t h) {
+        return diagram.twin[h];
     }
+    
+    void connect_halfedges(uint32_t h1, uint32_t h2) {
+        diagram.connect_halfedges(h1, h2);
+    }
+    
+    uint32_t add_vertex(const Point2DT<T> &point) {
+        return diagram.add_vertex(point);
+    }
+    
+    // halfedge `h` points into the vertex `v`, so `v` is the origin of its twin
+    void set_vertex(uint32_t h, uint32_t v) {
+        diagram.origin[diagram.twin[h]] = v;
+    }
+    
+    void set_vertex_edge(uint32_t, uint32_t) {}
+    
+    void arc_added(int) {}
+    void arc_removed(int) {}
+    
+    void fill_faces(size_t sites_num) {
+        diagram.faces.assign(sites_num, bl::NO_INDEX);
+        for (uint32_t h = 0; h < diagram.halfedges_num(); ++h) {
+            uint32_t site = diagram.l_site[h];
+            if (diagram.prev[h] == bl::NO_INDEX || diagram.faces[site] == bl::NO_INDEX) {
+                diagram.faces[site] = h;
+            }
+        }
+    }
+    
+private:
+    
+    bl::FlatDiagramT<T> &diagram;
+    
 };
 
 
-EventPtr checkCircleEvent(bl::BLNodePtr n1, bl::BLNodePtr n2, bl::BLNodePtr n3,
-                          const std::vector<Point2D> &points, double sweepline) {
+/**
+ Output of the sweep into Delaunay triangles, one per vertex.
+ An edge keeps its two sites and the corner of the triangle at its first end,
+ the triangle at its second end becomes the neighbour across that corner.
+ Halfedges 2e and 2e + 1 are the twins of the edge e.
+ */
+template<typename T>
+class TriangleOutput {
+public:
     
-    if (n1 == nullptr || n2 == nullptr || n3 == nullptr)
-        return nullptr;
+    TriangleOutput(DelaunayTriangles &_triangles, std::vector<uint32_t> &_edge_sites,
+                   std::vector<uint32_t> &_edge_ends) :
+    triangles(_triangles), edge_sites(_edge_sites), edge_ends(_edge_ends) {}
     
-    Point2D p1 = points[n1->get_id()];
-    Point2D p2 = points[n2->get_id()];
-    Point2D p3 = points[n3->get_id()];
-    Point2D center, bottom;
+    std::pair<uint32_t, uint32_t> make_twins(int left_index, int right_index) {
+        uint32_t h = static_cast<uint32_t>(edge_sites.size());
+        edge_sites.push_back(left_index);
+        edge_sites.push_back(right_index);
+        edge_ends.push_back(bl::NO_INDEX);
+        return std::make_pair(h, h + 1);
+    }
     
-    if (p2.y > p1.y && p2.y > p3.y)
-        return nullptr;
+    uint32_t twin(uint32_t h) {
+        return h ^ 1;
+    }
     
-    if (!findCircleCenter(p1, p2, p3, center))
-        return nullptr;
+    void connect_halfedges(uint32_t, uint32_t) {}
     
-    bottom = center;
-    bottom.y += (center - p2).norm();
+    uint32_t add_vertex(const Point2DT<T> &) {
+        return triangles.add_triangle();
+    }
     
-    // check circle event
-    if (fabs(bottom.y - sweepline) < POINT_EPSILON || sweepline < bottom.y) {
-        // create a circle event structure
-        EventPtr e = std::make_shared<Event>(-1, Event::CIRCLE, bottom);
-        // initialize attributes
-        e->center = center;
-        e->arc = n2;
-        // add reference in the corresponding node
-        n2->circle_event = e;
-        return e;
+    // halfedge `h` points into the vertex, its sites go counterclockwise around the triangle
+    void set_vertex(uint32_t h, uint32_t t) {
+        uint32_t corner = 3 * t + triangles.add_edge(t, edge_sites[h], edge_sites[h ^ 1]);
+        uint32_t &end = edge_ends[h >> 1];
+        if (end == bl::NO_INDEX) {
+            end = corner;
+        } else {
+            triangles.neighbours[corner] = end / 3;
+            triangles.neighbours[end] = t;
+        }
     }
     
-    return nullptr;
-}
+    void set_vertex_edge(uint32_t, uint32_t) {}
+    
+    void arc_added(int) {}
+    void arc_removed(int) {}
+    
+    void fill_faces(size_t) {}
+    
+private:
+    
+    DelaunayTriangles &triangles;
+    std::vector<uint32_t> &edge_sites;
+    std::vector<uint32_t> &edge_ends;
+    
+};
 
 
-void build_voronoi(const std::vector<Point2D> &points,
-                   std::vector<bl::HalfEdgePtr> &halfedges,
-                   std::vector<bl::VertexPtr> &vertices,
-                   std::vector<bl::HalfEdgePtr> &faces) {
+template<typename T, class Output, class Beachline>
+void sweep(const Point2DT<T> *points, size_t points_n, Output &output, Beachline &beachline,
+           SweepBuffersT<T> &buffers, SweepStats *stats_out) {
     
-    // create a priority queue
-    std::priority_queue<EventPtr, std::vector<EventPtr>, EventPtrComparator> pq;
+    // site events are sorted once, circle events go to a separate queue
+    std::vector<int> &sites = buffers.sites;
+    // the order of the previous sweep is nearly sorted if its sites moved a little
+    if (!buffers.reuse_order || sites.size() != points_n) {
+        sites.resize(points_n);
+        for (size_t i = 0; i < points_n; ++i) {
+            sites[i] = static_cast<int>(i);
+        }
+    }
+    std::sort(sites.begin(), sites.end(), SiteComparator<T>{points});
     
-    // initialize it with all site events
-    for (size_t i = 0; i < points.size(); ++i) {
-        pq.push(std::make_shared<Event>(static_cast<int>(i), Event::SITE, points[i]));
+    // arcs and events of the previous run are dropped but their memory is kept
+    Sweep<T, Output, Beachline> sweep(points, output, beachline, buffers.queue);
+    beachline.set_finger_search(buffers.finger_search);
+    if (buffers.trace != nullptr) {
+        buffers.trace->clear();
+        buffers.trace->sites_num = points_n;
+        sweep.set_trace(buffers.trace);
     }
     
-    // initialize vector of halfedges for faces
-    faces.resize(points.size(), nullptr);
-    
-    // create a beachline tree
-    bl::BLNodePtr root;
-    double sweepline = 0L; // current position of the sweepline
-    
-    // process events
-    while (!pq.empty()) {
-        
-        // extract new event from the queue
-        EventPtr e = pq.top(); pq.pop();
-        
-        // set position of a sweepline
-        sweepline = e->point.y;
-        
-        if (e->type == Event::SITE) { // handle site event
-            
-            int point_i = e->index;
-            if (root == nullptr) { // init empty beachline tree
-                root = std::make_shared<bl::BLNode>(std::make_pair(point_i, point_i), &sweepline, &points);
-            } else { // if it's not empty
-                
-                bl::BLNodePtr arc = bl::find(root, e->point.x);
-                bl::BLNodePtr subtree, left_leaf, right_leaf;
-                
-                if (arc->circle_event != nullptr) {
-                    EventPtr circle_e = arc->circle_event;
-                    circle_e->type = Event::SKIP; // ignore corresponding event
-                }
-                
-                // check number of intersection points
-                int isp_num = intersectionPointsNum(points[arc->get_id()], e->point, sweepline);
-                
-                // different subtrees depending on the number of intersection points
-                if (isp_num == 1) {
-                    subtree = bl::make_simple_subtree(point_i, arc->get_id(), &sweepline, &points, halfedges);
-                    left_leaf = subtree->left;
-                    right_leaf = subtree->right;
-                } else if (isp_num == 2) {
-                    subtree = bl::make_subtree(point_i, arc->get_id(), &sweepline, &points, halfedges);
-                    left_leaf = subtree->left;
-                    right_leaf = subtree->right->right;
-                } else {
-                    continue;
-                }
-                
-                if (arc->prev != nullptr)
-                    bl::connect(arc->prev, left_leaf);
-                
-                if (arc->next != nullptr)
-                    bl::connect(right_leaf, arc->next);
-                
-                // Replace old leaf with a subtree and rebalance it
-                root = bl::replace(arc, subtree);
-                
-                // Check circle events
-                EventPtr circle_event = checkCircleEvent(left_leaf->prev, left_leaf, left_leaf->next, points, sweepline);
-                if (circle_event != nullptr) {
-                    pq.push(circle_event);
-                }
-                circle_event = checkCircleEvent(right_leaf->prev, right_leaf, right_leaf->next, points, sweepline);
-                if (circle_event != nullptr) {
-                    pq.push(circle_event);
-                }
-            }
-            
-        } else if (e->type == Event::CIRCLE) { // handle circle event
-            
-            bl::BLNodePtr arc = e->arc, prev_leaf, next_leaf;
-
-            // get breakpoint nodes
-            std::pair<bl::BLNodePtr, bl::BLNodePtr> breakpoints = bl::breakpoints(arc);
-            
-            // recheck if it's a false alarm 1
-            if (breakpoints.first == nullptr || breakpoints.second == nullptr) {
-                continue;
-            }
-            
-            // recheck if it's a false alarm 2
-            double v1 = breakpoints.first->value(), v2 = breakpoints.second->value();
-            
-            if (fabs(v1 - v2) > BREAKPOINTS_EPSILON) {
-                continue;
-            }
-            
-            // create a new vertex and insert into doubly-connected edge list
-            bl::VertexPtr vertex = std::make_shared<bl::Vertex>(e->center);
-            bl::HalfEdgePtr h_first = breakpoints.first->edge;
-            bl::HalfEdgePtr h_second = breakpoints.second->edge;
-            
-            // store vertex of Voronoi diagram
-            vertices.push_back(vertex);
-            
-            // remove circle event corresponding to next leaf
-            if (arc->prev != nullptr && arc->prev->circle_event != nullptr) {
-                EventPtr circle_e = arc->prev->circle_event;
-                circle_e->type = Event::SKIP; // ignore corresponding event
-            }
-            
-            // remove circle event corresponding to prev leaf
-            if (arc->next != nullptr && arc->next->circle_event != nullptr) {
-                EventPtr circle_e = arc->next->circle_event;
-                circle_e->type = Event::SKIP; // ignore corresponding event
-            }
-            
-            // store pointers to the next and previous leaves
-            prev_leaf = arc->prev;
-            next_leaf = arc->next;
-            
-            // They should not be null
-            assert(prev_leaf != nullptr);
-            assert(next_leaf != nullptr);
-            
-            // get node associated with a new edge
-            bl::BLNodePtr new_edge_node;
-            if (arc->parent == breakpoints.first)
-                new_edge_node = breakpoints.second;
-            else
-                new_edge_node = breakpoints.first;
-            
-            // remove arc from the beachline
-            root = bl::remove(arc);
-            
-            // make a new pair of halfedges
-            std::pair<bl::HalfEdgePtr, bl::HalfEdgePtr> twin_nodes = bl::make_twins(prev_leaf->get_id(), next_leaf->get_id());
-            new_edge_node->edge = twin_nodes.first;
-            //1/ new_edge_node->edge = twin_nodes.first;
-
-            // connect halfedges
-            bl::connect_halfedges(h_second, h_first->twin);
-            bl::connect_halfedges(h_first, twin_nodes.first);
-            bl::connect_halfedges(twin_nodes.second, h_second->twin);
-            
-            // halfedges are pointing into a vertex  -----> O <-----
-            // not like this <---- O ----->
-            // counterclockwise
-            h_first->vertex = vertex;
-            h_second->vertex = vertex;
-            twin_nodes.second->vertex = vertex;
-            vertex->edge = h_second;
-            
-            halfedges.push_back(twin_nodes.first);
-            halfedges.push_back(twin_nodes.second);
-            
-            // check new circle events
-            if (prev_leaf != nullptr && next_leaf != nullptr) {
-                EventPtr circle_event = checkCircleEvent(prev_leaf->prev, prev_leaf, next_leaf, points, sweepline);
-                if (circle_event != nullptr) {
-                    pq.push(circle_event);
-                }
-                circle_event = checkCircleEvent(prev_leaf, next_leaf, next_leaf->next, points, sweepline);
-                if (circle_event != nullptr) {
-                    pq.push(circle_event);
-                }
-            }
+    // repeats of a site are next to it in the order, only its first copy gets a cell
+    for (size_t i = 0; i < sites.size(); ++i) {
+        int site = sites[i];
+        const Point2DT<T> &point = points[site];
+        if (i > 0 && point.x == points[sites[i - 1]].x && point.y == points[sites[i - 1]].y) {
+            sweep.drop_site(site);
+        } else {
+            sweep.add_site(site);
         }
     }
+    sweep.finish();
     
     // Fill edges corresponding to faces
-    for (size_t i = 0; i < halfedges.size(); ++i) {
-        bl::HalfEdgePtr he = halfedges[i];
-        if (he->prev == nullptr || faces[he->l_index] == nullptr) {
-            faces[he->l_index] = he;
-        }
+    output.fill_faces(points_n);
+    
+    if (stats_out != nullptr) {
+        *stats_out = sweep.stats;
     }
     
 }
+
+
+template<typename T>
+static void buildPointerDiagram(const std::vector<Point2DT<T>> &points,
+                                std::vector<bl::HalfEdgePtrT<T>> &halfedges,
+                                std::vector<bl::VertexPtrT<T>> &vertices,
+                                std::vector<bl::HalfEdgePtrT<T>> &faces,
+                                SweepStats *stats) {
+    PointerOutput<T> output(halfedges, vertices, faces);
+    SweepBuffersT<T> buffers;
+    sweep(points.data(), points.size(), output, buffers.avl, buffers, stats);
+}
+
+
+template<typename T>
+static void buildFlatDiagram(const Point2DT<T> *points, size_t n, bl::FlatDiagramT<T> &diagram,
+                             SweepBuffersT<T> &buffers, SweepStats *stats) {
+    diagram.clear();
+    // a diagram of n sites has at most 2n-5 vertices and 3n-6 edges
+    diagram.reserve(n > 2 ? 2 * n - 5 : 0, n > 2 ? 6 * n - 12 : 2);
+    FlatOutput<T> output(diagram);
+    if (buffers.beachline == WIDE_BEACHLINE) {
+        sweep(points, n, output, buffers.wide, buffers, stats);
+    } else {
+        sweep(points, n, output, buffers.avl, buffers, stats);
+    }
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points,
+                   std::vector<bl::HalfEdgePtr> &halfedges,
+                   std::vector<bl::VertexPtr> &vertices,
+                   std::vector<bl::HalfEdgePtr> &faces,
+                   SweepStats *stats) {
+    buildPointerDiagram(points, halfedges, vertices, faces, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, bl::FlatDiagram &diagram, SweepStats *stats) {
+    SweepBuffers buffers;
+    build_voronoi(points, diagram, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                   SweepBuffers &buffers, SweepStats *stats) {
+    buildFlatDiagram(points.data(), points.size(), diagram, buffers, stats);
+}
+
+
+void build_voronoi(const Point2D *points, size_t points_n, bl::FlatDiagram &diagram,
+                   SweepBuffers &buffers, SweepStats *stats) {
+    buildFlatDiagram(points, points_n, diagram, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2Df> &points,
+                   std::vector<bl::HalfEdgePtrT<float>> &halfedges,
+                   std::vector<bl::VertexPtrT<float>> &vertices,
+                   std::vector<bl::HalfEdgePtrT<float>> &faces,
+                   SweepStats *stats) {
+    buildPointerDiagram(points, halfedges, vertices, faces, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2Df> &points, bl::FlatDiagramT<float> &diagram, SweepStats *stats) {
+    SweepBuffersT<float> buffers;
+    build_voronoi(points, diagram, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2Df> &points, bl::FlatDiagramT<float> &diagram,
+                   SweepBuffersT<float> &buffers, SweepStats *stats) {
+    buildFlatDiagram(points.data(), points.size(), diagram, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, DelaunayTriangles &triangles, SweepStats *stats) {
+    SweepBuffers buffers;
+    build_voronoi(points, triangles, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, DelaunayTriangles &triangles,
+                   SweepBuffers &buffers, SweepStats *stats) {
+    size_t n = points.size();
+    triangles.clear();
+    // at most 2n-5 triangles and 3n-6 edges
+    triangles.triangles.reserve(n > 2 ? 3 * (2 * n - 5) : 0);
+    triangles.neighbours.reserve(n > 2 ? 3 * (2 * n - 5) : 0);
+    buffers.edge_sites.clear();
+    buffers.edge_sites.reserve(n > 2 ? 6 * n - 12 : 2);
+    buffers.edge_ends.clear();
+    buffers.edge_ends.reserve(n > 2 ? 3 * n - 6 : 1);
+    TriangleOutput<double> output(triangles, buffers.edge_sites, buffers.edge_ends);
+    if (buffers.beachline == WIDE_BEACHLINE) {
+        sweep(points.data(), n, output, buffers.wide, buffers, stats);
+    } else {
+        sweep(points.data(), n, output, buffers.avl, buffers, stats);
+    }
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, const BoundingBox &box,
+                   ClippedCells &cells, SweepStats *stats) {
+    SweepBuffers buffers;
+    build_voronoi(points, box, cells, buffers, stats);
+}
+
+
+void build_voronoi(const std::vector<Point2D> &points, const BoundingBox &box,
+                   ClippedCells &cells, SweepBuffers &buffers, SweepStats *stats) {
+    build_voronoi(points, buffers.diagram, buffers, stats);
+    clip_cells(points, buffers.diagram, box, cells);
+}
@@ -11,15 +11,171 @@
 
 #include "Point2D.h"
 #include "Beachline.hpp"
+#include "WideBeachline.hpp"
+#include "ClippedCells.hpp"
+#include "DelaunayTriangles.hpp"
+#include "SweepTrace.hpp"
 
 
 namespace bl = beachline;
 
 
+/**
+ Counters of one sweep.
+ Every pushed circle event is either cancelled, processed or a false alarm.
+ Breakpoint evaluations at an unchanged sweepline are answered from the cache.
+ Repeats of a site are dropped and get empty cells.
+
+ The profile below is filled only when the library is built with
+ FORTUNE_SWEEP_PROFILE (the CMake option of the same name), otherwise it stays
+ zero and costs nothing. The beachline is sampled after every site event and
+ processed circle event. Time is split by the structure the sweep works on,
+ with the circle tests counted to the queue; reading the clock adds its own
+ overhead to every phase, so the shares are more telling than the sums.
+ */
+struct SweepStats {
+    size_t circle_events_pushed = 0;
+    size_t circle_events_cancelled = 0;
+    size_t circle_events_processed = 0;
+    size_t circle_events_false = 0;
+    size_t max_queue_size = 0;
+    size_t breakpoint_cache_hits = 0;
+    size_t breakpoint_cache_misses = 0;
+    size_t sites_dropped = 0;
+
+    size_t site_events = 0;
+    size_t sites_beside = 0;            // sites level with the arc above them, put next to it
+    size_t rebalances = 0;              // AVL rotations, or splits and removals of B+-tree nodes
+    size_t max_beachline_arcs = 0;
+    double mean_beachline_arcs = 0.0;
+    int max_beachline_height = 0;
+    double mean_beachline_height = 0.0;
+    double queue_time = 0.0;            // seconds
+    double beachline_time = 0.0;
+    double output_time = 0.0;
+};
+
+
+/**
+ Structure of the beachline: a binary AVL tree with a breakpoint in every
+ inner node or a B+-tree, which evaluates several breakpoints of a node at once.
+ */
+enum BeachlineType {
+    AVL_BEACHLINE,
+    WIDE_BEACHLINE
+};
+
+
+/**
+ Scratch memory of the sweep: order of site events, circle event queue,
+ beachline nodes, the diagram when the output is something else and
+ the sites and ends of the edges when the output is a triangulation.
+ Reusing it between calls keeps its capacity.
+ The sweep uses the beachline selected by `beachline`. With `finger_search`
+ arcs are searched from the last inserted one, which is faster when sites
+ next to each other in the sweep order are close, e.g. rows of a sensor grid.
+ Both beachlines and both searches compare the same breakpoints, so double
+ precision diagrams are the same with any of them, repeated sites included.
+ With `reuse_order` the sweep order of the previous call is sorted again for
+ the new sites, which is faster when the same number of sites moved a little,
+ e.g. between the iterations of Lloyd relaxation.
+ With `trace` every event of the sweep is recorded into it, see SweepTrace.
+ */
+template<typename T>
+struct SweepBuffersT {
+    std::vector<int> sites;
+    bl::CircleEventQueueT<T> queue;
+    bl::AVLBeachlineT<T> avl;
+    bl::WideBeachlineT<T> wide;
+    bl::FlatDiagramT<T> diagram;
+    std::vector<uint32_t> edge_sites, edge_ends;
+    BeachlineType beachline = AVL_BEACHLINE;
+    bool finger_search = false;
+    bool reuse_order = false;
+    SweepTrace *trace = nullptr;
+};
+
+
+typedef SweepBuffersT<double> SweepBuffers;
+
+
 void build_voronoi(const std::vector<Point2D> &points,
                    std::vector<bl::HalfEdgePtr> &halfedges,
                    std::vector<bl::VertexPtr> &vertices,
-                   std::vector<bl::HalfEdgePtr> &faces);
+                   std::vector<bl::HalfEdgePtr> &faces,
+                   SweepStats *stats = nullptr);
+
+
+/**
+ Build Voronoi diagram into a flat doubly-connected edge list.
+ The previous content of `diagram` is discarded.
+ */
+void build_voronoi(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                   SweepStats *stats = nullptr);
+
+
+/**
+ Same as above, but takes scratch memory from `buffers`.
+ */
+void build_voronoi(const std::vector<Point2D> &points, bl::FlatDiagram &diagram,
+                   SweepBuffers &buffers, SweepStats *stats = nullptr);
+
+
+/**
+ Same as above for `points_n` sites stored at `points` in memory the caller
+ owns, e.g. a mapped point file (see MappedPoints). The sites are not copied.
+ */
+void build_voronoi(const Point2D *points, size_t points_n, bl::FlatDiagram &diagram,
+                   SweepBuffers &buffers, SweepStats *stats = nullptr);
+
+
+/**
+ Single precision versions of the above. Coordinates of sites, vertices and
+ events take half the memory, but vertices are less accurate and nearly
+ cocircular sites may be connected differently than in double precision.
+ */
+void build_voronoi(const std::vector<Point2Df> &points,
+                   std::vector<bl::HalfEdgePtrT<float>> &halfedges,
+                   std::vector<bl::VertexPtrT<float>> &vertices,
+                   std::vector<bl::HalfEdgePtrT<float>> &faces,
+                   SweepStats *stats = nullptr);
+
+void build_voronoi(const std::vector<Point2Df> &points, bl::FlatDiagramT<float> &diagram,
+                   SweepStats *stats = nullptr);
+
+void build_voronoi(const std::vector<Point2Df> &points, bl::FlatDiagramT<float> &diagram,
+                   SweepBuffersT<float> &buffers, SweepStats *stats = nullptr);
+
+
+/**
+ Build Voronoi diagram and clip its cells to `box`.
+ Every cell comes out as a closed polygon, see `clip_cells`.
+ */
+void build_voronoi(const std::vector<Point2D> &points, const BoundingBox &box,
+                   ClippedCells &cells, SweepStats *stats = nullptr);
+
+
+/**
+ Same as above, but takes scratch memory from `buffers`.
+ */
+void build_voronoi(const std::vector<Point2D> &points, const BoundingBox &box,
+                   ClippedCells &cells, SweepBuffers &buffers, SweepStats *stats = nullptr);
+
+/**
+ Build the Delaunay triangulation of `points` straight from the sweep,
+ a triangle per circle event. The diagram itself is not built, only the
+ sites and the ends of its edges are kept to connect the triangles.
+ The previous content of `triangles` is discarded.
+ */
+void build_voronoi(const std::vector<Point2D> &points, DelaunayTriangles &triangles,
+                   SweepStats *stats = nullptr);
+
+
+/**
+ Same as above, but takes scratch memory from `buffers`.
+ */
+void build_voronoi(const std::vector<Point2D> &points, DelaunayTriangles &triangles,
+                   SweepBuffers &buffers, SweepStats *stats = nullptr);
 
 //std::vector<bl::HalfEdgePtr> init
 //